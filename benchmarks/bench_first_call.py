@@ -0,0 +1,50 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Time of the first call of each kernel in a new process, which is dominated by its
+just-in-time compilation"""
+from .common import first_call_time
+
+# code run before the first call, whose time is not counted
+SETUP = "\n".join(
+    [
+        "import numpy as np",
+        "import thewalrus",
+        "from thewalrus.loop_hafnian_batch import loop_hafnian_batch",
+    ]
+)
+
+# statement evaluated for each kernel
+STATEMENTS = {
+    "hafnian": "thewalrus.hafnian(np.ones((12, 12)))",
+    "loop_hafnian": "thewalrus.hafnian(np.ones((12, 12)), loop=True)",
+    "hafnian_repeated": "thewalrus.hafnian_repeated(np.ones((4, 4)), [2] * 4)",
+    "loop_hafnian_batch": "loop_hafnian_batch(np.ones((6, 6)), np.ones(6), [1] * 5, 4)",
+    "perm": "thewalrus.perm(np.ones((8, 8)))",
+    "tor": "thewalrus.tor(0.1 * np.eye(8))",
+    "hermite_multidimensional": "thewalrus.hermite_multidimensional(0.1 * np.ones((2, 2)), 4)",
+    "hafnian_sample_state": "thewalrus.samples.hafnian_sample_state(np.eye(4), 1, rng=0)",
+}
+
+
+class FirstCall:
+    """First call of a kernel, with an empty Numba cache and after importing The Walrus"""
+
+    params = list(STATEMENTS)
+    param_names = ["kernel"]
+    timeout = 600
+
+    def track_first_call(self, kernel):
+        return first_call_time(SETUP, STATEMENTS[kernel])
+
+    track_first_call.unit = "seconds"
@@ -0,0 +1,83 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Benchmarks of the hafnian kernels"""
+import numpy as np
+
+from thewalrus import hafnian, hafnian_repeated
+from thewalrus.loop_hafnian_batch import loop_hafnian_batch
+
+from .common import THREADS, random_symmetric, set_threads
+
+
+class Hafnian:
+    """Hafnian of a complex symmetric matrix"""
+
+    params = ([8, 16, 24], ["glynn", "inclexcl", "recursive"], THREADS)
+    param_names = ["n", "method", "threads"]
+
+    def setup(self, n, method, threads):
+        set_threads(threads)
+        self.A = random_symmetric(n)
+        hafnian(random_symmetric(6), method=method)
+
+    def time_hafnian(self, n, method, threads):
+        hafnian(self.A, method=method)
+
+
+class LoopHafnian:
+    """Loop hafnian of a complex symmetric matrix"""
+
+    params = ([8, 16, 24], THREADS)
+    param_names = ["n", "threads"]
+
+    def setup(self, n, threads):
+        set_threads(threads)
+        self.A = random_symmetric(n)
+        hafnian(random_symmetric(6), loop=True)
+
+    def time_loop_hafnian(self, n, threads):
+        hafnian(self.A, loop=True)
+
+
+class HafnianRepeated:
+    """Hafnian of a matrix of four rows and columns, each repeated the same number of times"""
+
+    params = ([2, 4, 6], THREADS)
+    param_names = ["repetitions", "threads"]
+
+    def setup(self, repetitions, threads):
+        set_threads(threads)
+        self.A = random_symmetric(4)
+        hafnian_repeated(self.A, [1] * 4)
+
+    def time_hafnian_repeated(self, repetitions, threads):
+        hafnian_repeated(self.A, [repetitions] * 4)
+
+
+class LoopHafnianBatch:
+    """Loop hafnians of a matrix of eight modes, with the photon number of the last one
+    running up to a cutoff"""
+
+    params = ([4, 8, 12], THREADS)
+    param_names = ["cutoff", "threads"]
+
+    def setup(self, cutoff, threads):
+        set_threads(threads)
+        self.A = random_symmetric(8)
+        self.D = np.diag(self.A).copy()
+        self.pattern = [1] * 7
+        loop_hafnian_batch(self.A, self.D, self.pattern, 2)
+
+    def time_loop_hafnian_batch(self, cutoff, threads):
+        loop_hafnian_batch(self.A, self.D, self.pattern, cutoff)
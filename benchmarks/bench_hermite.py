@@ -0,0 +1,31 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Benchmarks of the multidimensional Hermite polynomials"""
+from thewalrus import hermite_multidimensional
+
+from .common import random_symmetric
+
+
+class HermiteMultidimensional:
+    """Renormalized Hermite polynomials of a matrix of a given size, up to a cutoff"""
+
+    params = ([2, 3, 4], [4, 8, 12])
+    param_names = ["modes", "cutoff"]
+
+    def setup(self, modes, cutoff):
+        self.R = 0.1 * random_symmetric(modes)
+        hermite_multidimensional(self.R, 2, renorm=True)
+
+    def time_hermite_multidimensional(self, modes, cutoff):
+        hermite_multidimensional(self.R, cutoff, renorm=True)
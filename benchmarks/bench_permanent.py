@@ -0,0 +1,35 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Benchmarks of the permanent kernels"""
+import numpy as np
+
+from thewalrus import perm
+
+from .common import THREADS, set_threads
+
+
+class Permanent:
+    """Permanent of a complex matrix"""
+
+    params = ([8, 16, 24], ["ryser", "bbfg"], THREADS)
+    param_names = ["n", "method", "threads"]
+
+    def setup(self, n, method, threads):
+        set_threads(threads)
+        rng = np.random.default_rng(137)
+        self.A = rng.random((n, n)) + 1j * rng.random((n, n))
+        perm(self.A[:6, :6], method=method)
+
+    def time_perm(self, n, method, threads):
+        perm(self.A, method=method)
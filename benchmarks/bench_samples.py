@@ -0,0 +1,37 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Benchmarks of the hafnian sampler"""
+import numpy as np
+
+from thewalrus.random import random_covariance
+from thewalrus.samples import hafnian_sample_state
+
+from .common import THREADS, set_threads
+
+
+class HafnianSampleState:
+    """Ten samples of a Gaussian state of a given number of modes"""
+
+    params = ([4, 8], THREADS)
+    param_names = ["modes", "threads"]
+    timeout = 300
+
+    def setup(self, modes, threads):
+        set_threads(threads)
+        np.random.seed(137)
+        self.cov = random_covariance(modes)
+        hafnian_sample_state(self.cov, 1, rng=0)
+
+    def time_hafnian_sample_state(self, modes, threads):
+        hafnian_sample_state(self.cov, 10, rng=1)
@@ -0,0 +1,42 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Benchmarks of the Torontonian kernels"""
+import numpy as np
+
+from thewalrus import tor, ltor
+from thewalrus.quantum import Qmat
+from thewalrus.random import random_covariance
+
+from .common import THREADS, set_threads
+
+
+class Torontonian:
+    """Torontonian and loop Torontonian of a Gaussian state of a given number of modes"""
+
+    params = ([6, 10, 14], [True, False], THREADS)
+    param_names = ["modes", "recursive", "threads"]
+
+    def setup(self, modes, recursive, threads):
+        set_threads(threads)
+        np.random.seed(137)
+        self.O = np.eye(2 * modes) - np.linalg.inv(Qmat(random_covariance(modes)))
+        self.gamma = np.random.rand(2 * modes) + 1j * np.random.rand(2 * modes)
+        tor(self.O[:4, :4], recursive=recursive)
+        ltor(self.O[:4, :4], self.gamma[:4], recursive=recursive)
+
+    def time_tor(self, modes, recursive, threads):
+        tor(self.O, recursive=recursive)
+
+    def time_ltor(self, modes, recursive, threads):
+        ltor(self.O, self.gamma, recursive=recursive)
@@ -0,0 +1,83 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Helpers shared by the benchmarks.
+
+Every benchmark calls its kernel once in ``setup``, so that the times reported by airspeed
+velocity are steady-state times, without the just-in-time compilation of the kernels. The
+compilation is measured separately by :mod:`benchmarks.bench_first_call`.
+"""
+import os
+import subprocess
+import sys
+import tempfile
+
+import numba
+import numpy as np
+
+# thread counts of the parallel kernels: one, and all the threads Numba was started with
+THREADS = sorted({1, numba.config.NUMBA_NUM_THREADS})
+
+
+def set_threads(threads):
+    """Sets the number of threads used by the parallel kernels.
+
+    Args:
+        threads (int): number of threads, capped by the number Numba was started with
+    """
+    numba.set_num_threads(min(threads, numba.config.NUMBA_NUM_THREADS))
+
+
+def random_symmetric(n, dtype=np.complex128, seed=137):
+    """Random symmetric matrix, the same for a given seed.
+
+    Args:
+        n (int): size of the matrix
+        dtype (type): ``np.float64`` or ``np.complex128``
+        seed (int): seed of the generator
+
+    Returns:
+        array: the matrix
+    """
+    rng = np.random.default_rng(seed)
+    A = rng.random((n, n))
+    if dtype == np.complex128:
+        A = A + 1j * rng.random((n, n))
+    return A + A.T
+
+
+def first_call_time(setup, statement):
+    """Time of the first evaluation of a statement in a new process with an empty Numba cache.
+
+    Args:
+        setup (str): code run before the statement, whose time is not counted
+        statement (str): code whose time is measured
+
+    Returns:
+        float: the time in seconds
+    """
+    code = "\n".join(
+        [
+            "import time",
+            setup,
+            "start = time.perf_counter()",
+            statement,
+            "print(time.perf_counter() - start)",
+        ]
+    )
+    with tempfile.TemporaryDirectory() as cache_dir:
+        env = dict(os.environ, NUMBA_CACHE_DIR=cache_dir)
+        result = subprocess.run(
+            [sys.executable, "-c", code], env=env, capture_output=True, text=True, check=True
+        )
+    return float(result.stdout.split()[-1])
@@ -28,7 +28,7 @@ info = {
     "maintainer_email": "software@xanadu.ai",
     "url": "https://github.com/XanaduAI/thewalrus",
     "license": "Apache License 2.0",
-    "packages": find_packages(where="."),
+    "packages": find_packages(where=".", exclude=["benchmarks"]),
     "description": "Open source library for hafnian calculation",
     "long_description": open("README.rst").read(),
     "provides": ["thewalrus"],
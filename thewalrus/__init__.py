@@ -69,8 +69,9 @@ Banded hafnian algorithm
     :cite:`qi2020efficient`.
 
 Sparse hafnian algorithm
-    An algorithm that calculates the hafnian of a sparse matrix by taking advantage of the Laplace expansion and memoization, to store
-    only the relevant paths that contribute non-zero values to the final calculation.
+    An algorithm that calculates the hafnian of a sparse matrix by taking advantage of the Laplace expansion and memoization. The vertices
+    of the graph are eliminated one at a time in an order chosen from the nonzero pattern, and only the subsets of eliminated vertices
+    still waiting to be matched, encoded as bitmasks, are stored.
 
 Functions
 ---------
@@ -86,10 +87,13 @@ Functions
     brs
     ubrs
     hermite_multidimensional
+    hermite_multidimensional_total
+    TotalCutoffTensor
     hafnian_banded
     reduction
     version
     low_rank_hafnian
+    precompile
 
 Code details
 ------------
@@ -97,11 +101,14 @@ Code details
 import thewalrus.quantum
 import thewalrus.csamples
 import thewalrus.decompositions
+import thewalrus.distributed
 import thewalrus.fock_gradients
 import thewalrus.charpoly
+import thewalrus.instrumentation
 import thewalrus.random
 import thewalrus.reference
 import thewalrus.samples
+import thewalrus.sinks
 import thewalrus.symplectic
 
 from ._hafnian import (
@@ -120,8 +127,12 @@ from ._hermite_multidimensional import (
     hermite_multidimensional,
     interferometer,
     grad_hermite_multidimensional,
+    hermite_multidimensional_total,
+    grad_hermite_multidimensional_total,
+    TotalCutoffTensor,
 )
 from ._permanent import perm, permanent_repeated, brs, ubrs
+from ._precompile import precompile
 
 from ._torontonian import (
     tor,
@@ -152,6 +163,10 @@ __all__ = [
     "reduction",
     "hermite_multidimensional",
     "grad_hermite_multidimensional",
+    "hermite_multidimensional_total",
+    "grad_hermite_multidimensional_total",
+    "TotalCutoffTensor",
+    "precompile",
     "version",
 ]
 
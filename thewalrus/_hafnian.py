@@ -15,12 +15,14 @@
 Hafnian Python interface
 """
 import warnings
-from functools import lru_cache
-from collections import Counter
-from itertools import chain, combinations
 import numba
 import numpy as np
+from scipy.sparse import csr_matrix
+from scipy.sparse.csgraph import reverse_cuthill_mckee
 from thewalrus import charpoly
+from thewalrus._summation import SUM_CHUNKS, num_chunks, chunk_range, compensated_add, tree_sum
+from thewalrus.instrumentation import instrumented
+from thewalrus.random import philox_normals, seed_sequence, stream_key
 
 
 @numba.jit(nopython=True, cache=True)
@@ -159,6 +161,241 @@ def matched_reps(reps):  # pylint: disable = too-many-branches
     return x, edgereps, oddmode
 
 
+def kernel_dtype(*arrays):
+    """Type in which the hafnian kernels are run for the given inputs: ``float64`` if they
+    are all real, so that no arithmetic is wasted on zero imaginary parts, and
+    ``complex128`` otherwise.
+
+    Args:
+        arrays (array): matrices and vectors passed to a kernel
+
+    Returns:
+        type: ``np.float64`` or ``np.complex128``
+    """
+    return np.complex128 if any(np.iscomplexobj(a) for a in arrays) else np.float64
+
+
+def step_bounds(step_range):
+    """Bounds passed to the kernels for the range of terms of a sum to be evaluated.
+
+    Args:
+        step_range (tuple[int, int] or None): index of the first term and one past the index of
+            the last term; ``None`` for the whole sum
+
+    Returns:
+        tuple[int, int]: first and last bound, the latter being ``-1`` for the whole sum
+    """
+    if step_range is None:
+        return 0, -1
+    start, stop = (int(i) for i in step_range)
+    if start < 0 or stop < start:
+        raise ValueError("step_range must be a pair of integers with 0 <= start <= stop.")
+    return start, stop
+
+
+def range_steps(steps, step_range):
+    """Number of terms of a sum of ``steps`` terms within a range of terms.
+
+    Args:
+        steps (int): number of terms of the sum
+        step_range (tuple[int, int] or None): range of terms, as given to :func:`step_bounds`
+
+    Returns:
+        int: number of terms of the sum in the range
+    """
+    start, stop = step_bounds(step_range)
+    stop = steps if stop < 0 else min(stop, steps)
+    return max(stop - start, 0)
+
+
+def gray_code_steps(reps, glynn=True, loop=False, step_range=None):
+    """Number of terms of the sums evaluated by :func:`_calc_hafnian` and
+    :func:`_calc_loop_hafnian`, recorded by the instrumentation.
+
+    Args:
+        reps (list): repetitions of each row/column
+        glynn (bool): whether the finite difference sieve is used
+        loop (bool): whether the sum is the one of the loop hafnian
+        step_range (tuple[int, int] or None): range of terms evaluated
+
+    Returns:
+        int: number of terms evaluated
+    """
+    N = sum(reps)
+    if N < 2 or (N % 2 == 1 and not loop):
+        return 0
+    _, edge_reps, oddmode = matched_reps(reps)
+    bases = edge_reps + 1
+    if glynn and (not loop or oddmode is None):
+        bases[0] = (edge_reps[0] + 2) // 2
+    return range_steps(int(np.prod(bases)), step_range)
+
+
+# function notified as ``hook(function, strategy, costs)`` whenever a repetition-aware
+# function picks how to evaluate its sum; ``None`` disables the reporting
+_dispatch_hook = None
+
+
+def set_dispatch_hook(hook):
+    """Sets the debug hook notified of the strategy picked by :func:`hafnian_repeated` and
+    :func:`~thewalrus.permanent_repeated`.
+
+    The hook is called with the name of the function, the name of the strategy and a dictionary
+    mapping every candidate strategy to its estimated cost.
+
+    Args:
+        hook (callable or None): the new hook; ``None`` disables the reporting
+
+    Returns:
+        callable or None: the previous hook
+    """
+    global _dispatch_hook  # pylint: disable=global-statement
+    previous, _dispatch_hook = _dispatch_hook, hook
+    return previous
+
+
+def report_dispatch(function, strategy, costs):
+    """Passes the strategy picked by a repetition-aware function to the debug hook, if any.
+
+    Args:
+        function (str): name of the function
+        strategy (str): name of the strategy picked
+        costs (dict): estimated cost of every candidate strategy
+    """
+    if _dispatch_hook is not None:
+        _dispatch_hook(function, strategy, costs)
+
+
+def matching_count(N, loop=False):
+    """Number of perfect matchings of ``N`` vertices, or of matchings with loops (involutions)
+    if ``loop`` is ``True``.
+
+    Args:
+        N (int): number of vertices
+        loop (bool): whether a vertex may be matched with itself
+
+    Returns:
+        int: number of terms of the (loop) hafnian of an ``N`` x ``N`` matrix
+    """
+    if not loop:
+        return 0 if N % 2 else int(np.prod(np.arange(1, N, 2), dtype=object))
+    previous, count = 1, 1
+    for k in range(2, N + 1):
+        previous, count = count, count + (k - 1) * previous
+    return count
+
+
+def repeated_hafnian_costs(reps, loop=False, glynn=True):
+    """Estimated costs, in arithmetic operations, of the strategies available to
+    :func:`hafnian_repeated`:
+
+    * ``"repeated"`` sums over the repetitions of the edges found by :func:`matched_reps`. Its
+      cost is the number of Gray code steps times the cube of the size of the matrix whose power
+      traces are computed at each step.
+    * ``"collision_free"`` expands the repeated rows and columns and enumerates the (loop)
+      perfect matchings of the expanded matrix with :func:`matching_hafnian`. Its cost is the
+      number of matchings times the number of rows, which is lower than that of
+      ``"repeated"`` for the small patterns of mostly zero or one photon per mode.
+
+    Args:
+        reps (array): repetitions of each row/column
+        loop (bool): whether the loop hafnian is computed
+        glynn (bool): whether the finite difference sieve is used
+
+    Returns:
+        dict[str, int]: estimated cost of each strategy
+    """
+    _, edge_reps, oddmode = matched_reps(reps)
+    bases = edge_reps + 1
+    if glynn and len(bases) > 0 and (not loop or oddmode is None):
+        bases[0] = (edge_reps[0] + 2) // 2
+    costs = {"repeated": int(np.prod(bases, dtype=object)) * (2 * len(edge_reps)) ** 3}
+
+    N = int(np.sum(reps))
+    if N >= 2:
+        costs["collision_free"] = matching_count(N, loop=loop) * N
+    return costs
+
+
+@numba.jit(nopython=True, cache=True)
+def matching_hafnian(A, loop=False):  # pragma: no cover
+    """Returns the (loop) hafnian of ``A`` by enumerating its (loop) perfect matchings
+    depth first, multiplying the weights of the edges along the current path.
+
+    Args:
+        A (array): N x N symmetric matrix, whose diagonal holds the loop weights
+        loop (bool): whether to compute the loop hafnian
+
+    Returns:
+        float or complex: the (loop) hafnian of ``A``
+    """
+    n = A.shape[0]
+    used = np.zeros(n, dtype=np.bool_)
+    first = np.zeros(n + 1, dtype=np.int64)
+    nxt = np.zeros(n + 1, dtype=np.int64)
+    prods = np.ones(n + 1, dtype=A.dtype)
+    total = prods[0] * 0
+    level = 0
+    descend = True
+    while level >= 0:
+        if descend:
+            # match the first unmatched vertex, or record a complete matching
+            i = 0
+            while i < n and used[i]:
+                i += 1
+            if i == n:
+                total += prods[level]
+                level -= 1
+                descend = False
+                continue
+            first[level] = i
+            nxt[level] = i if loop else i + 1
+            used[i] = True
+        else:
+            # unmatch the partner tried last at this level
+            i = first[level]
+            if nxt[level] - 1 != i:
+                used[nxt[level] - 1] = False
+        j = nxt[level]
+        while j < n and used[j] and j != i:
+            j += 1
+        if j == n:
+            used[i] = False
+            level -= 1
+            descend = False
+            continue
+        nxt[level] = j + 1
+        used[j] = True
+        prods[level + 1] = prods[level] * A[i, j]
+        level += 1
+        descend = True
+    return total
+
+
+def collision_free_hafnian(A, mu, reps, loop=False):
+    """Returns the (loop) hafnian of ``A`` with repeated rows and columns by expanding the
+    repetitions and enumerating the matchings of the expanded matrix with
+    :func:`matching_hafnian`, which avoids both the pairing of the repeated modes and the power
+    traces.
+
+    Args:
+        A (array): N x N matrix
+        mu (array): diagonal entries used for the loop hafnian
+        reps (array): repetitions of each row/column
+        loop (bool): whether to compute the loop hafnian
+
+    Returns:
+        float or complex: the (loop) hafnian of the expanded matrix
+    """
+    rows = np.repeat(np.arange(len(reps)), reps)
+    if not loop:
+        return matching_hafnian(A[np.ix_(rows, rows)].astype(kernel_dtype(A)), loop=False)
+
+    Ax = A[np.ix_(rows, rows)].astype(kernel_dtype(A, mu))
+    np.fill_diagonal(Ax, mu[rows])
+    return matching_hafnian(Ax, loop=True)
+
+
 @numba.jit(nopython=True, cache=True)
 def find_kept_edges(j, reps):  # pragma: no cover
     """Write ``j`` as a string where the ith digit is in base ``reps[i]+1``
@@ -180,6 +417,29 @@ def find_kept_edges(j, reps):  # pragma: no cover
     return np.array(output[::-1], dtype=reps.dtype)
 
 
+@numba.jit(nopython=True, cache=True)
+def make_workspace(A, n):  # pragma: no cover
+    """Allocates the scratch buffers used by :func:`f_into`, :func:`f_loop_into` and
+    :func:`f_loop_odd_into`, so that a thread can evaluate many terms without allocating.
+    The buffers have the type of ``A``, so that real matrices are handled in real arithmetic.
+
+    Args:
+        A (array): a two-dimensional matrix of the size the kernels are called with
+        n (int): largest number of polynomial coefficients the kernels are called with
+
+    Returns:
+        tuple[array, array, array, array, array]: tables for the polynomial coefficients,
+        the power traces, the scratch matrices and vectors of :func:`~.charpoly.powertrace_into`,
+        and two scratch vectors for the loop terms
+    """
+    m = A.shape[0]
+    comb = np.zeros((2, n + 1), dtype=A.dtype)
+    powtrace = np.zeros(max(2, n // 2 + 1), dtype=A.dtype)
+    mats, vecs = charpoly.powertrace_workspace(A)
+    loop_vecs = np.zeros((2, m), dtype=A.dtype)
+    return comb, powtrace, mats, vecs, loop_vecs
+
+
 @numba.jit(nopython=True, cache=True)
 def f(A, n):  # pragma: no cover
     """Evaluate the polynomial coefficients of the function in the eigenvalue-trace formula.
@@ -191,22 +451,44 @@ def f(A, n):  # pragma: no cover
     Returns:
         array: polynomial coefficients
     """
+    comb, powtrace, mats, vecs, _ = make_workspace(A, n)
+    return f_into(A, n, comb, powtrace, mats, vecs).copy()
+
+
+# pylint: disable = too-many-arguments
+@numba.jit(nopython=True, cache=True)
+def f_into(A, n, comb, powtrace, mats, vecs):  # pragma: no cover
+    """Evaluate the polynomial coefficients of :func:`f` in the buffers of a workspace
+    returned by :func:`make_workspace`, without modifying ``A``.
+
+    Args:
+        A (array): a two-dimensional matrix
+        n (int): number of polynomial coefficients to compute
+        comb (array): table for the polynomial coefficients
+        powtrace (array): table for the power traces
+        mats (array): scratch matrices
+        vecs (array): scratch vectors
+
+    Returns:
+        array: polynomial coefficients, as a view into ``comb``
+    """
     # Compute combinations in O(n^2log n) time
     # code translated from thewalrus matlab script
     count = 0
-    comb = np.zeros((2, n // 2 + 1), dtype=np.complex128)
+    size = n // 2 + 1
+    comb[:, :size] = 0
     comb[0, 0] = 1
-    powtrace = charpoly.powertrace(A, n // 2 + 1)
+    charpoly.powertrace_into(A, n // 2 + 1, powtrace, mats, vecs)
     for i in range(1, n // 2 + 1):
         factor = powtrace[i] / (2 * i)
         powfactor = 1
         count = 1 - count
-        comb[count, :] = comb[1 - count, :]
+        comb[count, :size] = comb[1 - count, :size]
         for j in range(1, n // (2 * i) + 1):
             powfactor *= factor / j
             for k in range(i * j + 1, n // 2 + 2):
                 comb[count, k - 1] += comb[1 - count, k - i * j - 1] * powfactor
-    return comb[count, :]
+    return comb[count, :size]
 
 
 @numba.jit(nopython=True, cache=True)
@@ -223,23 +505,53 @@ def f_loop(AX, AX_S, XD_S, D_S, n):  # pragma: no cover
     Returns:
         array: polynomial coefficients
     """
+    comb, powtrace, mats, vecs, loop_vecs = make_workspace(AX_S, n)
+    return f_loop_into(AX, AX_S, XD_S, D_S, n, comb, powtrace, mats, vecs, loop_vecs).copy()
+
+
+# pylint: disable = too-many-arguments
+@numba.jit(nopython=True, cache=True)
+def f_loop_into(AX, AX_S, XD_S, D_S, n, comb, powtrace, mats, vecs, loop_vecs):  # pragma: no cover
+    """Evaluate the polynomial coefficients of :func:`f_loop` in the buffers of a workspace
+    returned by :func:`make_workspace`, without modifying any of the inputs.
+
+    Args:
+        AX (array): two-dimensional matrix
+        AX_S (array): ``AX_S`` with weights given by repetitions and excluded rows removed
+        XD_S (array): diagonal multiplied by ``X``
+        D_S (array): diagonal
+        n (int): number of polynomial coefficients to compute
+        comb (array): table for the polynomial coefficients
+        powtrace (array): table for the power traces
+        mats (array): scratch matrices
+        vecs (array): scratch vectors
+        loop_vecs (array): scratch vectors for the loop terms
+
+    Returns:
+        array: polynomial coefficients, as a view into ``comb``
+    """
     # Compute combinations in O(n^2log n) time
     # code translated from thewalrus matlab script
     count = 0
-    comb = np.zeros((2, n // 2 + 1), dtype=np.complex128)
+    size = n // 2 + 1
+    comb[:, :size] = 0
     comb[0, 0] = 1
-    powtrace = charpoly.powertrace(AX, n // 2 + 1)
+    charpoly.powertrace_into(AX, n // 2 + 1, powtrace, mats, vecs)
+    XD_i = loop_vecs[0]
+    XD_next = loop_vecs[1]
+    XD_i[:] = XD_S
     for i in range(1, n // 2 + 1):
-        factor = powtrace[i] / (2 * i) + (XD_S @ D_S) / 2
-        XD_S = XD_S @ AX_S
+        factor = powtrace[i] / (2 * i) + (XD_i @ D_S) / 2
+        vecmat_into(XD_i, AX_S, XD_next)
+        XD_i, XD_next = XD_next, XD_i
         powfactor = 1
         count = 1 - count
-        comb[count, :] = comb[1 - count, :]
+        comb[count, :size] = comb[1 - count, :size]
         for j in range(1, n // (2 * i) + 1):
             powfactor *= factor / j
             for k in range(i * j + 1, n // 2 + 2):
                 comb[count, k - 1] += comb[1 - count, k - i * j - 1] * powfactor
-    return comb[count, :]
+    return comb[count, :size]
 
 
 # pylint: disable = too-many-arguments
@@ -260,143 +572,194 @@ def f_loop_odd(AX, AX_S, XD_S, D_S, n, oddloop, oddVX_S):  # pragma: no cover
     Returns:
         array: polynomial coefficients
     """
+    comb, powtrace, mats, vecs, loop_vecs = make_workspace(AX_S, n)
+    return f_loop_odd_into(
+        AX, AX_S, XD_S, D_S, n, oddloop, oddVX_S, comb, powtrace, mats, vecs, loop_vecs
+    ).copy()
+
+
+# pylint: disable = too-many-arguments
+@numba.jit(nopython=True, cache=True)
+def f_loop_odd_into(
+    AX, AX_S, XD_S, D_S, n, oddloop, oddVX_S, comb, powtrace, mats, vecs, loop_vecs
+):  # pragma: no cover
+    """Evaluate the polynomial coefficients of :func:`f_loop_odd` in the buffers of a
+    workspace returned by :func:`make_workspace`, without modifying any of the inputs.
+
+    Args:
+        AX (array): two-dimensional matrix
+        AX_S (array): ``AX_S`` with weights given by repetitions and excluded rows removed
+        XD_S (array): diagonal multiplied by ``X``
+        D_S (array): diagonal
+        n (int): number of polynomial coefficients to compute
+        oddloop (float): weight of self-edge
+        oddVX_S (array): vector corresponding to matrix at the index of the self-edge
+        comb (array): table for the polynomial coefficients
+        powtrace (array): table for the power traces
+        mats (array): scratch matrices
+        vecs (array): scratch vectors
+        loop_vecs (array): scratch vectors for the loop terms
+
+    Returns:
+        array: polynomial coefficients, as a view into ``comb``
+    """
 
     count = 0
-    comb = np.zeros((2, n + 1), dtype=np.complex128)
+    comb[:, : n + 1] = 0
     comb[0, 0] = 1
-    powtrace = charpoly.powertrace(AX, n // 2 + 1)
+    charpoly.powertrace_into(AX, n // 2 + 1, powtrace, mats, vecs)
+    D_i = loop_vecs[0]
+    D_next = loop_vecs[1]
+    D_i[:] = D_S
     for i in range(1, n + 1):
         if i == 1:
             factor = oddloop
         elif i % 2 == 0:
-            factor = powtrace[i // 2] / i + (XD_S @ D_S) / 2
+            factor = powtrace[i // 2] / i + (XD_S @ D_i) / 2
         else:
-            factor = oddVX_S @ D_S
-            D_S = AX_S @ D_S
+            factor = oddVX_S @ D_i
+            matvec_into(AX_S, D_i, D_next)
+            D_i, D_next = D_next, D_i
 
         powfactor = 1
         count = 1 - count
-        comb[count, :] = comb[1 - count, :]
+        comb[count, : n + 1] = comb[1 - count, : n + 1]
         for j in range(1, n // i + 1):
             powfactor *= factor / j
             for k in range(i * j + 1, n + 2):
                 comb[count, k - 1] += comb[1 - count, k - i * j - 1] * powfactor
 
-    return comb[count, :]
+    return comb[count, : n + 1]
 
 
 @numba.jit(nopython=True, cache=True)
-def get_AX_S(kept_edges, A):  # pragma: no cover
-    """Given the kept edges, return the appropriate scaled submatrices to compute ``f``.
+def vecmat_into(x, M, out):  # pragma: no cover
+    """Writes the product ``x @ M`` of a vector and a square matrix into ``out``.
 
     Args:
-        kept_edges (array): number of repetitions of each edge
-        A (array): matrix before repetitions applied
-
-    Returns:
-        array: scaled ``A @ X``, where ``X = ((0, I), (I, 0))``
+        x (array): vector
+        M (array): square matrix
+        out (array): vector distinct from ``x``
     """
-
-    z = np.concatenate((kept_edges, kept_edges))
-    nonzero_rows = np.where(z != 0)[0]
-    n_nonzero_edges = len(nonzero_rows) // 2
-
-    kept_edges_nonzero = kept_edges[np.where(kept_edges != 0)]
-
-    A_nonzero = nb_ix(A, nonzero_rows, nonzero_rows)
-
-    AX_nonzero = np.empty_like(A_nonzero, dtype=np.complex128)
-    AX_nonzero[:, :n_nonzero_edges] = kept_edges_nonzero * A_nonzero[:, n_nonzero_edges:]
-    AX_nonzero[:, n_nonzero_edges:] = kept_edges_nonzero * A_nonzero[:, :n_nonzero_edges]
-
-    return AX_nonzero
+    m = len(x)
+    for j in range(m):
+        out[j] = 0
+    for i in range(m):
+        xi = x[i]
+        for j in range(m):
+            out[j] += xi * M[i, j]
 
 
 @numba.jit(nopython=True, cache=True)
-def get_submatrices(kept_edges, A, D, oddV):  # pragma: no cover
-    """Given the kept edges, return the appropriate scaled submatrices to compute ``f``.
+def matvec_into(M, x, out):  # pragma: no cover
+    """Writes the product ``M @ x`` of a square matrix and a vector into ``out``.
 
     Args:
-        kept_edges (array): number of repetitions of each edge
-        A (array): matrix before repetitions applied
-        D (array): diagonal before repetitions applied
-        oddV (array): Row of matrix at index of self-edge. ``None`` is no self-edge.
-
-    Returns:
-        tuple[array, array, array, array]: scaled ``A @ X `` (where ``X = ((0, I), (I, 0))``),
-        scaled ``X @ D``, scaled ``D``, and scaled ``oddV @ X``
+        M (array): square matrix
+        x (array): vector
+        out (array): vector distinct from ``x``
     """
+    m = len(x)
+    for i in range(m):
+        total = M[i, 0] * 0
+        for j in range(m):
+            total += M[i, j] * x[j]
+        out[i] = total
 
-    z = np.concatenate((kept_edges, kept_edges))
-    nonzero_rows = np.where(z != 0)[0]
-    n_nonzero_edges = len(nonzero_rows) // 2
-
-    kept_edges_nonzero = kept_edges[np.where(kept_edges != 0)]
-
-    A_nonzero = nb_ix(A, nonzero_rows, nonzero_rows)
-
-    AX_nonzero = np.empty_like(A_nonzero, dtype=np.complex128)
-    AX_nonzero[:, :n_nonzero_edges] = kept_edges_nonzero * A_nonzero[:, n_nonzero_edges:]
-    AX_nonzero[:, n_nonzero_edges:] = kept_edges_nonzero * A_nonzero[:, :n_nonzero_edges]
 
-    D_nonzero = D[nonzero_rows]
+@numba.jit(nopython=True, cache=True)
+def gray_code_start(j, bases):  # pragma: no cover
+    """State of the reflected mixed-radix Gray code at index ``j``.
 
-    XD_nonzero = np.empty_like(D_nonzero, dtype=np.complex128)
-    XD_nonzero[:n_nonzero_edges] = kept_edges_nonzero * D_nonzero[n_nonzero_edges:]
-    XD_nonzero[n_nonzero_edges:] = kept_edges_nonzero * D_nonzero[:n_nonzero_edges]
+    Consecutive indices of the code differ in exactly one digit, which changes by ``±1``,
+    so that the code can be advanced with :func:`gray_code_next`.
 
-    if oddV is not None:
-        oddV_nonzero = oddV[nonzero_rows]
-        oddVX_nonzero = np.empty_like(oddV_nonzero, dtype=np.complex128)
-        oddVX_nonzero[:n_nonzero_edges] = kept_edges_nonzero * oddV_nonzero[n_nonzero_edges:]
-        oddVX_nonzero[n_nonzero_edges:] = kept_edges_nonzero * oddV_nonzero[:n_nonzero_edges]
-    else:
-        oddVX_nonzero = None
+    Args:
+        j (int): index in the code sequence
+        bases (array): radix of each digit, most significant first
 
-    return AX_nonzero, XD_nonzero, D_nonzero, oddVX_nonzero
+    Returns:
+        tuple[array, array, array]: plain mixed-radix digits of ``j``, the Gray code digits
+        and the direction (``±1``) in which each Gray code digit is currently moving
+    """
+    n = len(bases)
+    digits = np.zeros(n, dtype=np.int64)
+    gray = np.zeros(n, dtype=np.int64)
+    direction = np.ones(n, dtype=np.int64)
+    num = j
+    for i in range(n - 1, -1, -1):
+        digits[i] = num % bases[i]
+        num //= bases[i]
+    # a digit runs backwards whenever the number formed by the digits above it is odd
+    parity = 0
+    for i in range(n):
+        if parity == 0:
+            gray[i] = digits[i]
+        else:
+            gray[i] = bases[i] - 1 - digits[i]
+            direction[i] = -1
+        parity = (parity * bases[i] + digits[i]) % 2
+    return digits, gray, direction
 
 
 @numba.jit(nopython=True, cache=True)
-def get_submatrix_batch_odd0(kept_edges, oddV0):  # pragma: no cover
-    """Find ``oddVX_nonzero0`` for batching (sometimes different vertices are
-    identified as self edges).
+def gray_code_next(digits, gray, direction, bases):  # pragma: no cover
+    """Advances in place a state returned by :func:`gray_code_start` to the next index.
+    Must not be called on the last index of the code.
 
     Args:
-        kept_edges (array): number of repetitions of each edge
-        oddV0 (array): Row of matrix at index of self-edge. ``None`` is no self-edge.
+        digits (array): plain mixed-radix digits
+        gray (array): Gray code digits
+        direction (array): direction in which each Gray code digit is moving
+        bases (array): radix of each digit
+
     Returns:
-        array: scaled ``oddV0 @ X``
+        int: position of the only Gray code digit that changed
     """
-    z = np.concatenate((kept_edges, kept_edges))
-    nonzero_rows = np.where(z != 0)[0]
-    n_nonzero_edges = len(nonzero_rows) // 2
-
-    kept_edges_nonzero = kept_edges[np.where(kept_edges != 0)]
-    oddV_nonzero0 = oddV0[nonzero_rows]
-    oddVX_nonzero0 = np.empty_like(oddV_nonzero0, dtype=np.complex128)
-    oddVX_nonzero0[:n_nonzero_edges] = kept_edges_nonzero * oddV_nonzero0[n_nonzero_edges:]
-    oddVX_nonzero0[n_nonzero_edges:] = kept_edges_nonzero * oddV_nonzero0[:n_nonzero_edges]
-
-    return oddVX_nonzero0
+    i = len(bases) - 1
+    while digits[i] == bases[i] - 1:
+        digits[i] = 0
+        direction[i] = -direction[i]
+        i -= 1
+    digits[i] += 1
+    gray[i] += direction[i]
+    return i
 
 
 @numba.jit(nopython=True, cache=True)
-def get_Dsubmatrices(kept_edges, D):  # pragma: no cover
-    """Find submatrices for batch gamma functions."""
+def set_AX_edge(i, weight, A, AX):  # pragma: no cover
+    """Writes in place the two columns of ``AX`` associated with edge ``i`` of the
+    perfect matching, given the weight (number of kept repetitions) of that edge.
 
-    z = np.concatenate((kept_edges, kept_edges))
-    nonzero_rows = np.where(z != 0)[0]
-    n_nonzero_edges = len(nonzero_rows) // 2
+    Edges of weight zero leave zero columns in ``AX``, which is equivalent to removing the
+    corresponding rows and columns as far as the power traces are concerned.
 
-    kept_edges_nonzero = kept_edges[np.where(kept_edges != 0)]
+    Args:
+        i (int): edge index; the edge connects vertices ``i`` and ``i + n // 2``
+        weight (int): weight of the edge
+        A (array): matrix before repetitions applied
+        AX (array): scaled ``A @ X``, where ``X = ((0, I), (I, 0))``
+    """
+    n_edges = A.shape[0] // 2
+    for r in range(A.shape[0]):
+        AX[r, i] = weight * A[r, i + n_edges]
+        AX[r, i + n_edges] = weight * A[r, i]
 
-    D_nonzero = D[nonzero_rows]
 
-    XD_nonzero = np.empty_like(D_nonzero, dtype=np.complex128)
-    XD_nonzero[:n_nonzero_edges] = kept_edges_nonzero * D_nonzero[n_nonzero_edges:]
-    XD_nonzero[n_nonzero_edges:] = kept_edges_nonzero * D_nonzero[:n_nonzero_edges]
+@numba.jit(nopython=True, cache=True)
+def set_VX_edge(i, weight, V, VX):  # pragma: no cover
+    """Writes in place the two entries of ``VX`` associated with edge ``i`` of the
+    perfect matching, given the weight of that edge. Vector counterpart of :func:`set_AX_edge`.
 
-    return XD_nonzero, D_nonzero
+    Args:
+        i (int): edge index; the edge connects vertices ``i`` and ``i + n // 2``
+        weight (int): weight of the edge
+        V (array): vector before repetitions applied
+        VX (array): scaled ``X @ V``
+    """
+    n_edges = V.shape[0] // 2
+    VX[i] = weight * V[i + n_edges]
+    VX[i + n_edges] = weight * V[i]
 
 
 @numba.jit(nopython=True, cache=True)
@@ -414,52 +777,90 @@ def eigvals(M):  # pragma: no cover
 
 # pylint: disable=W0612, E1133
 @numba.jit(nopython=True, parallel=True, cache=True)
-def _calc_hafnian(A, edge_reps, glynn=True):  # pragma: no cover
+def _calc_hafnian(
+    A, edge_reps, glynn=True, n_chunks=SUM_CHUNKS, step_start=0, step_stop=-1
+):  # pragma: no cover
     r"""Compute hafnian, using inputs as prepared by frontend hafnian function compiled with Numba.
 
+    The terms of the sum are visited in reflected mixed-radix Gray code order, split into
+    contiguous blocks that are evaluated in parallel. Between neighbouring terms only one
+    kept-edge count changes, so ``A @ X`` is updated in place rather than gathered anew, and
+    each block evaluates its terms in a single workspace from :func:`make_workspace`.
+    Each block is summed with compensated summation and the blocks are combined in a fixed
+    order, so the result only depends on ``n_chunks`` and not on the number of threads.
+    All the arithmetic is done in the type of ``A``, either ``float64`` or ``complex128``.
+
+    Only the terms of index ``step_start <= j < step_stop`` are summed, so that the sum can be
+    shared between processes; the values returned for disjoint ranges covering all the terms
+    add up to the hafnian.
+
     Args:
         A (array): matrix ordered according to the chosen perfect matching
         edge_reps (array): how many times each edge in the perfect matching is repeated
         glynn (bool): whether to use finite difference sieve
+        n_chunks (int): number of blocks the sum is split into
+        step_start (int): index of the first term summed
+        step_stop (int): one past the index of the last term summed; negative for all the
+            terms after ``step_start``
 
     Returns:
-        complex: value of hafnian
+        float or complex: value of hafnian, or its partial sum over the given terms
     """
 
     n = A.shape[0]
     N = 2 * edge_reps.sum()  # number of photons
 
+    bases = edge_reps + 1
     if glynn:
-        steps = ((edge_reps[0] + 2) // 2) * np.prod(edge_reps[1:] + 1)
-    else:
-        steps = np.prod(edge_reps + 1)
+        bases[0] = (edge_reps[0] + 2) // 2
+    steps = np.prod(bases)
 
     # precompute binomial coefficients
     max_binom = edge_reps.max() + 1
     binoms = precompute_binoms(max_binom)
 
-    H = np.complex128(0)  # start running total for the hafnian
+    if step_stop < 0 or step_stop > steps:
+        step_stop = steps
+    step_start = min(step_start, step_stop)
+
+    n_chunks = num_chunks(step_stop - step_start, n_chunks)
+    H_chunks = np.zeros(n_chunks, dtype=A.dtype)
 
-    for j in numba.prange(steps):
-        kept_edges = find_kept_edges(j, edge_reps)
-        edge_sum = kept_edges.sum()
+    for c in numba.prange(n_chunks):
+        start, stop = chunk_range(c, n_chunks, step_stop - step_start)
+        start, stop = start + step_start, stop + step_start
+        digits, kept_edges, direction = gray_code_start(start, bases)
+        H_c, H_comp = A.dtype.type(0), A.dtype.type(0)
 
-        binom_prod = 1.0
+        AX = np.empty((n, n), dtype=A.dtype)
+        comb, powtrace, mats, vecs, _ = make_workspace(AX, N)
         for i in range(n // 2):
-            binom_prod *= binoms[edge_reps[i], kept_edges[i]]
+            weight = 2 * kept_edges[i] - edge_reps[i] if glynn else kept_edges[i]
+            set_AX_edge(i, weight, A, AX)
 
-        if glynn:
-            kept_edges = 2 * kept_edges - edge_reps
+        for j in range(start, stop):
+            if j > start:
+                i = gray_code_next(digits, kept_edges, direction, bases)
+                weight = 2 * kept_edges[i] - edge_reps[i] if glynn else kept_edges[i]
+                set_AX_edge(i, weight, A, AX)
 
-        AX_S = get_AX_S(kept_edges, A)
+            edge_sum = kept_edges.sum()
+
+            binom_prod = 1.0
+            for i in range(n // 2):
+                binom_prod *= binoms[edge_reps[i], kept_edges[i]]
+
+            prefac = (-1.0) ** (N // 2 - edge_sum) * binom_prod
+
+            if glynn and 2 * kept_edges[0] == edge_reps[0]:
+                prefac *= 0.5
 
-        prefac = (-1.0) ** (N // 2 - edge_sum) * binom_prod
+            Hnew = prefac * f_into(AX, N, comb, powtrace, mats, vecs)[N // 2]
+            H_c, H_comp = compensated_add(H_c, H_comp, Hnew)
 
-        if glynn and kept_edges[0] == 0:
-            prefac *= 0.5
-        Hnew = prefac * f(AX_S, N)[N // 2]
+        H_chunks[c] = H_c + H_comp
 
-        H += Hnew
+    H = tree_sum(H_chunks)
 
     if glynn:
         H = H * 0.5 ** (N // 2 - 1)
@@ -467,7 +868,13 @@ def _calc_hafnian(A, edge_reps, glynn=True):  # pragma: no cover
     return H
 
 
-def _haf(A, reps=None, glynn=True):
+@instrumented(
+    "_haf",
+    steps=lambda A, reps=None, glynn=True, step_range=None: gray_code_steps(
+        [1] * A.shape[0] if reps is None else reps, glynn, False, step_range
+    ),
+)
+def _haf(A, reps=None, glynn=True, step_range=None):
     r"""Calculate hafnian with (optional) repeated rows and columns.
     Code contributed by `Jake F.F. Bulmer <https://github.com/jakeffbulmer/gbs>`_ based on
     `arXiv:2108.01622 <https://arxiv.org/abs/2108.01622>`_.
@@ -478,12 +885,15 @@ def _haf(A, reps=None, glynn=True):
             each row/column assumed to be repeated once.
         glynn (bool): If ``True``, use Glynn-style finite difference sieve formula. If ``False``,
             use Ryser style inclusion/exclusion principle.
+        step_range (tuple[int, int]): If provided, only the terms of the sum with index
+            ``start <= j < stop`` are evaluated (see :func:`hafnian`).
 
     Returns
         complex: result of hafnian calculation
     """
 
     n = A.shape[0]
+    step_start, step_stop = step_bounds(step_range)
 
     if reps is None:
         reps = [1] * n
@@ -491,7 +901,7 @@ def _haf(A, reps=None, glynn=True):
     N = sum(reps)
 
     if N == 0:
-        return 1.0
+        return 1.0 if step_start == 0 and step_stop != 0 else 0.0
 
     if N % 2 == 1:
         return 0.0
@@ -502,17 +912,27 @@ def _haf(A, reps=None, glynn=True):
 
     # make new A matrix using the ordering from above
 
-    Ax = A[np.ix_(x, x)].astype(np.complex128)
+    Ax = A[np.ix_(x, x)].astype(kernel_dtype(A))
 
-    H = _calc_hafnian(Ax, edge_reps, glynn)
+    H = _calc_hafnian(Ax, edge_reps, glynn, SUM_CHUNKS, step_start, step_stop)
     return H
 
 
 # pylint: disable=too-many-arguments, redefined-outer-name, not-an-iterable
 @numba.jit(nopython=True, parallel=True, cache=True)
-def _calc_loop_hafnian(A, D, edge_reps, oddloop=None, oddV=None, glynn=True):  # pragma: no cover
+def _calc_loop_hafnian(
+    A,
+    D,
+    edge_reps,
+    oddloop=None,
+    oddV=None,
+    glynn=True,
+    n_chunks=SUM_CHUNKS,
+    step_start=0,
+    step_stop=-1,
+):  # pragma: no cover
     """Compute loop hafnian, using inputs as prepared by frontend loop_hafnian function
-    compiled with Numba.
+    compiled with Numba. The terms are visited and summed as in :func:`_calc_hafnian`.
     Code contributed by `Jake F.F. Bulmer <https://github.com/jakeffbulmer/gbs>`_ based on
     `arXiv:2108.01622 <https://arxiv.org/abs/2108.01622>`_.
 
@@ -523,50 +943,86 @@ def _calc_loop_hafnian(A, D, edge_reps, oddloop=None, oddV=None, glynn=True):  #
         oddloop (float): weight of self-loop in perfect matching, None if no self-loops
         oddV (array): row of matrix corresponding to the odd loop in the perfect matching
         glynn (bool): whether to use finite difference sieve
+        n_chunks (int): number of blocks the sum is split into
+        step_start (int): index of the first term summed
+        step_stop (int): one past the index of the last term summed; negative for all the
+            terms after ``step_start``
 
     Returns:
-        complex: value of loop hafnian
+        complex: value of loop hafnian, or its partial sum over the given terms
     """
 
     n = A.shape[0]
     N = 2 * edge_reps.sum()  # Number of photons
     if oddloop is not None:
         N += 1
+
+    bases = edge_reps + 1
     if glynn and (oddloop is None):
-        steps = ((edge_reps[0] + 2) // 2) * np.prod(edge_reps[1:] + 1)
-    else:
-        steps = np.prod(edge_reps + 1)
+        bases[0] = (edge_reps[0] + 2) // 2
+    steps = np.prod(bases)
 
     # Precompute binomial coefficients
     max_binom = edge_reps.max() + 1
     binoms = precompute_binoms(max_binom)
 
-    H = np.complex128(0)  # Start running total for the hafnian
+    if step_stop < 0 or step_stop > steps:
+        step_stop = steps
+    step_start = min(step_start, step_stop)
 
-    for j in numba.prange(steps):
-        kept_edges = find_kept_edges(j, edge_reps)
-        edge_sum = kept_edges.sum()
+    n_chunks = num_chunks(step_stop - step_start, n_chunks)
+    H_chunks = np.zeros(n_chunks, dtype=A.dtype)
 
-        binom_prod = 1.0
-        for i in range(n // 2):
-            binom_prod *= binoms[edge_reps[i], kept_edges[i]]
-
-        if glynn:
-            kept_edges = 2 * kept_edges - edge_reps
+    for c in numba.prange(n_chunks):
+        start, stop = chunk_range(c, n_chunks, step_stop - step_start)
+        start, stop = start + step_start, stop + step_start
+        digits, kept_edges, direction = gray_code_start(start, bases)
+        H_c, H_comp = A.dtype.type(0), A.dtype.type(0)
 
-        AX_S, XD_S, D_S, oddVX_S = get_submatrices(kept_edges, A, D, oddV)
-        AX = AX_S.copy()
+        AX_S = np.empty((n, n), dtype=A.dtype)
+        XD_S = np.empty(n, dtype=A.dtype)
+        oddVX_S = np.zeros(n, dtype=A.dtype)
+        comb, powtrace, mats, vecs, loop_vecs = make_workspace(AX_S, N)
+        for i in range(n // 2):
+            weight = 2 * kept_edges[i] - edge_reps[i] if glynn else kept_edges[i]
+            set_AX_edge(i, weight, A, AX_S)
+            set_VX_edge(i, weight, D, XD_S)
+            if oddV is not None:
+                set_VX_edge(i, weight, oddV, oddVX_S)
+
+        for j in range(start, stop):
+            if j > start:
+                i = gray_code_next(digits, kept_edges, direction, bases)
+                weight = 2 * kept_edges[i] - edge_reps[i] if glynn else kept_edges[i]
+                set_AX_edge(i, weight, A, AX_S)
+                set_VX_edge(i, weight, D, XD_S)
+                if oddV is not None:
+                    set_VX_edge(i, weight, oddV, oddVX_S)
+
+            edge_sum = kept_edges.sum()
+
+            binom_prod = 1.0
+            for i in range(n // 2):
+                binom_prod *= binoms[edge_reps[i], kept_edges[i]]
+
+            prefac = (-1.0) ** (N // 2 - edge_sum) * binom_prod
+
+            if oddloop is not None:
+                coeffs = f_loop_odd_into(
+                    AX_S, AX_S, XD_S, D, N, oddloop, oddVX_S, comb, powtrace, mats, vecs, loop_vecs
+                )
+                Hnew = prefac * coeffs[N]
+            else:
+                if glynn and 2 * kept_edges[0] == edge_reps[0]:
+                    prefac *= 0.5
+                coeffs = f_loop_into(AX_S, AX_S, XD_S, D, N, comb, powtrace, mats, vecs, loop_vecs)
+                Hnew = prefac * coeffs[N // 2]
 
-        prefac = (-1.0) ** (N // 2 - edge_sum) * binom_prod
+            H_c, H_comp = compensated_add(H_c, H_comp, Hnew)
 
-        if oddloop is not None:
-            Hnew = prefac * f_loop_odd(AX, AX_S, XD_S, D_S, N, oddloop, oddVX_S)[N]
-        else:
-            if glynn and kept_edges[0] == 0:
-                prefac *= 0.5
-            Hnew = prefac * f_loop(AX, AX_S, XD_S, D_S, N)[N // 2]
+        H_chunks[c] = H_c + H_comp
 
-        H += Hnew
+    H = tree_sum(H_chunks)
 
     if glynn:
         if oddloop is None:
@@ -578,7 +1034,13 @@ def _calc_loop_hafnian(A, D, edge_reps, oddloop=None, oddV=None, glynn=True):  #
 
 
 # pylint: disable=redefined-outer-name
-def loop_hafnian(A, D=None, reps=None, glynn=True):
+@instrumented(
+    "loop_hafnian",
+    steps=lambda A, D=None, reps=None, glynn=True, step_range=None: gray_code_steps(
+        [1] * A.shape[0] if reps is None else reps, glynn, True, step_range
+    ),
+)
+def loop_hafnian(A, D=None, reps=None, glynn=True, step_range=None):
     """Calculate loop hafnian with (optional) repeated rows and columns.
     Code contributed by `Jake F.F. Bulmer <https://github.com/jakeffbulmer/gbs>`_ based on
     `arXiv:2108.01622 <https://arxiv.org/abs/2108.01622>`_.
@@ -591,11 +1053,15 @@ def loop_hafnian(A, D=None, reps=None, glynn=True):
             row/column assumed to be repeated once.
         glynn (bool): If ``True``, use Glynn-style finite difference sieve formula, if ``False``,
             use Ryser style inclusion/exclusion principle.
+        step_range (tuple[int, int]): If provided, only the terms of the sum with index
+            ``start <= j < stop`` are evaluated (see :func:`hafnian`).
 
     Returns
         complex: result of loop hafnian calculation
     """
     n = A.shape[0]
+    step_start, step_stop = step_bounds(step_range)
+    first_step = step_start == 0 and step_stop != 0
 
     if reps is None:
         reps = [1] * n
@@ -605,10 +1071,10 @@ def loop_hafnian(A, D=None, reps=None, glynn=True):
     N = sum(reps)
 
     if N == 0:
-        return 1.0
+        return 1.0 if first_step else 0.0
 
     if N == 1:
-        return D[np.where(np.array(reps) == 1)[0][0]]
+        return D[np.where(np.array(reps) == 1)[0][0]] if first_step else 0.0
 
     assert n == len(reps)
 
@@ -617,17 +1083,20 @@ def loop_hafnian(A, D=None, reps=None, glynn=True):
     x, edge_reps, oddmode = matched_reps(reps)
 
     # Make new A matrix and D vector using the ordering from above
+    dtype = kernel_dtype(A, D)
     if oddmode is not None:
-        oddloop = D[oddmode].astype(np.complex128)
-        oddV = A[oddmode, x].astype(np.complex128)
+        oddloop = D[oddmode].astype(dtype)
+        oddV = A[oddmode, x].astype(dtype)
     else:
         oddloop = None
         oddV = None
 
-    Ax = A[np.ix_(x, x)].astype(np.complex128)
-    Dx = D[x].astype(np.complex128)
+    Ax = A[np.ix_(x, x)].astype(dtype)
+    Dx = D[x].astype(dtype)
 
-    H = _calc_loop_hafnian(Ax, Dx, edge_reps, oddloop, oddV, glynn)
+    H = _calc_loop_hafnian(
+        Ax, Dx, edge_reps, oddloop, oddV, glynn, SUM_CHUNKS, step_start, step_stop
+    )
     return H
 
 
@@ -682,18 +1151,6 @@ def bandwidth(A):
     return 0
 
 
-def powerset(iterable):
-    """Calculates the powerset of a list.
-
-    Args:
-        iterable (iterable): input list
-
-    Returns:
-        chain: chain of all subsets of input list
-    """
-    return chain.from_iterable(combinations(iterable, r) for r in range(len(iterable) + 1))
-
-
 def reduction(A, rpt):
     r"""Calculates the reduction of an array by a vector of indices.
     This is equivalent to repeating the ith row/column of :math:`A`, :math:`rpt_i` times.
@@ -723,6 +1180,8 @@ def hafnian(
     approx=False,
     num_samples=1000,
     method="glynn",
+    step_range=None,
+    approx_tol=None,
 ):  # pylint: disable=too-many-arguments
     """Returns the hafnian of a matrix.
     Code contributed by `Jake F.F. Bulmer <https://github.com/jakeffbulmer/gbs>`_ based on
@@ -742,6 +1201,14 @@ def hafnian(
             non-negative entries.
         num_samples (int): If ``approx=True``, the approximation algorithm performs ``num_samples``
             iterations for estimation of the hafnian of the non-negative matrix ``A``
+        step_range (tuple[int, int]): If provided, only the terms of index ``start <= j < stop``
+            of the ``"glynn"`` or ``"inclexcl"`` sum are evaluated and their partial sum is
+            returned. The partial sums over disjoint ranges covering all the terms add up to the
+            hafnian, which allows sharing its evaluation between processes or machines; see
+            :mod:`thewalrus.distributed`.
+        approx_tol (float): If ``approx=True``, the approximation algorithm stops before
+            ``num_samples`` iterations once the standard error of the estimate falls below
+            ``approx_tol`` times its magnitude; see :func:`hafnian_approx`
 
     Returns:
         int or float or complex: the hafnian of matrix ``A``
@@ -757,6 +1224,15 @@ def hafnian(
     if method == "inclexcl":
         glynn = False
 
+    if step_range is not None:
+        if approx or method not in ("glynn", "inclexcl"):
+            raise ValueError("step_range is only supported by the glynn and inclexcl methods.")
+        if loop:
+            return loop_hafnian(A, D=None, reps=None, glynn=True, step_range=step_range)
+        if matshape[0] % 2 != 0:
+            return 0.0
+        return _haf(A, reps=None, glynn=glynn, step_range=step_range)
+
     if matshape == (0, 0):
         return 1
 
@@ -805,7 +1281,7 @@ def hafnian(
         if np.any(A < 0):
             raise ValueError("Input matrix must not have negative entries")
 
-        return hafnian_approx(A, num_samples=num_samples)
+        return hafnian_approx(A, num_samples=num_samples, tol=approx_tol)
 
     if loop:
         if method == "recursive":
@@ -820,8 +1296,10 @@ def hafnian(
 
 def hafnian_sparse(A, D=None, loop=False):
     r"""Returns the hafnian of a sparse symmetric matrix.
-    This pure python implementation is very slow on full matrices, but faster the sparser a matrix is.
-    As a rule of thumb, the crossover in runtime with respect to :func:`~.hafnian` happens around 50% sparsity.
+    The cost grows exponentially only with the largest frontier of the elimination ordering of
+    the nonzero pattern (see :func:`sparse_hafnian`), not with the size of the matrix. As a rule
+    of thumb, the crossover in runtime with respect to :func:`~.hafnian` happens around 50%
+    sparsity.
 
     Args:
         A (array): the symmetric matrix of which we want to compute the hafnian
@@ -832,33 +1310,199 @@ def hafnian_sparse(A, D=None, loop=False):
     Returns:
         float: hafnian of ``A`` or of the submatrix of ``A`` defined by the set of indices ``D``
     """
-    if D is None:
-        D = frozenset(range(len(A)))
-    else:
-        D = frozenset(D)
-
-    if not loop:
-        A = A - np.diag(np.diag(A))
+    if D is not None:
+        if len(D) == 0:
+            return 1
+        D = sorted(D)
+        A = A[np.ix_(D, D)]
 
-    if np.allclose(A, 0):
+    if np.allclose(A if loop else A - np.diag(np.diag(A)), 0):
         return 0.0
 
-    r, _ = np.nonzero(A)
-    m = max(Counter(r).values())  # max nonzero values per row/column
+    return sparse_hafnian(A, loop=loop)
 
-    @lru_cache(maxsize=2**m)
-    def indices(d, k):
-        return d.intersection(set(np.nonzero(A[k])[0]))
 
-    @lru_cache(maxsize=2**m)
-    def lhaf(d: frozenset) -> float:
-        if not d:
-            return 1
-        d_ = set(d)
-        k = d_.pop()
-        return sum(A[i, k] * lhaf(frozenset(d_).difference({i})) for i in indices(d, k))
+def frontier_sizes(adjacency, order):
+    """Sizes of the frontiers of an elimination ordering, i.e., for each step, the number of
+    vertices already eliminated that still have a neighbour left to eliminate.
+
+    Args:
+        adjacency (array): boolean adjacency matrix without self-loops
+        order (array): elimination ordering of the vertices
+
+    Returns:
+        array: size of the frontier after each step
+    """
+    n = len(order)
+    pos = np.empty(n, dtype=np.int64)
+    pos[order] = np.arange(n)
+    # position of the last neighbour of each vertex in the ordering
+    last = np.where(adjacency, pos[None, :], -1).max(axis=1)
+    steps = np.arange(n)[:, None]
+    return ((pos[None, :] <= steps) & (last[None, :] > steps)).sum(axis=1)
+
+
+def min_frontier_order(adjacency):
+    """Greedy elimination ordering that eliminates at each step the vertex that leaves the
+    smallest frontier, breaking ties by the number of neighbours left to eliminate (minimum
+    degree).
+
+    Args:
+        adjacency (array): boolean adjacency matrix without self-loops
+
+    Returns:
+        array: elimination ordering of the vertices
+    """
+    n = len(adjacency)
+    remaining = np.ones(n, dtype=bool)
+    in_frontier = np.zeros(n, dtype=bool)
+    # number of neighbours of each vertex that are left to eliminate
+    degree = adjacency.sum(axis=1)
+    order = np.empty(n, dtype=np.int64)
+    for t in range(n):
+        candidates = np.where(remaining)[0]
+        # frontier vertices whose last remaining neighbour is the candidate leave the frontier
+        closing = (adjacency[candidates] & (in_frontier & (degree == 1))[None, :]).sum(axis=1)
+        sizes = in_frontier.sum() - closing + (degree[candidates] > 0)
+        v = candidates[np.lexsort((degree[candidates], sizes))[0]]
+        order[t] = v
+        remaining[v] = False
+        degree[adjacency[v]] -= 1
+        in_frontier[v] = True
+        in_frontier &= degree > 0
+    return order
+
+
+def elimination_order(A):
+    """Chooses the order in which :func:`sparse_hafnian` eliminates the vertices of the graph
+    with adjacency matrix given by the nonzero pattern of ``A``.
+
+    The candidates are the natural order, which is optimal for banded matrices, the reverse
+    Cuthill-McKee order, which reduces the bandwidth, and the greedy minimum frontier order. The
+    one with the fewest states over all steps is returned.
+
+    Args:
+        A (array): a square, symmetric array
+
+    Returns:
+        array: elimination ordering of the vertices
+    """
+    adjacency = A != 0
+    np.fill_diagonal(adjacency, False)
+    n = len(A)
+    rcm = reverse_cuthill_mckee(csr_matrix(adjacency.astype(np.float64)), symmetric_mode=True)
+    candidates = [np.arange(n), rcm.astype(np.int64), min_frontier_order(adjacency)]
+    costs = [np.sum(2.0 ** frontier_sizes(adjacency, order)) for order in candidates]
+    return candidates[int(np.argmin(costs))]
+
+
+@numba.jit(nopython=True, cache=True)
+def sparse_hafnian_kernel(A, order, loop):  # pragma: no cover
+    """Compiled kernel of :func:`sparse_hafnian`.
+
+    The vertices are eliminated in the given order. The state after each step is the set of
+    eliminated vertices still waiting to be matched to a later vertex, encoded as a bitmask over
+    the positions of the current frontier; the partial sums of all matchings leading to each
+    state are stored in an array indexed by the bitmask. Each eliminated vertex is either matched
+    to itself (loop hafnian only), matched to a waiting vertex or left waiting; states in which a
+    waiting vertex has no neighbour left are discarded.
+
+    Args:
+        A (array): a square, symmetric array
+        order (array): elimination ordering of the vertices
+        loop (bool): whether to compute the loop hafnian
+
+    Returns:
+        float or complex: the (loop) hafnian of ``A``
+    """
+    n = len(order)
+    pos = np.empty(n, dtype=np.int64)
+    for t in range(n):
+        pos[order[t]] = t
+    # position in the ordering of the last neighbour of each vertex
+    last = -np.ones(n, dtype=np.int64)
+    for u in range(n):
+        for w in range(n):
+            if w != u and A[u, w] != 0 and pos[w] > last[u]:
+                last[u] = pos[w]
+
+    frontier = np.empty(0, dtype=np.int64)
+    states = np.ones(1, dtype=A.dtype)
+    for t in range(n):
+        v = order[t]
+        f = len(frontier)
+        # bit j < f refers to frontier[j] and bit f to v; map them to the next frontier
+        extended = np.append(frontier, v)
+        new_bit = -np.ones(f + 1, dtype=np.int64)
+        dropped = 0
+        n_next = 0
+        for j in range(f + 1):
+            if last[extended[j]] > t:
+                new_bit[j] = n_next
+                n_next += 1
+            else:
+                dropped |= 1 << j
+        new_states = np.zeros(2**n_next, dtype=A.dtype)
+        diag = A[v, v] if loop else A.dtype.type(0)
+
+        for s in range(2**f):
+            value = states[s]
+            if value == 0:
+                continue
+            for option in range(f + 2):
+                if option < f:
+                    # match v to the waiting vertex frontier[option]
+                    if not (s >> option) & 1 or A[frontier[option], v] == 0:
+                        continue
+                    state, weight = s ^ (1 << option), A[frontier[option], v]
+                elif option == f:
+                    if diag == 0:
+                        continue
+                    state, weight = s, diag
+                else:
+                    state, weight = s | (1 << f), A.dtype.type(1)
+                if state & dropped:
+                    continue
+                index = 0
+                for j in range(f + 1):
+                    if (state >> j) & 1:
+                        index |= 1 << new_bit[j]
+                new_states[index] += weight * value
+
+        kept = np.empty(n_next, dtype=np.int64)
+        for j in range(f + 1):
+            if new_bit[j] >= 0:
+                kept[new_bit[j]] = extended[j]
+        frontier, states = kept, new_states
 
-    return lhaf(D)
+    return states[0]
+
+
+def sparse_hafnian(A, loop=False, order=None):
+    """Returns the (loop) hafnian of a sparse matrix by eliminating the vertices of the graph
+    given by its nonzero pattern one at a time.
+
+    The memory and time are proportional to the sum over the steps of ``2**f``, where ``f`` is
+    the number of eliminated vertices with a neighbour left to eliminate; for a matrix of
+    bandwidth ``w`` in the natural order, ``f <= w``.
+
+    Args:
+        A (array): a square, symmetric array
+        loop (bool): whether to compute the loop hafnian
+        order (array): elimination ordering of the vertices; chosen by
+            :func:`elimination_order` if not provided
+
+    Returns:
+        float or complex: the (loop) hafnian of ``A``
+    """
+    A = np.asarray(A)
+    if not np.iscomplexobj(A):
+        A = A.astype(np.float64)
+    if len(A) == 0:
+        return A.dtype.type(1)
+    if order is None:
+        order = elimination_order(A)
+    return sparse_hafnian_kernel(np.ascontiguousarray(A), np.asarray(order, dtype=np.int64), loop)
 
 
 def hafnian_repeated(A, rpt, mu=None, loop=False, rtol=1e-05, atol=1e-08, glynn=True):
@@ -879,7 +1523,9 @@ def hafnian_repeated(A, rpt, mu=None, loop=False, rtol=1e-05, atol=1e-08, glynn=
 
     However, using ``hafnian_repeated`` in the case where there are a large number
     of repeated rows and columns (:math:`\sum_{i}rpt_i \gg N`) can be
-    significantly faster.
+    significantly faster. The strategy with the lowest cost estimated by
+    :func:`repeated_hafnian_costs` is used, and reported to the hook set by
+    :func:`set_dispatch_hook`.
 
     .. note::
 
@@ -930,6 +1576,13 @@ def hafnian_repeated(A, rpt, mu=None, loop=False, rtol=1e-05, atol=1e-08, glynn=
     if len(mu) != len(A):
         raise ValueError("Length of means vector must be the same length as the matrix A.")
 
+    costs = repeated_hafnian_costs(nud, loop=loop, glynn=glynn)
+    strategy = min(costs, key=costs.get)
+    report_dispatch("hafnian_repeated", strategy, costs)
+
+    if strategy == "collision_free":
+        return collision_free_hafnian(A, np.asarray(mu), nud, loop=loop)
+
     if loop:
         return loop_hafnian(A, D=mu, reps=rpt, glynn=glynn)
 
@@ -941,6 +1594,9 @@ def hafnian_banded(A, loop=False, rtol=1e-05, atol=1e-08):
     For the derivation see Section V of `'Efficient sampling from shallow Gaussian quantum-optical
     circuits with local interactions', Qi et al. <https://arxiv.org/abs/2009.11824>`_.
 
+    The subhafnians are computed by :func:`sparse_hafnian` eliminating the vertices in the natural
+    order, so that at most ``bandwidth(A)`` vertices wait to be matched at any step.
+
     Args:
         A (array): a square, symmetric array of even dimensions
 
@@ -948,31 +1604,7 @@ def hafnian_banded(A, loop=False, rtol=1e-05, atol=1e-08):
         int or float or complex: the loop hafnian of matrix ``A``
     """
     input_validation(A, atol=atol, rtol=rtol)
-    (n, _) = A.shape
-    w = bandwidth(A)
-    if not loop:
-        A = A - np.diag(np.diag(A))
-    loop_haf = {(): 1, (1,): A[0, 0]}
-    for t in range(1, n + 1):
-        if t - 2 * w - 1 > 0:
-            lower_end = set(range(1, t - 2 * w))
-        else:
-            lower_end = set()
-        upper_end = set(range(1, t + 1))
-        diff = [item for item in upper_end if item not in lower_end]
-        # Makes sure set ordering is preserved when the difference of two sets is taken
-        # This is also used in the if statement below
-        ps = powerset(diff)
-        lower_end = tuple(lower_end)
-        for D in ps:
-            if lower_end + D not in loop_haf:
-                loop_haf[lower_end + D] = sum(
-                    A[i - 1, t - 1]
-                    * loop_haf[tuple(item for item in lower_end + D if item not in set((i, t)))]
-                    for i in D
-                )
-
-    return loop_haf[tuple(range(1, n + 1))]
+    return sparse_hafnian(A, loop=loop, order=np.arange(len(A)))
 
 
 @numba.jit(nopython=True)
@@ -1045,41 +1677,108 @@ def solve(b, s, w, g, n):  # pragma: no cover
     return h + solve(c, s - 2, w, e, n)
 
 
-@numba.jit(nopython=True)
-def _one_det(B):  # pragma: no cover
+@numba.jit(nopython=True, cache=True)
+def _one_det(B, key0, key1, index):  # pragma: no cover
     """Calculates the determinant of an antisymmetric matrix with entries distributed
     according to a normal distribution, with scale equal to the entries of the symmetric matrix
     given as input.
 
+    The diagonal, which does not change the expectation of the determinant, is left at zero so
+    that it does not add to its variance.
+
     Args:
         B (array[float]): symmetric matrix
+        key0, key1 (int): 32-bit words of the key of the counter-based generator
+        index (int): index of the sample, which its normal variates only depend on
 
     Returns:
         float: determinant of the samples antisymmetric matrix
     """
-    mat = np.empty_like(B, dtype=np.float64)
-    n, m = B.shape
+    n = B.shape[0]
+    mat = np.zeros((n, n), dtype=np.float64)
+    draw = 0
+    g0, g1 = 0.0, 0.0
     for i in range(n):
-        for j in range(m):
-            mat[i, j] = B[i, j] * np.random.normal()
+        for j in range(i + 1, n):
+            if draw % 2 == 0:
+                g0, g1 = philox_normals(key0, key1, index, draw // 2)
+                mat[i, j] = B[i, j] * g0
+            else:
+                mat[i, j] = B[i, j] * g1
             mat[j, i] = -mat[i, j]
+            draw += 1
     return np.linalg.det(mat)
 
 
-@numba.jit(nopython=True)
-def hafnian_approx(A, num_samples=1000):  # pragma: no cover
+@numba.jit(nopython=True, parallel=True, cache=True)
+def _det_batch(B, key0, key1, start, stop):  # pragma: no cover
+    """Determinants of :func:`_one_det` for the samples of index ``start <= j < stop``,
+    evaluated in parallel.
+
+    Args:
+        B (array[float]): symmetric matrix
+        key0, key1 (int): 32-bit words of the key of the counter-based generator
+        start (int): index of the first sample
+        stop (int): one past the index of the last sample
+
+    Returns:
+        array[float]: determinant of each sample
+    """
+    dets = np.empty(stop - start, dtype=np.float64)
+    # pylint: disable=not-an-iterable
+    for j in numba.prange(stop - start):
+        dets[j] = _one_det(B, key0, key1, start + j)
+    return dets
+
+
+# pylint: disable=too-many-arguments
+def hafnian_approx(A, num_samples=1000, tol=None, batch_size=256, rng=None, return_error=False):
     """Returns the approximation to the hafnian of a matrix with non-negative entries.
 
     The approximation follows the stochastic Barvinok's approximation allowing the
     hafnian can be approximated as the sum of determinants of matrices.
     The accuracy of the approximation increases with increasing number of iterations.
 
+    The determinants are evaluated in parallel by batches of ``batch_size`` samples, after each
+    of which the standard error of the mean is updated. If ``tol`` is given, the estimation
+    stops as soon as the standard error falls below ``tol`` times the magnitude of the mean,
+    or after ``num_samples`` samples otherwise.
+
     Args:
-        B (array[float]): a symmetric matrix
+        A (array[float]): a symmetric matrix
+        num_samples (int): maximum number of samples
+        tol (float): relative standard error at which the estimation stops
+        batch_size (int): number of samples evaluated between two updates of the error
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): seed of the
+            counter-based generator; drawn from the global generator of ``numpy.random`` if
+            ``None``
+        return_error (bool): whether the standard error and the number of samples are returned
 
     Returns:
-        float: approximate hafnian of the input
+        float or tuple[float, float, int]: approximate hafnian of the input, with its standard
+        error and the number of samples used if ``return_error=True``
     """
+    if rng is None:
+        rng = [int(i) for i in np.random.randint(2**32, size=2, dtype=np.int64)]
+    key0, key1 = stream_key(seed_sequence(rng))
 
     sqrtA = np.sqrt(A)
-    return np.array([_one_det(sqrtA) for _ in range(num_samples)]).mean()
+    mean, m2, count = 0.0, 0.0, 0
+    error = np.inf
+    while count < num_samples:
+        dets = _det_batch(sqrtA, key0, key1, count, min(count + batch_size, num_samples))
+        # combine the mean and the sum of squared deviations of the batch with the previous ones
+        batch_mean = dets.mean()
+        delta = batch_mean - mean
+        total = count + len(dets)
+        mean += delta * len(dets) / total
+        m2 += np.sum((dets - batch_mean) ** 2) + delta**2 * count * len(dets) / total
+        count = total
+        if count > 1:
+            error = np.sqrt(m2 / ((count - 1) * count))
+        if tol is not None and error <= tol * abs(mean):
+            break
+
+    if return_error:
+        return mean, error, count
+    return mean
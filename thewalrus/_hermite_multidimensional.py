@@ -15,14 +15,19 @@
 Hermite Multidimensional Python interface
 """
 from typing import Tuple, Generator, Iterable
-from numba import jit
+from numba import jit, prange
 from numba.cpython.unsafe.tuple import tuple_setitem
 import numpy as np
 
 from ._hafnian import input_validation
+from .instrumentation import instrumented
 
 
 # pylint: disable=too-many-arguments
+@instrumented(
+    "hermite_multidimensional",
+    steps=lambda R, cutoff, *args, **kwargs: np.prod(np.broadcast_to(cutoff, len(R))),
+)
 def hermite_multidimensional(
     R, cutoff, y=None, C=1, renorm=False, make_tensor=True, modified=False, rtol=1e-05, atol=1e-08
 ):
@@ -246,8 +251,191 @@ def remove(
 
 SQRT = np.sqrt(np.arange(1000))  # saving the time to recompute square roots
 
+# number of entries of a photon number layer processed together by a thread
+HERMITE_TILE = 256
 
-@jit(nopython=True)
+
+@jit(nopython=True, cache=True)
+def tensor_shape(G):  # pragma: no cover
+    r"""Shape of a tensor as an array, so that it can be indexed by a variable.
+
+    Args:
+        G (array): the tensor
+
+    Returns:
+        array[int]: the size of every dimension
+    """
+    shape = np.empty(G.ndim, dtype=np.int64)
+    for k in range(G.ndim):
+        shape[k] = G.shape[k]
+    return shape
+
+
+@jit(nopython=True, cache=True)
+def next_index(digits, shape):  # pragma: no cover
+    r"""Advances a multi-index to the next entry of a C-ordered tensor.
+
+    Args:
+        digits (array[int]): the multi-index, overwritten
+        shape (array[int]): the size of every dimension
+
+    Returns:
+        int: the change of the sum of the indices
+    """
+    change = 0
+    for k in range(len(shape) - 1, -1, -1):
+        digits[k] += 1
+        change += 1
+        if digits[k] < shape[k]:
+            break
+        change -= digits[k]
+        digits[k] = 0
+    return change
+
+
+@jit(nopython=True, cache=True)
+def layer_order(shape):  # pragma: no cover
+    r"""Orders the entries of a C-ordered tensor by total photon number, that is by the sum of
+    their indices. The Hermite recursions only read entries of the two layers below the one
+    they fill, so the entries of a layer can be filled in parallel.
+
+    Args:
+        shape (array[int]): the size of every dimension
+
+    Returns:
+        tuple[array, array, array]: distance in entries between consecutive indices of every
+        dimension, flat indices sorted by layer, ascending within a layer, and position in the
+        sorted indices of the first entry of every layer, followed by the number of entries
+    """
+    n = len(shape)
+    strides = np.ones(n, dtype=np.int64)
+    for k in range(n - 2, -1, -1):
+        strides[k] = strides[k + 1] * shape[k + 1]
+    size = strides[0] * shape[0]
+    num_layers = np.sum(shape - 1) + 1
+
+    # counting sort of the entries by layer, walking the tensor twice
+    counts = np.zeros(num_layers + 1, dtype=np.int64)
+    digits = np.zeros(n, dtype=np.int64)
+    total = 0
+    for f in range(size):
+        counts[total + 1] += 1
+        total += next_index(digits, shape)
+
+    starts = np.cumsum(counts)
+    order = np.empty(size, dtype=np.int64)
+    fill = starts[:-1].copy()
+    total = 0
+    for f in range(size):
+        order[fill[total]] = f
+        fill[total] += 1
+        total += next_index(digits, shape)
+    return strides, order, starts
+
+
+@jit(nopython=True, cache=True)
+def entry_digits(f, strides, shape, digits):  # pragma: no cover
+    r"""Writes the multi-index of the entry of a given flat index, and returns the first of its
+    dimensions with a nonzero index.
+
+    Args:
+        f (int): flat index of the entry
+        strides (array[int]): distance in entries between consecutive indices of every dimension
+        shape (array[int]): the size of every dimension
+        digits (array[int]): array overwritten by the multi-index
+
+    Returns:
+        int: the first dimension with a nonzero index
+    """
+    first = -1
+    for k in range(len(strides)):
+        digits[k] = (f // strides[k]) % shape[k]
+        if first < 0 and digits[k] > 0:
+            first = k
+    return first
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def _hermite_layers(R, y, G, renorm):  # pragma: no cover
+    r"""Numba-compiled function to fill an array with the Hermite polynomials, one photon
+    number layer at a time, the entries of a layer being filled in parallel by tiles of
+    ``HERMITE_TILE`` consecutive entries. It expects an array initialized with zeros
+    everywhere except at index (0,...,0) (i.e. the seed value).
+
+    Args:
+        R (array[complex]): square matrix parametrizing the Hermite polynomial
+        y (vector[complex]): vector argument of the Hermite polynomial
+        G (array[complex]): C-contiguous array to be filled with the Hermite polynomials
+        renorm (bool): whether the polynomials are normalized by :math:`\sqrt{\prod_i k_i!}`
+
+    Returns:
+        array[complex]: the multidimensional Hermite polynomials
+    """
+    shape = tensor_shape(G)
+    strides, order, starts = layer_order(shape)
+    flat = G.reshape(-1)
+    n = len(shape)
+    for layer in range(1, len(starts) - 1):
+        lo, hi = starts[layer], starts[layer + 1]
+        for t in prange((hi - lo + HERMITE_TILE - 1) // HERMITE_TILE):
+            digits = np.empty(n, dtype=np.int64)
+            for e in range(lo + t * HERMITE_TILE, min(lo + (t + 1) * HERMITE_TILE, hi)):
+                f = order[e]
+                i = entry_digits(f, strides, shape, digits)
+                ki = f - strides[i]
+                digits[i] -= 1
+                u = y[i] * flat[ki]
+                for l in range(n):
+                    if digits[l] > 0:
+                        weight = SQRT[digits[l]] if renorm else digits[l]
+                        u -= weight * R[i, l] * flat[ki - strides[l]]
+                flat[f] = u / SQRT[digits[i] + 1] if renorm else u
+    return G
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def _interferometer_layers(R, G, renorm):  # pragma: no cover
+    r"""Numba-compiled function returning the matrix elements of an interferometer
+    parametrized in terms of its R matrix, one photon number layer at a time as done by
+    :func:`_hermite_layers`. Only the entries with as many photons in the first half of the
+    indices as in the second half are nonzero, so the odd layers are skipped.
+
+    Args:
+        R (array[complex]): square matrix parametrizing the Hermite polynomial
+        G (array[complex]): C-contiguous array to be filled with the Hermite polynomials
+        renorm (bool): whether the polynomials are normalized by :math:`\sqrt{\prod_i k_i!}`
+
+    Returns:
+        array[complex]: the multidimensional Hermite polynomials
+    """
+    shape = tensor_shape(G)
+    strides, order, starts = layer_order(shape)
+    flat = G.reshape(-1)
+    n = len(shape)
+    num_modes = R.shape[0] // 2
+    for layer in range(2, len(starts) - 1, 2):
+        lo, hi = starts[layer], starts[layer + 1]
+        for t in prange((hi - lo + HERMITE_TILE - 1) // HERMITE_TILE):
+            digits = np.empty(n, dtype=np.int64)
+            for e in range(lo + t * HERMITE_TILE, min(lo + (t + 1) * HERMITE_TILE, hi)):
+                f = order[e]
+                i = entry_digits(f, strides, shape, digits)
+                if 2 * digits[:num_modes].sum() != layer:
+                    continue
+                ki = f - strides[i]
+                digits[i] -= 1
+                u = flat[0] * 0
+                for l in range(n):
+                    if digits[l] > 0:
+                        weight = SQRT[digits[l]] if renorm else digits[l]
+                        u -= weight * R[i, l] * flat[ki - strides[l]]
+                flat[f] = u / SQRT[digits[i] + 1] if renorm else u
+    return G
+
+
+@jit(nopython=True, cache=True)
 def _hermite_multidimensional_renorm(R, y, G):  # pragma: no cover
     r"""Numba-compiled function to fill an array with the Hermite polynomials. It expects an array
     initialized with zeros everywhere except at index (0,...,0) (i.e. the seed value).
@@ -260,22 +448,10 @@ def _hermite_multidimensional_renorm(R, y, G):  # pragma: no cover
     Returns:
         array[complex]: the multidimensional Hermite polynomials
     """
-    indices = np.ndindex(G.shape)
-    next(indices)  # skip the first index (0,...,0)
-    for idx in indices:
-        i = 0
-        for i, val in enumerate(idx):
-            if val > 0:
-                break
-        ki = dec(idx, i)
-        u = y[i] * G[ki]
-        for l, kl in remove(ki):
-            u -= SQRT[ki[l]] * R[i, l] * G[kl]
-        G[idx] = u / SQRT[idx[i]]
-    return G
+    return _hermite_layers(R, y, G, True)
 
 
-@jit(nopython=True)
+@jit(nopython=True, cache=True)
 def _hermite_multidimensional(R, y, G):  # pragma: no cover
     r"""Numba-compiled function to fill an array with the Hermite polynomials. It expects an array
     initialized with zeros everywhere except at index (0,...,0) (i.e. the seed value).
@@ -288,22 +464,10 @@ def _hermite_multidimensional(R, y, G):  # pragma: no cover
     Returns:
         array[complex]: the multidimensional Hermite polynomials
     """
-    indices = np.ndindex(G.shape)
-    next(indices)  # skip the first index (0,...,0)
-    for idx in indices:
-        i = 0
-        for i, val in enumerate(idx):
-            if val > 0:
-                break
-        ki = dec(idx, i)
-        u = y[i] * G[ki]
-        for l, kl in remove(ki):
-            u -= ki[l] * R[i, l] * G[kl]
-        G[idx] = u
-    return G
+    return _hermite_layers(R, y, G, False)
 
 
-@jit(nopython=True)
+@jit(nopython=True, cache=True)
 def _interferometer_renorm(R, G):  # pragma: no cover
     r"""Numba-compiled function returning the matrix elements of an interferometer
     parametrized in terms of its R matrix
@@ -315,35 +479,10 @@ def _interferometer_renorm(R, G):  # pragma: no cover
     Returns:
         array[complex]: the multidimensional Hermite polynomials
     """
-    dim, _ = R.shape
-    num_modes = dim / 2
-
-    indices = np.ndindex(G.shape)
-    next(indices)  # skip the first index (0,...,0)
-    for idx in indices:
-        bran = 0
-        for ii in range(0, num_modes):
-            bran += idx[ii]
-
-        ketn = 0
-        for ii in range(num_modes, dim):
-            ketn += idx[ii]
-
-        if bran == ketn:
-            i = 0
-            for i, val in enumerate(idx):
-                if val > 0:
-                    break
-            ki = dec(idx, i)
-            u = 0
-            for l, kl in remove(ki):
-                u -= SQRT[ki[l]] * R[i, l] * G[kl]
-            G[idx] = u / SQRT[idx[i]]
+    return _interferometer_layers(R, G, True)
 
-    return G
 
-
-@jit(nopython=True)
+@jit(nopython=True, cache=True)
 def _interferometer(R, G):  # pragma: no cover
     r"""Numba-compiled function returning the matrix elements of an interferometer
     parametrized in terms of its R matrix
@@ -355,32 +494,7 @@ def _interferometer(R, G):  # pragma: no cover
     Returns:
         array[complex]: the multidimensional Hermite polynomials
     """
-    dim, _ = R.shape
-    num_modes = dim / 2
-
-    indices = np.ndindex(G.shape)
-    next(indices)  # skip the first index (0,...,0)
-    for idx in indices:
-        bran = 0
-        for ii in range(0, num_modes):
-            bran += idx[ii]
-
-        ketn = 0
-        for ii in range(num_modes, dim):
-            ketn += idx[ii]
-
-        if bran == ketn:
-            i = 0
-            for i, val in enumerate(idx):
-                if val > 0:
-                    break
-            ki = dec(idx, i)
-            u = 0
-            for l, kl in remove(ki):
-                u -= ki[l] * R[i, l] * G[kl]
-            G[idx] = u
-
-    return G
+    return _interferometer_layers(R, G, False)
 
 
 def grad_hermite_multidimensional(G, R, y, C=1, renorm=True, dtype=None):
@@ -408,6 +522,7 @@ def grad_hermite_multidimensional(G, R, y, C=1, renorm=True, dtype=None):
         raise ValueError(
             f"The matrix R and vector y have incompatible dimensions ({R.shape} vs {y.shape})"
         )
+    G = np.ascontiguousarray(G)
     dG_dC = np.array(G / C).astype(dtype)
     dG_dR = np.zeros(G.shape + R.shape, dtype=dtype)
     dG_dy = np.zeros(G.shape + y.shape, dtype=dtype)
@@ -419,7 +534,63 @@ def grad_hermite_multidimensional(G, R, y, C=1, renorm=True, dtype=None):
     return dG_dC, dG_dR, dG_dy
 
 
-@jit(nopython=True)
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def _grad_hermite_layers(R, y, G, dG_dR, dG_dy, renorm):  # pragma: no cover
+    r"""Numba-compiled function to fill two arrays (dG_dR, dG_dy) with the gradients of the
+    multidimensional Hermite polynomials with respect to :math:`R` and :math:`y`, one photon
+    number layer at a time as done by :func:`_hermite_layers`.
+
+    Args:
+        R (array[complex]): square matrix parametrizing the Hermite polynomial
+        y (vector[complex]): vector argument of the Hermite polynomial
+        G (array[complex]): C-contiguous array of the multidimensional Hermite polynomials
+        dG_dR (array[complex]): C-contiguous array to be filled with the gradients with respect to R
+        dG_dy (array[complex]): C-contiguous array to be filled with the gradients with respect to y
+        renorm (bool): whether the polynomials are normalized by :math:`\sqrt{\prod_i k_i!}`
+
+    Returns:
+        dG_dR[complex], dG_dy[complex]: the gradients with respect to R and y
+    """
+    shape = tensor_shape(G)
+    strides, order, starts = layer_order(shape)
+    flat = G.reshape(-1)
+    n = len(shape)
+    flat_dR = dG_dR.reshape((flat.size, n, n))
+    flat_dy = dG_dy.reshape((flat.size, n))
+    for layer in range(1, len(starts) - 1):
+        lo, hi = starts[layer], starts[layer + 1]
+        for t in prange((hi - lo + HERMITE_TILE - 1) // HERMITE_TILE):
+            digits = np.empty(n, dtype=np.int64)
+            for e in range(lo + t * HERMITE_TILE, min(lo + (t + 1) * HERMITE_TILE, hi)):
+                f = order[e]
+                i = entry_digits(f, strides, shape, digits)
+                ki = f - strides[i]
+                digits[i] -= 1
+                for a in range(n):
+                    flat_dy[f, a] = y[i] * flat_dy[ki, a]
+                    for b in range(n):
+                        flat_dR[f, a, b] = y[i] * flat_dR[ki, a, b]
+                flat_dy[f, i] += flat[ki]
+                for l in range(n):
+                    if digits[l] > 0:
+                        weight = SQRT[digits[l]] if renorm else digits[l]
+                        kl = ki - strides[l]
+                        for a in range(n):
+                            flat_dy[f, a] -= weight * flat_dy[kl, a] * R[i, l]
+                            for b in range(n):
+                                flat_dR[f, a, b] -= weight * R[i, l] * flat_dR[kl, a, b]
+                        flat_dR[f, i, l] -= weight * flat[kl]
+                if renorm:
+                    norm = SQRT[digits[i] + 1]
+                    for a in range(n):
+                        flat_dy[f, a] /= norm
+                        for b in range(n):
+                            flat_dR[f, a, b] /= norm
+    return dG_dR, dG_dy
+
+
+@jit(nopython=True, cache=True)
 def _grad_hermite_multidimensional_renorm(R, y, G, dG_dR, dG_dy):  # pragma: no cover
     r"""
     Numba-compiled function to fill two arrays (dG_dR, dG_dy) with the gradients of the renormalized multidimensional Hermite polynomials
@@ -435,27 +606,10 @@ def _grad_hermite_multidimensional_renorm(R, y, G, dG_dR, dG_dy):  # pragma: no
     Returns:
         dG_dR[complex], dG_dy[complex]: the gradients of the renormalized multidimensional Hermite polynomials with respect to R and y
     """
-    indices = np.ndindex(G.shape)
-    next(indices)  # skip the first index (0,...,0)
-    for idx in indices:
-        i = 0
-        for i, val in enumerate(idx):
-            if val > 0:
-                break
-        ki = dec(idx, i)
-        dy = y[i] * dG_dy[ki]
-        dy[i] += G[ki]
-        dR = y[i] * dG_dR[ki]
-        for l, kl in remove(ki):
-            dy -= SQRT[ki[l]] * dG_dy[kl] * R[i, l]
-            dR -= SQRT[ki[l]] * R[i, l] * dG_dR[kl]
-            dR[i, l] -= SQRT[ki[l]] * G[kl]
-        dG_dR[idx] = dR / SQRT[idx[i]]
-        dG_dy[idx] = dy / SQRT[idx[i]]
-    return dG_dR, dG_dy
+    return _grad_hermite_layers(R, y, G, dG_dR, dG_dy, True)
 
 
-@jit(nopython=True)
+@jit(nopython=True, cache=True)
 def _grad_hermite_multidimensional(R, y, G, dG_dR, dG_dy):  # pragma: no cover
     r"""
     Numba-compiled function to fill two arrays (dG_dR, dG_dy) with the gradients of the renormalized multidimensional Hermite polynomials
@@ -471,21 +625,430 @@ def _grad_hermite_multidimensional(R, y, G, dG_dR, dG_dy):  # pragma: no cover
     Returns:
         dG_dR[complex], dG_dy[complex]: the gradients of the renormalized multidimensional Hermite polynomials with respect to R and y
     """
-    indices = np.ndindex(G.shape)
-    next(indices)  # skip the first index (0,...,0)
-    for idx in indices:
-        i = 0
-        for i, val in enumerate(idx):
-            if val > 0:
-                break
-        ki = dec(idx, i)
-        dy = y[i] * dG_dy[ki]
-        dy[i] += G[ki]
-        dR = y[i] * dG_dR[ki]
-        for l, kl in remove(ki):
-            dy -= ki[l] * dG_dy[kl] * R[i, l]
-            dR -= ki[l] * R[i, l] * dG_dR[kl]
-            dR[i, l] -= ki[l] * G[kl]
-        dG_dR[idx] = dR
-        dG_dy[idx] = dy
+    return _grad_hermite_layers(R, y, G, dG_dR, dG_dy, False)
+
+
+# ===============================================================================================
+# Total photon number cutoff
+# ===============================================================================================
+
+
+def binomial_table(n):
+    r"""Binomial coefficients :math:`\binom{a}{b}` for :math:`0 \leq a, b \leq n`.
+
+    Args:
+        n (int): largest upper argument
+
+    Returns:
+        array[int]: the coefficients, indexed by ``[a, b]``
+    """
+    table = np.zeros((n + 1, n + 1), dtype=np.int64)
+    for a in range(n + 1):
+        table[a, 0] = 1
+        for b in range(1, a + 1):
+            table[a, b] = table[a - 1, b - 1] + table[a - 1, b]
+    return table
+
+
+@jit(nopython=True, cache=True)
+def layer_offset(total, num_modes, binom):  # pragma: no cover
+    r"""Number of multi-indices of ``num_modes`` non-negative integers adding up to less than
+    ``total``, that is the position of the first multi-index of that total in the packed layout.
+
+    Args:
+        total (int): total photon number
+        num_modes (int): number of modes
+        binom (array[int]): binomial coefficients, as returned by :func:`binomial_table`
+
+    Returns:
+        int: the position
+    """
+    if total == 0:
+        return 0
+    return binom[total - 1 + num_modes, num_modes]
+
+
+@jit(nopython=True, cache=True)
+def total_rank(k, binom):  # pragma: no cover
+    r"""Position of a multi-index in the packed layout, where the multi-indices are sorted by
+    total photon number and then lexicographically.
+
+    Args:
+        k (array[int]): the multi-index
+        binom (array[int]): binomial coefficients, as returned by :func:`binomial_table`
+
+    Returns:
+        int: the position
+    """
+    n = len(k)
+    remaining = k.sum()
+    rank = layer_offset(remaining, n, binom)
+    for j in range(n - 1):
+        parts = n - j - 1
+        # multi-indices sharing the first j indices with a smaller index j
+        rank += binom[remaining + parts, parts] - binom[remaining - k[j] + parts, parts]
+        remaining -= k[j]
+    return rank
+
+
+@jit(nopython=True, cache=True)
+def total_unrank(total, rank, k, binom):  # pragma: no cover
+    r"""Writes the multi-index of a given position within the multi-indices of a given total.
+
+    Args:
+        total (int): total photon number
+        rank (int): position among the multi-indices of that total
+        k (array[int]): array overwritten by the multi-index
+        binom (array[int]): binomial coefficients, as returned by :func:`binomial_table`
+    """
+    n = len(k)
+    remaining = total
+    for j in range(n - 1):
+        parts = n - j - 2
+        v = 0
+        while rank >= binom[remaining - v + parts, parts]:
+            rank -= binom[remaining - v + parts, parts]
+            v += 1
+        k[j] = v
+        remaining -= v
+    k[n - 1] = remaining
+
+
+@jit(nopython=True, cache=True)
+def next_composition(k):  # pragma: no cover
+    r"""Advances a multi-index to the next one of the same total in lexicographic order.
+
+    Args:
+        k (array[int]): the multi-index, overwritten
+
+    Returns:
+        bool: ``False`` if ``k`` was the last multi-index of its total
+    """
+    n = len(k)
+    tail = 0
+    for j in range(n - 1, 0, -1):
+        tail += k[j]
+        if tail > 0:
+            k[j - 1] += 1
+            k[j:] = 0
+            k[n - 1] = tail - 1
+            return True
+    return False
+
+
+@jit(nopython=True, cache=True)
+def total_indices(num_modes, max_photons, binom):  # pragma: no cover
+    r"""Multi-indices of the packed layout, in the order they are stored.
+
+    Args:
+        num_modes (int): number of modes
+        max_photons (int): largest total photon number
+        binom (array[int]): binomial coefficients, as returned by :func:`binomial_table`
+
+    Returns:
+        array[int]: one multi-index per row
+    """
+    indices = np.zeros((layer_offset(max_photons + 1, num_modes, binom), num_modes), np.int64)
+    k = np.zeros(num_modes, dtype=np.int64)
+    f = 0
+    for total in range(max_photons + 1):
+        k[:] = 0
+        k[num_modes - 1] = total
+        indices[f] = k
+        f += 1
+        while next_composition(k):
+            indices[f] = k
+            f += 1
+    return indices
+
+
+class TotalCutoffTensor:
+    r"""Tensor over the multi-indices :math:`k=(k_0,\ldots,k_{n-1})` of total photon number
+    :math:`\sum_i k_i \leq N`, stored packed in a vector of :math:`\binom{N+n}{n}` entries
+    instead of the :math:`(N+1)^n` entries of a dense tensor.
+
+    The multi-indices are sorted by total photon number and then lexicographically, so that
+    the entries of every total are contiguous and the position of a multi-index is given by
+    the combinatorial number system.
+
+    Args:
+        values (array): the packed entries
+        num_modes (int): number of modes :math:`n`
+        max_photons (int): largest total photon number :math:`N`
+
+    Raises:
+        ValueError: if the number of entries does not match the number of multi-indices
+    """
+
+    def __init__(self, values, num_modes, max_photons):
+        self.num_modes = num_modes
+        self.max_photons = max_photons
+        self.binom = binomial_table(max_photons + num_modes + 1)
+        self.values = np.asarray(values)
+        if self.values.shape[0] != TotalCutoffTensor.size(num_modes, max_photons):
+            raise ValueError("The number of entries does not match the number of multi-indices.")
+
+    @staticmethod
+    def size(num_modes, max_photons):
+        r"""Number of multi-indices of ``num_modes`` modes with at most ``max_photons`` photons.
+
+        Args:
+            num_modes (int): number of modes
+            max_photons (int): largest total photon number
+
+        Returns:
+            int: :math:`\binom{N+n}{n}`
+        """
+        return int(binomial_table(max_photons + num_modes)[max_photons + num_modes, num_modes])
+
+    def index(self, k):
+        """Position of a multi-index in the packed entries.
+
+        Args:
+            k (tuple[int]): the multi-index
+
+        Returns:
+            int: the position
+
+        Raises:
+            IndexError: if the multi-index is not stored
+        """
+        k = np.asarray(k, dtype=np.int64)
+        if k.shape != (self.num_modes,) or k.min() < 0 or k.sum() > self.max_photons:
+            raise IndexError(f"The multi-index {tuple(k)} is not stored.")
+        return total_rank(k, self.binom)
+
+    def __getitem__(self, k):
+        return self.values[self.index(k)]
+
+    def multi_indices(self):
+        """Multi-indices of the packed entries, in the order they are stored.
+
+        Returns:
+            array[int]: one multi-index per row
+        """
+        return total_indices(self.num_modes, self.max_photons, self.binom)
+
+    def to_dense(self, cutoff=None):
+        """Dense tensor holding the packed entries, and zeros beyond the total cutoff.
+
+        Args:
+            cutoff (int): size of every dimension; defaults to ``max_photons + 1``
+
+        Returns:
+            array: the dense tensor
+        """
+        cutoff = self.max_photons + 1 if cutoff is None else cutoff
+        dense = np.zeros((cutoff,) * self.num_modes + self.values.shape[1:], self.values.dtype)
+        indices = self.multi_indices()
+        kept = np.all(indices < cutoff, axis=1)
+        dense[tuple(indices[kept].T)] = self.values[kept]
+        return dense
+
+    @classmethod
+    def from_dense(cls, dense, max_photons):
+        """Packs the entries of a dense tensor of total photon number at most ``max_photons``.
+
+        Args:
+            dense (array): the dense tensor, with one dimension per mode
+            max_photons (int): largest total photon number
+
+        Returns:
+            TotalCutoffTensor: the packed tensor, with zeros for the multi-indices beyond the
+            dense tensor
+        """
+        num_modes = dense.ndim
+        binom = binomial_table(max_photons + num_modes + 1)
+        indices = total_indices(num_modes, max_photons, binom)
+        kept = np.all(indices < np.array(dense.shape), axis=1)
+        values = np.zeros(len(indices), dtype=dense.dtype)
+        values[kept] = dense[tuple(indices[kept].T)]
+        return cls(values, num_modes, max_photons)
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def _hermite_total(R, y, G, max_photons, binom, renorm):  # pragma: no cover
+    r"""Numba-compiled function to fill the packed entries of a :class:`TotalCutoffTensor`
+    with the Hermite polynomials, by the recursion of :func:`_hermite_layers`. It expects an
+    array initialized with zeros everywhere except at index 0 (i.e. the seed value).
+
+    Args:
+        R (array[complex]): square matrix parametrizing the Hermite polynomial
+        y (vector[complex]): vector argument of the Hermite polynomial
+        G (array[complex]): packed entries to be filled with the Hermite polynomials
+        max_photons (int): largest total photon number
+        binom (array[int]): binomial coefficients, as returned by :func:`binomial_table`
+        renorm (bool): whether the polynomials are normalized by :math:`\sqrt{\prod_i k_i!}`
+
+    Returns:
+        array[complex]: the packed multidimensional Hermite polynomials
+    """
+    n = len(y)
+    for total in range(1, max_photons + 1):
+        lo = layer_offset(total, n, binom)
+        hi = layer_offset(total + 1, n, binom)
+        for t in prange((hi - lo + HERMITE_TILE - 1) // HERMITE_TILE):
+            first = lo + t * HERMITE_TILE
+            k = np.empty(n, dtype=np.int64)
+            total_unrank(total, first - lo, k, binom)
+            for f in range(first, min(first + HERMITE_TILE, hi)):
+                if f > first:
+                    next_composition(k)
+                i = 0
+                while k[i] == 0:
+                    i += 1
+                k[i] -= 1
+                u = y[i] * G[total_rank(k, binom)]
+                for l in range(n):
+                    if k[l] > 0:
+                        weight = SQRT[k[l]] if renorm else k[l]
+                        k[l] -= 1
+                        u -= weight * R[i, l] * G[total_rank(k, binom)]
+                        k[l] += 1
+                G[f] = u / SQRT[k[i] + 1] if renorm else u
+                k[i] += 1
+    return G
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def _grad_hermite_total(R, y, G, dG_dR, dG_dy, max_photons, binom, renorm):  # pragma: no cover
+    r"""Numba-compiled function to fill the gradients of the packed Hermite polynomials of
+    :func:`_hermite_total` with respect to :math:`R` and :math:`y`, by the recursion of
+    :func:`_grad_hermite_layers`.
+
+    Args:
+        R (array[complex]): square matrix parametrizing the Hermite polynomial
+        y (vector[complex]): vector argument of the Hermite polynomial
+        G (array[complex]): packed multidimensional Hermite polynomials
+        dG_dR (array[complex]): array of shape ``G.shape + R.shape`` to be filled
+        dG_dy (array[complex]): array of shape ``G.shape + y.shape`` to be filled
+        max_photons (int): largest total photon number
+        binom (array[int]): binomial coefficients, as returned by :func:`binomial_table`
+        renorm (bool): whether the polynomials are normalized by :math:`\sqrt{\prod_i k_i!}`
+
+    Returns:
+        dG_dR[complex], dG_dy[complex]: the gradients with respect to R and y
+    """
+    n = len(y)
+    for total in range(1, max_photons + 1):
+        lo = layer_offset(total, n, binom)
+        hi = layer_offset(total + 1, n, binom)
+        for t in prange((hi - lo + HERMITE_TILE - 1) // HERMITE_TILE):
+            first = lo + t * HERMITE_TILE
+            k = np.empty(n, dtype=np.int64)
+            total_unrank(total, first - lo, k, binom)
+            for f in range(first, min(first + HERMITE_TILE, hi)):
+                if f > first:
+                    next_composition(k)
+                i = 0
+                while k[i] == 0:
+                    i += 1
+                k[i] -= 1
+                ki = total_rank(k, binom)
+                for a in range(n):
+                    dG_dy[f, a] = y[i] * dG_dy[ki, a]
+                    for b in range(n):
+                        dG_dR[f, a, b] = y[i] * dG_dR[ki, a, b]
+                dG_dy[f, i] += G[ki]
+                for l in range(n):
+                    if k[l] > 0:
+                        weight = SQRT[k[l]] if renorm else k[l]
+                        k[l] -= 1
+                        kl = total_rank(k, binom)
+                        k[l] += 1
+                        for a in range(n):
+                            dG_dy[f, a] -= weight * R[i, l] * dG_dy[kl, a]
+                            for b in range(n):
+                                dG_dR[f, a, b] -= weight * R[i, l] * dG_dR[kl, a, b]
+                        dG_dR[f, i, l] -= weight * G[kl]
+                if renorm:
+                    norm = SQRT[k[i] + 1]
+                    for a in range(n):
+                        dG_dy[f, a] /= norm
+                        for b in range(n):
+                            dG_dR[f, a, b] /= norm
+                k[i] += 1
     return dG_dR, dG_dy
+
+
+def hermite_multidimensional_total(
+    R, max_photons, y=None, C=1, renorm=False, modified=False, rtol=1e-05, atol=1e-08
+):
+    r"""Returns the multidimensional Hermite polynomials of :func:`hermite_multidimensional`
+    for all the multi-indices of total photon number :math:`\sum_i k_i \leq N`, stored packed
+    in a :class:`TotalCutoffTensor`.
+
+    Only :math:`\binom{N+n}{n}` entries are computed, instead of the :math:`(N+1)^n` of a dense
+    tensor: at 10 modes and 9 photons, about 92 thousand entries instead of :math:`10^{10}`.
+
+    Args:
+        R (array): square matrix parametrizing the Hermite polynomial family
+        max_photons (int): largest total photon number :math:`N`
+        y (array): vector argument of the Hermite polynomial
+        C (complex): first value of the Hermite polynomials, the default value is 1
+        renorm (bool): If ``True``, normalizes the returned multidimensional Hermite
+            polynomials such that :math:`H_k^{(R)}(y)/\prod_i k_i!`
+        modified (bool): whether to return the modified multidimensional Hermite polynomials or the standard ones
+        rtol (float): the relative tolerance parameter used in ``np.allclose``
+        atol (float): the absolute tolerance parameter used in ``np.allclose``
+
+    Returns:
+        TotalCutoffTensor: the packed multidimensional Hermite polynomials
+    """
+    input_validation(R, atol=atol, rtol=rtol)
+    n, _ = R.shape
+    if y is None:
+        y = np.zeros([n], dtype=complex)
+    if y.shape[0] != n:
+        raise ValueError("The matrix R and vector y have incompatible dimensions")
+    if not modified:
+        y = R @ y
+
+    Rt = np.real_if_close(R)
+    yt = np.real_if_close(y)
+    dtype = np.find_common_type([Rt.dtype.name, yt.dtype.name], [np.array(C).dtype.name])
+    tensor = TotalCutoffTensor(
+        np.zeros(TotalCutoffTensor.size(n, max_photons), dtype=dtype), n, max_photons
+    )
+    tensor.values[0] = C
+    _hermite_total(Rt, yt, tensor.values, max_photons, tensor.binom, renorm)
+    return tensor
+
+
+def grad_hermite_multidimensional_total(G, R, y, C=1, renorm=True, dtype=None):
+    # pylint: disable=too-many-arguments
+    r"""Calculates the gradients of the packed multidimensional Hermite polynomials returned
+    by :func:`hermite_multidimensional_total` with ``modified=True``, with respect to
+    :math:`C`, :math:`y` and :math:`R`, as done by :func:`grad_hermite_multidimensional`.
+
+    Args:
+        G (TotalCutoffTensor): the packed multidimensional Hermite polynomials
+        R (array[complex]): square matrix parametrizing the Hermite polynomial
+        y (vector[complex]): vector argument of the Hermite polynomial
+        C (complex): first value of the Hermite polynomials
+        renorm (bool): If ``True``, uses the normalized multidimensional Hermite
+            polynomials such that :math:`H_k^{(R)}(y)/\prod_i k_i!`
+        dtype (data type): Specifies the data type used for the calculation
+
+    Returns:
+        TotalCutoffTensor, TotalCutoffTensor, TotalCutoffTensor: the packed gradients with
+        respect to C, R and y, the entries of the last two having shapes ``R.shape`` and
+        ``y.shape``
+    """
+    values = G.values
+    if dtype is None:
+        dtype = np.find_common_type(
+            [values.dtype.name, R.dtype.name, y.dtype.name], [np.array(C).dtype.name]
+        )
+    n, _ = R.shape
+    if y.shape[0] != n:
+        raise ValueError(
+            f"The matrix R and vector y have incompatible dimensions ({R.shape} vs {y.shape})"
+        )
+    dG_dC = np.array(values / C).astype(dtype)
+    dG_dR = np.zeros(values.shape + R.shape, dtype=dtype)
+    dG_dy = np.zeros(values.shape + y.shape, dtype=dtype)
+    _grad_hermite_total(R, y, values, dG_dR, dG_dy, G.max_photons, G.binom, renorm)
+    return tuple(TotalCutoffTensor(d, n, G.max_photons) for d in (dG_dC, dG_dR, dG_dy))
@@ -17,10 +17,19 @@ Algorithms for hafnians of low-rank matrices.
 
 from functools import lru_cache
 from itertools import product
+import numba
 import numpy as np
-from sympy import symbols, expand
 from scipy.special import factorial2
 
+from ._hermite_multidimensional import (
+    binomial_table,
+    layer_offset,
+    next_composition,
+    total_rank,
+    total_unrank,
+)
+from ._summation import num_chunks, chunk_range, compensated_add, tree_sum
+
 
 @lru_cache(maxsize=1000000)
 def partitions(r, n):
@@ -47,6 +56,91 @@ def partitions(r, n):
     return new_combos
 
 
+@numba.jit(nopython=True, parallel=True, cache=True)
+def _expand_linear_forms(G, binom):  # pragma: no cover
+    r"""Coefficients of the polynomial :math:`\prod_k \sum_j G_{kj} x_j`, obtained by
+    multiplying the linear forms one at a time.
+
+    The coefficients of each degree are stored in the lexicographic order of the exponents of
+    their monomials, and those of the next degree are gathered from them in parallel, over
+    chunks of monomials found by unranking their first exponents.
+
+    Args:
+        G (array[complex]): coefficients of the linear forms, one per row
+        binom (array[int]): binomial coefficients, as returned by
+            :func:`~thewalrus._hermite_multidimensional.binomial_table`
+
+    Returns:
+        array[complex]: coefficients of the monomials of degree ``len(G)``
+    """
+    n, r = G.shape
+    coeffs = np.ones(1, dtype=np.complex128)
+    for d in range(n):
+        offset = layer_offset(d, r, binom)
+        size = binom[d + r, r - 1]
+        new = np.empty(size, dtype=np.complex128)
+        chunks = num_chunks(size)
+        # pylint: disable=not-an-iterable
+        for c in numba.prange(chunks):
+            start, stop = chunk_range(c, chunks, size)
+            m = np.zeros(r, dtype=np.int64)
+            total_unrank(d + 1, start, m, binom)
+            for pos in range(start, stop):
+                val = 0j
+                for j in range(r):
+                    if m[j] > 0:
+                        m[j] -= 1
+                        val += G[d, j] * coeffs[total_rank(m, binom) - offset]
+                        m[j] += 1
+                new[pos] = val
+                next_composition(m)
+        coeffs = new
+    return coeffs
+
+
+@numba.jit(nopython=True, parallel=True, cache=True)
+def _low_rank_haf(G, binom):  # pragma: no cover
+    r"""Hafnian of :math:`\bm{G} \bm{G}^T`, as the sum over the r-partitions :math:`p` of
+    :math:`n/2` of the coefficients of the monomials :math:`\prod_i x_i^{2 p_i}` weighted by
+    :math:`\prod_i (2 p_i - 1)!!`.
+
+    Args:
+        G (array[complex]): factorization of the low rank matrix, with an even number of rows
+        binom (array[int]): binomial coefficients, as returned by
+            :func:`~thewalrus._hermite_multidimensional.binomial_table`
+
+    Returns:
+        complex: the hafnian
+    """
+    n, r = G.shape
+    half = n // 2
+    coeffs = _expand_linear_forms(G, binom)
+    offset = layer_offset(n, r, binom)
+
+    double_factorials = np.ones(half + 1, dtype=np.float64)
+    for p in range(2, half + 1):
+        double_factorials[p] = double_factorials[p - 1] * (2 * p - 1)
+
+    size = binom[half + r - 1, r - 1]
+    chunks = num_chunks(size)
+    partials = np.zeros(chunks, dtype=np.complex128)
+    # pylint: disable=not-an-iterable
+    for c in numba.prange(chunks):
+        start, stop = chunk_range(c, chunks, size)
+        p = np.zeros(r, dtype=np.int64)
+        total_unrank(half, start, p, binom)
+        total, comp = 0j, 0j
+        for _ in range(start, stop):
+            weight = 1.0
+            for i in range(r):
+                weight *= double_factorials[p[i]]
+            term = coeffs[total_rank(2 * p, binom) - offset] * weight
+            total, comp = compensated_add(total, comp, term)
+            next_composition(p)
+        partials[c] = total + comp
+    return tree_sum(partials)
+
+
 def low_rank_hafnian(G):
     r"""Returns the hafnian of the low rank matrix :math:`\bm{A} = \bm{G} \bm{G}^T` where :math:`\bm{G}` is rectangular of size
     :math:`n \times r`  with :math:`r \leq n`.
@@ -55,7 +149,8 @@ def low_rank_hafnian(G):
 
     The hafnian is calculated using the algorithm described in Appendix C of
     *A faster hafnian formula for complex matrices and its benchmarking on a supercomputer*,
-    :cite:`bjorklund2018faster`.
+    :cite:`bjorklund2018faster`. The polynomial it expands and the sum over the r-partitions of
+    :math:`n/2` are both evaluated by compiled, parallel loops.
 
     Args:
         G (array): factorization of the low rank matrix A = G @ G.T.
@@ -68,21 +163,4 @@ def low_rank_hafnian(G):
         return 0
     if r == 1:
         return factorial2(n - 1) * np.prod(G)
-    poly = 1
-    x = symbols("x0:" + str(r))
-    for k in range(n):
-        term = 0
-        for j in range(r):
-            term += G[k, j] * x[j]
-        poly = expand(poly * term)
-
-    comb = partitions(r, n // 2)
-    haf_val = 0.0
-    for c in comb:
-        monomial = 1
-        facts = 1
-        for i, pi in enumerate(c):
-            monomial *= x[i] ** (2 * pi)
-            facts = facts * factorial2(2 * pi - 1)
-        haf_val += complex(poly.coeff(monomial) * facts)
-    return haf_val
+    return complex(_low_rank_haf(G.astype(np.complex128), binomial_table(n + r)))
@@ -28,12 +28,38 @@ from numba import jit, prange
 
 from scipy.special import factorial
 
-from ._hafnian import hafnian_repeated, find_kept_edges
-
-
-def perm(A, method="bbfg"):
+from ._hafnian import (
+    hafnian_repeated,
+    find_kept_edges,
+    gray_code_start,
+    gray_code_next,
+    precompute_binoms,
+    repeated_hafnian_costs,
+    report_dispatch,
+    kernel_dtype,
+)
+from ._summation import SUM_CHUNKS, num_chunks, chunk_range, two_sum, compensated_add, tree_sum
+from .instrumentation import instrumented
+
+# matrix size above which ``perm`` keeps the running row sums in extended precision by default
+EXTENDED_PRECISION_SIZE = 30
+
+
+def _perm_steps(A, method="bbfg", extended=None):  # pylint: disable=unused-argument
+    """Number of terms of the Gray code sum evaluated by :func:`perm`, recorded by the
+    instrumentation."""
+    if len(A) <= 3:
+        return 0
+    return 2 ** (len(A) - int(method == "bbfg"))
+
+
+@instrumented("perm", steps=_perm_steps)
+def perm(A, method="bbfg", extended=None):
     """Returns the permanent of a matrix using various methods.
 
+    Matrices larger than three by three are cast to ``float64`` or ``complex128`` and
+    passed to a parallel kernel that visits the terms of the formula in Gray code order. The
+    permanent of an integer matrix is rounded back to the integer type of the matrix.
 
     Args:
         A (array[float or complex]): a square array.
@@ -43,9 +69,11 @@ def perm(A, method="bbfg"):
             or ``"bbfg"`` to use the
             `BBFG formula
             <https://en.wikipedia.org/wiki/Computing_the_permanent#Balasubramanian%E2%80%93Bax%E2%80%93Franklin%E2%80%93Glynn_formula>`_.
+        extended (bool): whether to keep the running row sums in extended (double-double)
+            precision; by default only for matrices larger than ``EXTENDED_PRECISION_SIZE``
 
     Returns:
-        float or complex: the permanent of matrix ``A``
+        int or float or complex: the permanent of matrix ``A``
     """
 
     if not isinstance(A, np.ndarray):
@@ -80,10 +108,24 @@ def perm(A, method="bbfg"):
 
     isRyser = bool(method != "bbfg")
 
-    return perm_ryser(A) if isRyser else perm_bbfg(A)
+    if extended is None:
+        extended = bool(matshape[0] > EXTENDED_PRECISION_SIZE)
+
+    dtype = A.dtype
+    A = A.astype(np.complex128) if np.iscomplexobj(A) else A.astype(np.float64)
+
+    if isRyser:
+        p = perm_ryser_gray(A, extended=extended)
+    else:
+        p = perm_bbfg_gray(A, extended=extended)
 
+    if np.issubdtype(dtype, np.integer):
+        # the permanent of an integer matrix is an integer
+        return dtype.type(np.rint(p))
+    return p
 
-@jit(nopython=True)
+
+@jit(nopython=True, cache=True)
 def perm_ryser(M):  # pragma: no cover
     """
     Returns the permanent of a matrix using the Ryser formula in Gray ordering.
@@ -127,7 +169,7 @@ def perm_ryser(M):  # pragma: no cover
     return total
 
 
-@jit(nopython=True)
+@jit(nopython=True, cache=True)
 def perm_bbfg(M):  # pragma: no cover
     """
     Returns the permanent of a matrix using the bbfg formula in Gray ordering
@@ -168,6 +210,270 @@ def perm_bbfg(M):  # pragma: no cover
     return total / num_loops
 
 
+@jit(nopython=True, cache=True)
+def update_row_sums(rows, rows_err, weight, row, extended):  # pragma: no cover
+    """Adds in place ``weight * row`` to the running row sums ``rows``. In extended
+    precision the rounding errors of the updates are accumulated in ``rows_err``, so that
+    ``rows + rows_err`` does not drift along a long Gray code sequence.
+
+    Args:
+        rows (array): running row sums
+        rows_err (array): accumulated rounding errors of the running row sums
+        weight (int): multiple of ``row`` to add
+        row (array): matrix row
+        extended (bool): whether to track the rounding errors
+    """
+    if extended:
+        for k in range(len(rows)):
+            rows[k], err = two_sum(rows[k], weight * row[k])
+            rows_err[k] += err
+    else:
+        for k in range(len(rows)):
+            rows[k] += weight * row[k]
+
+
+@jit(nopython=True, cache=True)
+def row_sums_product(rows, rows_err, extended):  # pragma: no cover
+    """Product of the entries of the running row sums.
+
+    Args:
+        rows (array): running row sums
+        rows_err (array): accumulated rounding errors of the running row sums
+        extended (bool): whether to include the rounding errors
+
+    Returns:
+        float or complex: the product of the row sums
+    """
+    if extended:
+        return np.prod(rows + rows_err)
+    return np.prod(rows)
+
+
+@jit(nopython=True, parallel=True, cache=True)
+def perm_ryser_gray(M, n_chunks=SUM_CHUNKS, extended=False):  # pragma: no cover
+    """Returns the permanent of a matrix using the Ryser formula, with the row subsets
+    visited in Gray code order by parallel segments.
+
+    Each of the ``n_chunks`` contiguous segments of the Gray code sequence computes its
+    initial row sums explicitly and then updates them with a single row per term. The
+    segments are summed with compensated summation and combined in a fixed order, so the
+    result does not depend on the number of threads. Numba compiles one specialisation
+    per dtype; :func:`perm` only uses ``float64`` and ``complex128``.
+
+    Args:
+        M (array): a square array
+        n_chunks (int): number of segments the Gray code sequence is split into
+        extended (bool): whether to keep the row sums in extended precision
+
+    Returns:
+        float or complex: the permanent of matrix ``M``
+    """
+    n = len(M)
+    if n == 0:
+        return M.dtype.type(1.0)
+    bases = 2 * np.ones(n, dtype=np.int64)
+    steps = 2**n
+    n_chunks = num_chunks(steps, n_chunks)
+    partials = np.zeros(n_chunks, dtype=M.dtype)
+    for c in prange(n_chunks):
+        start, stop = chunk_range(c, n_chunks, steps)
+        digits, gray, direction = gray_code_start(start, bases)
+        rows = np.zeros(n, dtype=M.dtype)
+        rows_err = np.zeros(n, dtype=M.dtype)
+        for i in range(n):
+            if gray[i] == 1:
+                update_row_sums(rows, rows_err, 1, M[i], extended)
+        # sign of the term is (-1)^(n - |S|)
+        sign = 1 - 2 * ((n - gray.sum()) % 2)
+        total, comp = M.dtype.type(0), M.dtype.type(0)
+        for j in range(start, stop):
+            if j > start:
+                i = gray_code_next(digits, gray, direction, bases)
+                update_row_sums(rows, rows_err, direction[i], M[i], extended)
+                sign = -sign
+            total, comp = compensated_add(
+                total, comp, sign * row_sums_product(rows, rows_err, extended)
+            )
+        partials[c] = total + comp
+    return tree_sum(partials)
+
+
+@jit(nopython=True, parallel=True, cache=True)
+def perm_bbfg_gray(M, n_chunks=SUM_CHUNKS, extended=False):  # pragma: no cover
+    """Returns the permanent of a matrix using the bbfg formula, with the sign vectors
+    visited in Gray code order by parallel segments.
+
+    The sequence is split and summed as in :func:`perm_ryser_gray`. The sign attached to
+    the last row is fixed to ``+1``.
+
+    Args:
+        M (array): a square array
+        n_chunks (int): number of segments the Gray code sequence is split into
+        extended (bool): whether to keep the row sums in extended precision
+
+    Returns:
+        float or complex: the permanent of matrix ``M``
+    """
+    n = len(M)
+    if n == 0:
+        return M.dtype.type(1.0)
+    bases = 2 * np.ones(n - 1, dtype=np.int64)
+    steps = 2 ** (n - 1)
+    n_chunks = num_chunks(steps, n_chunks)
+    partials = np.zeros(n_chunks, dtype=M.dtype)
+    for c in prange(n_chunks):
+        start, stop = chunk_range(c, n_chunks, steps)
+        digits, gray, direction = gray_code_start(start, bases)
+        rows = np.zeros(n, dtype=M.dtype)
+        rows_err = np.zeros(n, dtype=M.dtype)
+        update_row_sums(rows, rows_err, 1, M[n - 1], extended)
+        for i in range(n - 1):
+            update_row_sums(rows, rows_err, 1 - 2 * gray[i], M[i], extended)
+        # the sign of the term is the product of the signs of the rows
+        sign = 1 - 2 * (gray.sum() % 2)
+        total, comp = M.dtype.type(0), M.dtype.type(0)
+        for j in range(start, stop):
+            if j > start:
+                i = gray_code_next(digits, gray, direction, bases)
+                update_row_sums(rows, rows_err, -2 * direction[i], M[i], extended)
+                sign = -sign
+            total, comp = compensated_add(
+                total, comp, sign * row_sums_product(rows, rows_err, extended)
+            )
+        partials[c] = total + comp
+    return tree_sum(partials) / steps
+
+
+@jit(nopython=True, cache=True)
+def repeated_glynn_steps(row_reps):  # pragma: no cover
+    """Number of terms summed by :func:`perm_repeated_glynn` for the given row repetitions.
+
+    Args:
+        row_reps (array): positive repetitions of the rows
+
+    Returns:
+        int: number of Gray code steps
+    """
+    if len(row_reps) == 0:
+        return 1
+    steps = row_reps[0] // 2 + 1
+    for r in row_reps[1:]:
+        steps *= r + 1
+    return steps
+
+
+@jit(nopython=True, cache=True)
+def perm_repeated_glynn(B, row_reps, col_reps, binoms, rowsums):  # pragma: no cover
+    """Returns the permanent of the matrix obtained by repeating row ``i`` of ``B``
+    ``row_reps[i]`` times and column ``j`` of ``B`` ``col_reps[j]`` times.
+
+    The sign vectors of the Glynn formula are grouped by the number of minus signs
+    assigned to each set of repeated rows, so that the sum runs over the mixed-radix
+    Gray code with digits ``0, ..., row_reps[i]`` (the first digit halved using the
+    symmetry of the formula) instead of over ``2**(sum(row_reps) - 1)`` terms.
+
+    Args:
+        B (array): matrix of size [k, l] without repetitions
+        row_reps (array): positive repetitions of the rows of ``B``
+        col_reps (array): positive repetitions of the columns of ``B``, summing to the same
+            value as ``row_reps``
+        binoms (array): table of binomial coefficients up to ``max(row_reps)``
+        rowsums (array): length-``l`` buffer for the running row sums, of the type of ``B``
+
+    Returns:
+        float or complex: the permanent of the repeated matrix
+    """
+    k, l = B.shape
+    if k == 0:
+        return rowsums[:0].sum() + 1
+    n_rows = row_reps.sum()
+    bases = row_reps + 1
+    bases[0] = row_reps[0] // 2 + 1
+    steps = np.prod(bases)
+    digits, gray, direction = gray_code_start(0, bases)
+    for j in range(l):
+        rowsums[j] = 0
+        for i in range(k):
+            rowsums[j] += row_reps[i] * B[i, j]
+    sign = 1
+    zero = rowsums[0] * 0
+    total, comp = zero, zero
+    for t in range(steps):
+        if t > 0:
+            i = gray_code_next(digits, gray, direction, bases)
+            for j in range(l):
+                rowsums[j] -= 2 * direction[i] * B[i, j]
+            sign = -sign
+        # the sign vectors with gray[0] minus signs on the first rows and those with
+        # row_reps[0] - gray[0] give the same term
+        coeff = 1.0 if 2 * gray[0] == row_reps[0] else 2.0
+        for i in range(k):
+            coeff *= binoms[row_reps[i], gray[i]]
+        term = sign * coeff + zero
+        for j in range(l):
+            term *= rowsums[j] ** col_reps[j]
+        total, comp = compensated_add(total, comp, term)
+    return (total + comp) / 2**n_rows
+
+
+@jit(nopython=True, parallel=True, cache=True)
+def fock_prob_batch_kernel(n, patterns, U, n_chunks=SUM_CHUNKS):  # pragma: no cover
+    """Compiled kernel of :func:`fock_prob_batch`.
+
+    The patterns are split into ``n_chunks`` contiguous blocks processed in parallel; each
+    block gathers its submatrices into buffers allocated once per block. For each pattern
+    the repeated side with the fewest Gray code steps is summed over.
+
+    Args:
+        n (array): length-M input Fock state
+        patterns (array): [S, M] output Fock states, each with ``n.sum()`` photons
+        U (array): M x M complex matrix describing the linear optical transformation
+        n_chunks (int): number of blocks the patterns are split into
+
+    Returns:
+        array: the S output probabilities
+    """
+    S, M = patterns.shape
+    N = n.sum()
+    binoms = precompute_binoms(max(N, 1))
+    facts = np.ones(N + 1)
+    for i in range(1, N + 1):
+        facts[i] = facts[i - 1] * i
+    in_modes = np.where(n > 0)[0]
+    in_reps = n[in_modes]
+    in_fac = 1.0
+    for r in in_reps:
+        in_fac *= facts[r]
+    in_steps = repeated_glynn_steps(in_reps)
+
+    probs = np.zeros(S)
+    n_chunks = num_chunks(S, n_chunks)
+    for c in prange(n_chunks):
+        start, stop = chunk_range(c, n_chunks, S)
+        B = np.zeros((M, M), dtype=np.complex128)
+        rowsums = np.zeros(M, dtype=np.complex128)
+        for s in range(start, stop):
+            out_modes = np.where(patterns[s] > 0)[0]
+            out_reps = patterns[s][out_modes]
+            out_fac = 1.0
+            for r in out_reps:
+                out_fac *= facts[r]
+            out_steps = repeated_glynn_steps(out_reps)
+            k, l = len(out_modes), len(in_modes)
+            if out_steps <= in_steps:
+                for i in range(k):
+                    for j in range(l):
+                        B[i, j] = U[out_modes[i], in_modes[j]]
+                p = perm_repeated_glynn(B[:k, :l], out_reps, in_reps, binoms, rowsums)
+            else:
+                for i in range(l):
+                    for j in range(k):
+                        B[i, j] = U[out_modes[j], in_modes[i]]
+                p = perm_repeated_glynn(B[:l, :k], in_reps, out_reps, binoms, rowsums)
+            probs[s] = abs(p) ** 2 / (in_fac * out_fac)
+    return probs
+
+
 def permanent_repeated(A, rpt):
     r"""Calculates the permanent of matrix :math:`A`, where the ith row/column
     of :math:`A` is repeated :math:`rpt_i` times.
@@ -180,6 +486,11 @@ def permanent_repeated(A, rpt):
 
     >>> hafnian_repeated(B, rpt*2, loop=False)
 
+    unless summing the Glynn formula directly over the repetitions, with
+    :func:`perm_repeated_glynn`, is estimated to be cheaper. If no row is repeated more than
+    once, the permanent of the submatrix of the selected rows is computed with :func:`perm`.
+    The pick is reported to the hook set by :func:`~thewalrus._hafnian.set_dispatch_hook`.
+
     Args:
         A (array): matrix of size [N, N]
         rpt (Sequence): sequence of N positive integers indicating the corresponding rows/columns
@@ -189,14 +500,43 @@ def permanent_repeated(A, rpt):
         int or float or complex: the permanent of matrix ``A``
     """
     n = A.shape[0]
+    rpt2 = np.concatenate((rpt, rpt))
+
+    reps = np.asarray(rpt)
+    nonzero = np.nonzero(reps)[0]
+    if len(reps) == n and np.all(np.mod(reps, 1) == 0) and np.all(reps >= 0) and len(nonzero):
+        reps = reps[nonzero].astype(np.int64)
+        # a Glynn step is costed as the square of the size of the matrix, as a step of the
+        # hafnian strategies is costed as the cube of the size of its matrix
+        glynn_cost = int(repeated_glynn_steps(reps)) * len(reps) ** 2
+        if reps.max() == 1:
+            # no row is repeated: the permanent of the submatrix is already the Glynn sum
+            report_dispatch("permanent_repeated", "permanent", {"permanent": glynn_cost})
+            return perm(A[np.ix_(nonzero, nonzero)])
+        costs = {
+            "hafnian": min(repeated_hafnian_costs(rpt2.astype(np.int64)).values()),
+            "glynn": glynn_cost,
+        }
+        strategy = min(costs, key=costs.get)
+        report_dispatch("permanent_repeated", strategy, costs)
+        if strategy == "glynn":
+            dtype = kernel_dtype(A)
+            return perm_repeated_glynn(
+                A[np.ix_(nonzero, nonzero)].astype(dtype),
+                reps,
+                reps,
+                precompute_binoms(int(reps.max())),
+                np.zeros(len(reps), dtype=dtype),
+            )
+
     O = np.zeros([n, n])
     B = np.vstack([np.hstack([O, A]), np.hstack([A.T, O])])
 
-    return hafnian_repeated(B, rpt * 2, loop=False)
+    return hafnian_repeated(B, rpt2, loop=False)
 
 
-@jit(nopython=True, parallel=True)
-def brs(A, E):  # pragma: no cover
+@jit(nopython=True, parallel=True, cache=True)
+def brs(A, E, n_chunks=SUM_CHUNKS, step_start=0, step_stop=-1):  # pragma: no cover
     r"""
     Calculates the Bristolian, a matrix function introduced for calculating the threshold detector
     statistics on measurements of Fock states interfering in linear optical interferometers.
@@ -206,25 +546,40 @@ def brs(A, E):  # pragma: no cover
     Args:
         A (array): matrix of size [m, n]
         E (array): matrix of size [r, n]
+        n_chunks (int): number of blocks the sum over row subsets is split into; the result
+            does not depend on the number of threads
+        step_start (int): index of the first of the ``2**m`` row subsets summed
+        step_stop (int): one past the index of the last row subset summed; negative for all
+            the subsets after ``step_start``
 
     Returns:
-        int or float or complex: the Bristol of matrices A and E
+        float or complex: the Bristol of matrices A and E, real if the matrices are real
     """
     m = A.shape[0]
 
     steps = 2**m
     ones = np.ones(m, dtype=np.int8)
-    total = 0
-    for j in prange(steps):
-        kept_rows = np.where(find_kept_edges(j, ones) != 0)[0]
-        Ay = A[kept_rows, :]
-        plusminus = (-1) ** ((m - len(kept_rows)) % 2)
-        total += plusminus * perm_bbfg(Ay.conj().T @ Ay + E)
-    return total
-
-
-@jit(nopython=True, parallel=True)
-def ubrs(A):  # pragma: no cover
+    if step_stop < 0 or step_stop > steps:
+        step_stop = steps
+    step_start = min(step_start, step_stop)
+
+    n_chunks = num_chunks(step_stop - step_start, n_chunks)
+    partials = np.zeros(n_chunks, dtype=(A[:1, :1] + E[:1, :1]).dtype)
+    for c in prange(n_chunks):
+        start, stop = chunk_range(c, n_chunks, step_stop - step_start)
+        start, stop = start + step_start, stop + step_start
+        total, comp = partials[c], partials[c]
+        for j in range(start, stop):
+            kept_rows = np.where(find_kept_edges(j, ones) != 0)[0]
+            Ay = A[kept_rows, :]
+            plusminus = (-1) ** ((m - len(kept_rows)) % 2)
+            total, comp = compensated_add(total, comp, plusminus * perm_bbfg(Ay.conj().T @ Ay + E))
+        partials[c] = total + comp
+    return tree_sum(partials)
+
+
+@jit(nopython=True, parallel=True, cache=True)
+def ubrs(A, n_chunks=SUM_CHUNKS, step_start=0, step_stop=-1):  # pragma: no cover
     r"""
     Calculates the Unitary Bristolian, a matrix function introduced for calculating the threshold detector
     statistics on measurements of Fock states interfering in lossless linear optical interferometers.
@@ -233,20 +588,36 @@ def ubrs(A):  # pragma: no cover
 
     Args:
         A (array): matrix of size [m, n]
+        n_chunks (int): number of blocks the sum over row subsets is split into; the result
+            does not depend on the number of threads
+        step_start (int): index of the first of the ``2**m - 1`` non-empty row subsets summed
+        step_stop (int): one past the index of the last row subset summed; negative for all
+            the subsets after ``step_start``
 
     Returns:
-        int or float or complex: the Unitary Bristol of matrix A
+        float or complex: the Unitary Bristol of matrix A, real if the matrices are real
     """
     m = A.shape[0]
-    steps = 2**m
+    # the empty subset does not contribute
+    steps = 2**m - 1
     ones = np.ones(m, dtype=np.int8)
-    total = 0
-    for j in prange(1, steps):
-        kept_rows = np.where(find_kept_edges(j, ones) != 0)[0]
-        Az = A[kept_rows, :]
-        plusminus = (-1) ** ((m - len(kept_rows)) % 2)
-        total += plusminus * perm_bbfg(Az.conj().T @ Az)
-    return total
+    if step_stop < 0 or step_stop > steps:
+        step_stop = steps
+    step_start = min(step_start, step_stop)
+
+    n_chunks = num_chunks(step_stop - step_start, n_chunks)
+    partials = np.zeros(n_chunks, dtype=A.dtype)
+    for c in prange(n_chunks):
+        start, stop = chunk_range(c, n_chunks, step_stop - step_start)
+        start, stop = start + step_start, stop + step_start
+        total, comp = partials[c], partials[c]
+        for j in range(start + 1, stop + 1):
+            kept_rows = np.where(find_kept_edges(j, ones) != 0)[0]
+            Az = A[kept_rows, :]
+            plusminus = (-1) ** ((m - len(kept_rows)) % 2)
+            total, comp = compensated_add(total, comp, plusminus * perm_bbfg(Az.conj().T @ Az))
+        partials[c] = total + comp
+    return tree_sum(partials)
 
 
 def fock_prob(n, m, U):
@@ -279,6 +650,36 @@ def fock_prob(n, m, U):
     )
 
 
+def fock_prob_batch(n, patterns, U):
+    r"""
+    Calculates the probabilities of an input Fock state, n, scattering to each of a batch of output
+    Fock states through an interferometer described by matrix U.
+
+    All the submatrices are gathered and their permanents computed in a single parallel compiled
+    kernel. Repeated input or output modes are handled without expanding the submatrix, summing
+    over the number of photons in each mode as in :func:`permanent_repeated`.
+
+    Args:
+        n (sequence[int]): length-M list giving the input Fock state occupancy of each mode
+        patterns (array[int]): S x M array whose rows are the output Fock state occupancies
+        U (array): M x M matrix describing the a linear optical transformation
+
+    Returns:
+        array[float]: the S probabilities of Fock state, n, scattering to each of the patterns
+    """
+    n = np.asarray(n, dtype=np.int64)
+    patterns = np.asarray(patterns, dtype=np.int64)
+
+    if patterns.ndim != 2 or patterns.shape[1] != len(n):
+        raise ValueError("patterns must be a 2d array with one column per mode")
+    if U.shape != (len(n), len(n)):
+        raise ValueError("U must be a square matrix with one row per mode")
+    if np.any(patterns.sum(axis=1) != n.sum()):
+        raise ValueError("number of input photons must equal number of output photons")
+
+    return fock_prob_batch_kernel(n, patterns, np.asarray(U, dtype=np.complex128))
+
+
 def fock_threshold_prob(n, d, T):
     r"""
     Calculates the probability of a an M_in mode input Fock state, n, scattering through an interferometer described by
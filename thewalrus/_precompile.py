@@ -0,0 +1,173 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""
+Compilation of the kernels ahead of their first use
+===================================================
+
+The Numba kernels of The Walrus are compiled with ``cache=True``, so that the machine code of
+every signature they are compiled for is written to the Numba cache, in the ``__pycache__``
+folders of the package or in the directory given by the ``NUMBA_CACHE_DIR`` environment
+variable, and loaded from it by the processes started later instead of being compiled again.
+
+:func:`precompile` fills this cache for the common types of the inputs, by calling the public
+functions on small inputs of each type and by compiling explicit signatures. Running it once,
+for instance when building the image of a worker with ``make precompile``, spares every
+worker the compilation of the kernels it uses:
+
+.. code-block:: console
+
+    $ NUMBA_CACHE_DIR=/opt/numba-cache python -c "import thewalrus; thewalrus.precompile()"
+
+Summary
+-------
+
+.. autosummary::
+    precompile
+
+Code details
+------------
+"""
+import importlib
+import time
+
+import numpy as np
+
+
+def _symmetric(n, dtype):
+    """Symmetric matrix of small entries, the same for every call."""
+    A = 0.1 * np.cos(np.arange(n * n).reshape(n, n) + 1.0)
+    if np.dtype(dtype).kind == "c":
+        A = A + 0.1j * np.sin(np.arange(n * n).reshape(n, n) + 2.0)
+    return (A + A.T).astype(dtype)
+
+
+def _hafnian(dtype):
+    """Compiles the hafnian and loop hafnian kernels."""
+    from ._hafnian import hafnian, hafnian_repeated  # pylint: disable=import-outside-toplevel
+
+    A = _symmetric(6, dtype)
+    for method in ("glynn", "inclexcl", "recursive"):
+        hafnian(A, method=method)
+    hafnian(A, loop=True)
+    hafnian_repeated(A[:3, :3], [2, 1, 1])
+    hafnian_repeated(A[:3, :3], [2, 1, 1], mu=A.diagonal().copy(), loop=True)
+
+
+def _permanent(dtype):
+    """Compiles the permanent kernels."""
+    from ._permanent import perm  # pylint: disable=import-outside-toplevel
+
+    A = _symmetric(4, dtype)
+    for method in ("ryser", "bbfg"):
+        perm(A, method=method)
+
+
+def _torontonian(dtype):
+    """Compiles the Torontonian kernels."""
+    from ._torontonian import tor, ltor  # pylint: disable=import-outside-toplevel
+
+    O = _symmetric(4, dtype)
+    gamma = O.diagonal().copy()
+    for recursive in (True, False):
+        tor(O, recursive=recursive)
+        ltor(O, gamma, recursive=recursive)
+
+
+def _hermite(dtype):
+    """Compiles the multidimensional Hermite polynomial kernels."""
+    # pylint: disable=import-outside-toplevel
+    from ._hermite_multidimensional import hermite_multidimensional
+
+    R = _symmetric(2, dtype)
+    hermite_multidimensional(R, 3)
+    hermite_multidimensional(R, 3, renorm=True)
+
+
+def _fock_gradients(dtype):
+    """Compiles the gates of :mod:`thewalrus.fock_gradients`, their gradients and their
+    batched versions, which only support complex gates."""
+    from . import fock_gradients  # pylint: disable=import-outside-toplevel
+
+    if np.dtype(dtype).kind != "c":
+        return
+    params = np.array([0.1, 0.2])
+    for name in ("displacement", "squeezing", "two_mode_squeezing", "beamsplitter", "mzgate"):
+        T = getattr(fock_gradients, name)(0.1, 0.2, 3)
+        getattr(fock_gradients, "grad_" + name)(T, 0.1, 0.2)
+        batch = getattr(fock_gradients, name + "_batch")(
+            params, params, np.zeros((2,) + T.shape, dtype=dtype)
+        )
+        getattr(fock_gradients, "grad_" + name + "_batch")(
+            batch, params, params, np.zeros_like(batch), np.zeros_like(batch)
+        )
+
+
+def _grouped_clicks(dtype):
+    """Compiles the Monte Carlo estimation of the grouped click probabilities."""
+    # pylint: disable=import-outside-toplevel
+    from .grouped_click_probabilities import grouped_click_probabilities_squeezed
+
+    grouped_click_probabilities_squeezed(np.full(2, 0.1), 0.5 * np.eye(2, dtype=dtype), 4, 2)
+
+
+# functions compiling the kernels of each group for a given type of inputs
+KERNELS = {
+    "hafnian": _hafnian,
+    "permanent": _permanent,
+    "torontonian": _torontonian,
+    "hermite": _hermite,
+    "fock_gradients": _fock_gradients,
+    "grouped_click_probabilities": _grouped_clicks,
+}
+
+
+def precompile(kernels=None, dtypes=(np.float64, np.complex128), signatures=None):
+    """Compiles the Numba kernels ahead of their first use, writing them to the Numba cache.
+
+    Args:
+        kernels (list[str]): groups of kernels among ``"hafnian"``, ``"permanent"``,
+            ``"torontonian"``, ``"hermite"``, ``"fock_gradients"`` and
+            ``"grouped_click_probabilities"``; all of them by default
+        dtypes (tuple[type]): types of the inputs the kernels are compiled for
+        signatures (dict[str, list]): additional Numba signatures, such as the types
+            ``"(complex128[:, :],)"`` of the arguments, compiled for the kernels of the given
+            qualified names, such as ``"thewalrus._torontonian.rec_torontonian"``
+
+    Returns:
+        dict[str, float]: time in seconds spent on each group and on each explicit kernel,
+        which is small for those already in the cache
+
+    Raises:
+        ValueError: if a group of kernels does not exist
+    """
+    kernels = list(KERNELS) if kernels is None else kernels
+    unknown = set(kernels) - set(KERNELS)
+    if unknown:
+        raise ValueError(f"Unknown kernels {sorted(unknown)}; the kernels are {list(KERNELS)}.")
+
+    times = {}
+    for name in kernels:
+        start = time.perf_counter()
+        for dtype in dtypes:
+            KERNELS[name](dtype)
+        times[name] = time.perf_counter() - start
+
+    for path, sigs in (signatures or {}).items():
+        module, _, attr = path.rpartition(".")
+        dispatcher = getattr(importlib.import_module(module), attr)
+        start = time.perf_counter()
+        for sig in sigs:
+            dispatcher.compile(sig)
+        times[path] = time.perf_counter() - start
+    return times
@@ -0,0 +1,188 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""
+Process pool of the parallel samplers
+=====================================
+
+A persistent pool of worker processes, used by the samplers of :mod:`thewalrus.samples` when
+``parallel=True``.
+
+The arrays describing the state being sampled and the preallocated output array are copied
+once into a single memory-mapped block, backed by ``/dev/shm`` when available, which every
+worker maps instead of receiving its own copy. The samples are split into chunks of a fixed
+size, and every sample draws its random numbers from its own counter-based stream, given by
+:func:`thewalrus.random.sample_streams` from a single seed and the index of the sample. The
+output therefore only depends on the seed, and not on the chunk size, the number of workers or
+how the chunks are scheduled.
+
+Summary
+-------
+
+.. autosummary::
+    sampling_pool
+    shutdown_sampling_pool
+    share_arrays
+    run_chunks
+
+Code details
+------------
+"""
+import atexit
+import multiprocessing
+import os
+import tempfile
+from concurrent.futures import ProcessPoolExecutor
+
+import numpy as np
+
+# directory of the memory-mapped blocks; a RAM-backed file system when there is one
+SHARED_DIR = "/dev/shm" if os.path.isdir("/dev/shm") else tempfile.gettempdir()
+
+# persistent pool and its number of workers
+_pool = None
+_pool_workers = None
+
+# block mapped by the current worker process, as its path and its arrays
+_attached = {"path": None, "arrays": None}
+
+
+def sampling_pool(workers=None):
+    """Returns the persistent pool of worker processes, starting it if needed.
+
+    The workers are started with the ``"spawn"`` method, so that forking a process whose
+    Numba threads are running is never needed.
+
+    Args:
+        workers (int): number of worker processes; defaults to the number of CPUs
+
+    Returns:
+        concurrent.futures.ProcessPoolExecutor: the pool
+    """
+    global _pool, _pool_workers  # pylint: disable=global-statement
+    workers = workers or os.cpu_count()
+    if _pool is None or _pool_workers != workers:
+        shutdown_sampling_pool()
+        _pool = ProcessPoolExecutor(workers, mp_context=multiprocessing.get_context("spawn"))
+        _pool_workers = workers
+    return _pool
+
+
+def shutdown_sampling_pool():
+    """Stops the worker processes of the persistent pool, if it is running."""
+    global _pool  # pylint: disable=global-statement
+    if _pool is not None:
+        _pool.shutdown()
+        _pool = None
+
+
+atexit.register(shutdown_sampling_pool)
+
+
+def map_arrays(path, layout, mode="r+"):
+    """Maps the arrays of a block created by :func:`share_arrays`.
+
+    Args:
+        path (str): path of the block
+        layout (list[tuple]): offset, shape and type of each array
+        mode (str): mode in which the block is mapped
+
+    Returns:
+        list[array]: the arrays, backed by the block
+    """
+    buffer = np.memmap(path, dtype=np.uint8, mode=mode)
+    return [
+        np.ndarray(shape, dtype=dtype, buffer=buffer, offset=offset)
+        for offset, shape, dtype in layout
+    ]
+
+
+def share_arrays(arrays):
+    """Copies arrays into a new memory-mapped block that can be mapped by other processes.
+
+    Args:
+        arrays (list[array]): the arrays
+
+    Returns:
+        tuple[str, list[tuple]]: path of the block, and offset, shape and type of each array
+    """
+    layout, size = [], 0
+    for array in arrays:
+        size = -(-size // 64) * 64  # align every array on a cache line
+        layout.append((size, array.shape, array.dtype.str))
+        size += array.nbytes
+
+    fd, path = tempfile.mkstemp(prefix="thewalrus-", dir=SHARED_DIR)
+    os.ftruncate(fd, max(size, 1))
+    os.close(fd)
+    for array, view in zip(arrays, map_arrays(path, layout)):
+        view[...] = array
+    return path, layout
+
+
+def attached_arrays(path, layout):
+    """Arrays of a block in a worker process, mapping the block on its first use.
+
+    Args:
+        path (str): path of the block
+        layout (list[tuple]): offset, shape and type of each array
+
+    Returns:
+        list[array]: the arrays, backed by the block
+    """
+    if _attached["path"] != path:
+        _attached["arrays"] = map_arrays(path, layout)
+        _attached["path"] = path
+    return _attached["arrays"]
+
+
+def _run_chunk(task, path, layout, start, stop, seed, args):
+    """Runs a task in a worker process on the arrays of a block."""
+    task(attached_arrays(path, layout), start, stop, seed, *args)
+
+
+# pylint: disable=too-many-arguments
+def run_chunks(task, arrays, out, chunk_size, seed, args=(), workers=None):
+    """Fills an array by chunks of rows in the worker processes of the persistent pool.
+
+    The task is called in a worker as ``task(arrays, start, stop, seed, *args)``, where
+    ``arrays`` are the shared copies of the input arrays followed by the output array, whose
+    rows ``start`` to ``stop`` it must fill, and ``seed`` is the seed of the whole array, from
+    which the task derives the stream of each row with :func:`thewalrus.random.sample_streams`.
+
+    Args:
+        task (callable): module level function filling a chunk of rows
+        arrays (list[array]): input arrays
+        out (array): output array, overwritten
+        chunk_size (int): number of rows per chunk
+        seed (numpy.random.SeedSequence): seed from which the stream of every row is derived
+        args (tuple): additional arguments of the task
+        workers (int): number of worker processes; defaults to the number of CPUs
+    """
+    path, layout = share_arrays(list(arrays) + [out])
+    try:
+        pool = sampling_pool(workers)
+        starts = range(0, len(out), chunk_size)
+        bounds = [(start, min(start + chunk_size, len(out))) for start in starts]
+        futures = [
+            pool.submit(_run_chunk, task, path, layout, start, stop, seed, args)
+            for start, stop in bounds
+        ]
+        for future in futures:
+            future.result()
+        out[...] = map_arrays(path, layout, mode="r")[-1]
+    finally:
+        try:
+            os.remove(path)
+        except OSError:  # pragma: no cover
+            pass
@@ -0,0 +1,131 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""
+Deterministic parallel summation
+================================
+
+Tools shared by the parallel kernels to sum an exponential number of terms.
+
+The range of terms is split into a fixed number of contiguous chunks, independent of the
+number of threads. Each chunk is summed sequentially with compensated summation, and the
+partial sums are then combined pairwise in a fixed order. For a given number of chunks the
+result is therefore bitwise reproducible, whatever the number of threads used.
+
+Summary
+-------
+
+.. autosummary::
+    num_chunks
+    chunk_range
+    two_sum
+    compensated_add
+    tree_sum
+
+Code details
+------------
+"""
+import numba
+
+# number of chunks the terms of a parallel sum are split into, independently of the thread count
+SUM_CHUNKS = 512
+
+
+@numba.jit(nopython=True, cache=True)
+def num_chunks(steps, n_chunks=SUM_CHUNKS):  # pragma: no cover
+    """Number of contiguous chunks into which the ``steps`` terms of a sum are split.
+
+    Args:
+        steps (int): number of terms in the sum
+        n_chunks (int): requested number of chunks
+
+    Returns:
+        int: number of chunks, at most ``steps`` and at least one
+    """
+    return max(1, min(steps, n_chunks))
+
+
+@numba.jit(nopython=True, cache=True)
+def chunk_range(chunk, n_chunks, steps):  # pragma: no cover
+    """Bounds of one of ``n_chunks`` contiguous, near-equal blocks of ``range(steps)``.
+
+    Args:
+        chunk (int): index of the block
+        n_chunks (int): total number of blocks
+        steps (int): length of the range being split
+
+    Returns:
+        tuple[int, int]: first index and one past the last index of the block
+    """
+    size, extra = steps // n_chunks, steps % n_chunks
+    start = chunk * size + min(chunk, extra)
+    stop = start + size + (1 if chunk < extra else 0)
+    return start, stop
+
+
+@numba.jit(nopython=True, cache=True)
+def two_sum(a, b):  # pragma: no cover
+    """Error-free transformation of a sum (Knuth's TwoSum). For complex numbers the
+    transformation applies to the real and imaginary parts separately.
+
+    Args:
+        a (float or complex): first summand
+        b (float or complex): second summand
+
+    Returns:
+        tuple: the floating point sum ``a + b`` and its exact rounding error
+    """
+    s = a + b
+    b_virtual = s - a
+    a_virtual = s - b_virtual
+    return s, (a - a_virtual) + (b - b_virtual)
+
+
+@numba.jit(nopython=True, cache=True)
+def compensated_add(total, compensation, x):  # pragma: no cover
+    """Adds ``x`` to a running compensated sum. The value of the sum is
+    ``total + compensation``. Unlike plain Kahan summation, the rounding error is
+    captured exactly even when ``x`` is larger than the running total, which is the
+    common case in alternating inclusion-exclusion sums.
+
+    Args:
+        total (float or complex): running sum
+        compensation (float or complex): accumulated rounding error of the running sum
+        x (float or complex): new term
+
+    Returns:
+        tuple: updated running sum and compensation
+    """
+    total, error = two_sum(total, x)
+    return total, compensation + error
+
+
+@numba.jit(nopython=True, cache=True)
+def tree_sum(values):  # pragma: no cover
+    """Sums the entries of a vector pairwise, in a fixed tree order.
+
+    Args:
+        values (array): vector to be summed; not modified
+
+    Returns:
+        float or complex: sum of the entries
+    """
+    buffer = values.copy()
+    n = len(buffer)
+    while n > 1:
+        for i in range(n // 2):
+            buffer[i] = buffer[2 * i] + buffer[2 * i + 1]
+        if n % 2 == 1:
+            buffer[n // 2] = buffer[n - 1]
+        n = (n + 1) // 2
+    return buffer[0]
@@ -17,15 +17,28 @@ Torontonian Python interface
 import numpy as np
 import numba
 from thewalrus.quantum.conversions import Qmat, reduced_gaussian
-from ._hafnian import reduction, find_kept_edges, nb_ix
+from ._hafnian import reduction, find_kept_edges, nb_ix, step_bounds, range_steps
+from ._summation import SUM_CHUNKS, num_chunks, chunk_range, compensated_add, tree_sum
+from .instrumentation import instrumented
 
+# number of leading modes over which the recursive torontonians are split into parallel tasks
+SPLIT_DEPTH = 8
 
-def tor(A, recursive=True):
+
+@instrumented(
+    "tor",
+    steps=lambda A, recursive=True, step_range=None: range_steps(2 ** (len(A) // 2), step_range),
+)
+def tor(A, recursive=True, step_range=None):
     """Returns the Torontonian of a matrix.
 
     Args:
         A (array): a square array of even dimensions.
         recursive: use the faster recursive implementation.
+        step_range (tuple[int, int]): If provided, the partial sum over the subsets of index
+            ``start <= j < stop`` of the non-recursive implementation is returned, regardless of
+            ``recursive``. Partial sums over disjoint ranges covering all the ``2**(N/2)``
+            subsets add up to the Torontonian; see :mod:`thewalrus.distributed`.
 
     Returns:
         np.float64 or np.complex128: the torontonian of matrix A.
@@ -40,16 +53,28 @@ def tor(A, recursive=True):
 
     if matshape[0] % 2 != 0:
         raise ValueError("matrix dimension must be even")
+
+    if step_range is not None:
+        return numba_tor(A, SUM_CHUNKS, *step_bounds(step_range))
     return rec_torontonian(A) if recursive else numba_tor(A)
 
 
-def ltor(A, gamma, recursive=True):
+@instrumented(
+    "ltor",
+    steps=lambda A, gamma, recursive=True, step_range=None: range_steps(
+        2 ** (len(A) // 2), step_range
+    ),
+)
+def ltor(A, gamma, recursive=True, step_range=None):
     """Returns the loop Torontonian of an NxN matrix and an N-length vector.
 
     Args:
         A (array): an NxN array of even dimensions.
         gamma (array): an N-length vector of even dimensions
         recursive: use the faster recursive implementation
+        step_range (tuple[int, int]): If provided, the partial sum over the subsets of index
+            ``start <= j < stop`` of the non-recursive implementation is returned, as in
+            :func:`tor`.
 
     Returns:
         np.float64 or np.complex128: the loop torontonian of matrix A, vector gamma
@@ -72,6 +97,8 @@ def ltor(A, gamma, recursive=True):
     if matshape[0] % 2 != 0:
         raise ValueError("matrix dimension must be even")
 
+    if step_range is not None:
+        return numba_ltor(A, gamma, SUM_CHUNKS, *step_bounds(step_range))
     return rec_ltorontonian(A, gamma) if recursive else numba_ltor(A, gamma)
 
 
@@ -121,12 +148,20 @@ def threshold_detection_prob(
     return numba_vac_prob(alpha, sigma) * numba_ltor(O_red, gamma_red).real
 
 
-@numba.jit(nopython=True)
-def numba_tor(O):  # pragma: no cover
+@numba.jit(nopython=True, parallel=True, cache=True)
+def numba_tor(O, n_chunks=SUM_CHUNKS, step_start=0, step_stop=-1):  # pragma: no cover
     r"""Returns the Torontonian of a matrix using numba.
 
+    The terms are split into ``n_chunks`` blocks that are summed in parallel with
+    compensated summation and combined in a fixed order, so the result does not depend on
+    the number of threads. Only the subsets of index ``step_start <= j < step_stop`` are summed.
+
     Args:
         O (array): a square, symmetric array of even dimensions.
+        n_chunks (int): number of blocks the sum is split into
+        step_start (int): index of the first subset summed
+        step_stop (int): one past the index of the last subset summed; negative for all the
+            subsets after ``step_start``
 
     Returns:
         np.float64 or np.complex128: the torontonian of matrix A.
@@ -137,25 +172,60 @@ def numba_tor(O):  # pragma: no cover
     steps = 2**N
     ones = np.ones(N, dtype=np.int8)
 
-    total = 0.0
-    for j in numba.prange(steps):
-        X_modes = find_kept_edges(j, ones)
-        lenX = X_modes.sum()
-        I = np.eye(2 * lenX, dtype=O.dtype)
-        plusminus = (-1) ** ((N_odd - lenX % 2) % 2)
+    if step_stop < 0 or step_stop > steps:
+        step_stop = steps
+    step_start = min(step_start, step_stop)
 
-        kept_modes = np.where(X_modes != 0)[0]
-        kept_rows = np.concatenate((kept_modes, kept_modes + N))
-        O_XX = nb_ix(O, kept_rows, kept_rows)
+    n_chunks = num_chunks(step_stop - step_start, n_chunks)
+    partials = np.zeros(n_chunks, dtype=O.dtype)
+    for c in numba.prange(n_chunks):
+        start, stop = chunk_range(c, n_chunks, step_stop - step_start)
+        start, stop = start + step_start, stop + step_start
+        total, comp = O.dtype.type(0), O.dtype.type(0)
+        for j in range(start, stop):
+            X_modes = find_kept_edges(j, ones)
+            lenX = X_modes.sum()
+            I = np.eye(2 * lenX, dtype=O.dtype)
+            plusminus = (-1) ** ((N_odd - lenX % 2) % 2)
 
-        bottom = np.sqrt(O.dtype.type(np.real(np.linalg.det(I - O_XX))))
+            kept_modes = np.where(X_modes != 0)[0]
+            kept_rows = np.concatenate((kept_modes, kept_modes + N))
+            O_XX = nb_ix(O, kept_rows, kept_rows)
 
-        total += plusminus / bottom
+            bottom = np.sqrt(O.dtype.type(np.real(np.linalg.det(I - O_XX))))
 
-    return total
+            total, comp = compensated_add(total, comp, plusminus / bottom)
+        partials[c] = total + comp
 
+    return tree_sum(partials)
 
-@numba.jit(nopython=True)
+
+@numba.jit(nopython=True, cache=True)
+def split_modes(task, depth, n):  # pragma: no cover
+    """Returns the set of removed modes and the rows of the remaining interleaved matrix
+    for one of the ``2**depth`` independent tasks of the recursive torontonians.
+
+    Task ``task`` removes mode ``k < depth`` if and only if bit ``k`` of ``task`` is set;
+    the recursion inside the task then only removes modes ``depth, ..., n - 1``. Every task
+    therefore covers exactly ``2**(n - depth)`` terms.
+
+    Args:
+        task (int): index of the task
+        depth (int): number of leading modes fixed by the task
+        n (int): number of modes of the original matrix
+
+    Returns:
+        tuple[array, array]: removed modes and kept rows of the interleaved matrix
+    """
+    removed = np.array([k for k in range(depth) if (task >> k) & 1], dtype=np.int_)
+    kept = np.array([k for k in range(n) if k >= depth or not (task >> k) & 1], dtype=np.int_)
+    Z = np.empty((2 * len(kept),), dtype=np.int_)
+    Z[0::2] = 2 * kept
+    Z[1::2] = 2 * kept + 1
+    return removed, Z
+
+
+@numba.jit(nopython=True, cache=True)
 def quad_cholesky(L, Z, idx, mat):  # pragma: no cover
     """Returns the Cholesky factorization of a matrix using sub-matrix of prior
 
@@ -188,7 +258,7 @@ def quad_cholesky(L, Z, idx, mat):  # pragma: no cover
 
 
 @numba.jit(nopython=True)
-def recursiveTor(L, modes, A, n):  # pragma: no cover
+def recursiveTor(L, modes, A, n, start):  # pragma: no cover
     """Returns the recursive Torontonian sub-computation of a matrix
     using numba.
 
@@ -200,17 +270,13 @@ def recursiveTor(L, modes, A, n):  # pragma: no cover
         modes (array): optical mode
         A (array): a square, symmetric array of even dimensions
         n: size of the original matrix
+        start (int): first mode that may be removed; larger than every entry of ``modes``
 
     Returns:
         np.float64 or np.complex128: the recursive torontonian
         sub-computation of matrix ``A``
     """
     tot = 0.0
-    if len(modes) == 0:
-        start = 0
-    else:
-        start = modes[-1] + 1
-
     for i in range(start, n):
         nextModes = np.append(modes, i)
         nm, idx = len(A) >> 1, (i - len(modes)) * 2
@@ -220,20 +286,25 @@ def recursiveTor(L, modes, A, n):  # pragma: no cover
         Az = nb_ix(A, Z, Z)
         Ls = quad_cholesky(L, Z, idx, np.eye(2 * nm) - Az)
         det = np.square(np.prod(np.diag(Ls)))
-        tot += ((-1) ** len(nextModes)) / np.sqrt(det) + recursiveTor(Ls, nextModes, Az, n)
+        tot += ((-1) ** len(nextModes)) / np.sqrt(det) + recursiveTor(Ls, nextModes, Az, n, i + 1)
 
     return tot
 
 
-@numba.jit(nopython=True)
-def rec_torontonian(A):  # pragma: no cover
+@numba.jit(nopython=True, parallel=True, cache=True)
+def rec_torontonian(A, depth=SPLIT_DEPTH):  # pragma: no cover
     """Returns the Torontonian of a matrix using numba.
 
     Algorithm from paper:
     https://arxiv.org/pdf/2109.04528.pdf
 
+    The recursion is split over the removal pattern of the first ``depth`` modes into
+    ``2**depth`` tasks of equal size that run in parallel, each starting from its own
+    Cholesky factor. The task results are combined in a fixed order.
+
     Args:
         A (array): a square, symmetric array of even dimensions
+        depth (int): number of leading modes the recursion is split over
 
     Returns:
         np.float64 or np.complex128: the torontonian of matrix ``A``
@@ -243,12 +314,24 @@ def rec_torontonian(A):  # pragma: no cover
     Z[0::2] = np.arange(0, n)
     Z[1::2] = np.arange(n, 2 * n)
     A = nb_ix(A, Z, Z)
-    L = np.linalg.cholesky(np.eye(2 * n) - A)
-    det = np.square(np.prod(np.diag(L)))
-    return 1 / np.sqrt(det) + recursiveTor(L, np.empty(0, dtype=np.int_), A, n)
+    depth = min(n, depth)
+    n_tasks = 2**depth
+    # dtype of np.result_type(A.dtype, np.float64), which numba does not support
+    partials = np.zeros(n_tasks, dtype=(A[:1, :1] + 0.0).dtype)
+    for task in numba.prange(n_tasks):
+        modes, Zt = split_modes(task, depth, n)
+        sign = (-1) ** len(modes)
+        if len(Zt) == 0:
+            partials[task] = sign
+            continue
+        At = nb_ix(A, Zt, Zt)
+        L = np.linalg.cholesky(np.eye(len(Zt)) - At)
+        det = np.square(np.prod(np.diag(L)))
+        partials[task] = sign / np.sqrt(det) + recursiveTor(L, modes, At, n, depth)
+    return tree_sum(partials)
 
 
-@numba.jit(nopython=True)
+@numba.jit(nopython=True, cache=True)
 def solve_triangular(L, y):  # pragma: no cover
     """Returns the solution to the inverse of a lower non-unit
     triangular matrix times a vector like the dtrsv function of
@@ -274,7 +357,7 @@ def solve_triangular(L, y):  # pragma: no cover
 
 
 @numba.jit(nopython=True)
-def recursiveLTor(L, modes, A, n, gammaL):  # pragma: no cover
+def recursiveLTor(L, modes, A, n, gammaL, start):  # pragma: no cover
     """Returns the recursive loop Torontonian sub-computation of a matrix
     using numba.
 
@@ -288,16 +371,13 @@ def recursiveLTor(L, modes, A, n, gammaL):  # pragma: no cover
         A (array): a square, symmetric array of even dimensions
         n: size of the original matrix
         gammaL (array): a vector of even dimension
+        start (int): first mode that may be removed; larger than every entry of ``modes``
 
     Returns:
         np.float64 or np.complex128: the recursive loop torontonian
         sub-computation of matrix ``A`` and vector ``gammaL``
     """
     tot = 0.0
-    if len(modes) == 0:
-        start = 0
-    else:
-        start = modes[-1] + 1
     for i in range(start, n):
         nextModes = np.append(modes, i)
         nm, idx = len(A) >> 1, (i - len(modes)) * 2
@@ -310,22 +390,25 @@ def recursiveLTor(L, modes, A, n, gammaL):  # pragma: no cover
         Lsinv = solve_triangular(Ls, gammaX.conj())
         lc = Lsinv.conj().T @ Lsinv
         tot += ((-1) ** len(nextModes)) * np.exp(0.5 * lc) / np.sqrt(det) + recursiveLTor(
-            Ls, nextModes, Az, n, gammaX
+            Ls, nextModes, Az, n, gammaX, i + 1
         )
     return tot
 
 
-@numba.jit(nopython=True)
-def rec_ltorontonian(A, gamma):  # pragma: no cover
+@numba.jit(nopython=True, parallel=True, cache=True)
+def rec_ltorontonian(A, gamma, depth=SPLIT_DEPTH):  # pragma: no cover
     """Returns the loop Torontonian of a matrix using numba.
 
     Combines algorithm from papers:
     https://arxiv.org/pdf/2109.04528.pdf
     https://arxiv.org/pdf/2202.04600.pdf
 
+    The recursion is split into ``2**depth`` parallel tasks as in :func:`rec_torontonian`.
+
     Args:
         A (array): a square, symmetric array of even dimensions
         gamma (array): a vector of even dimension
+        depth (int): number of leading modes the recursion is split over
 
     Returns:
         np.float64 or np.complex128: the torontonian of matrix ``A``
@@ -337,16 +420,28 @@ def rec_ltorontonian(A, gamma):  # pragma: no cover
     Z[1::2] = np.arange(n, 2 * n)
     A = nb_ix(A.astype(np.complex128), Z, Z)
     gamma = gamma[Z].astype(np.complex128)
-    L = np.linalg.cholesky(np.eye(2 * n) - A)
-    det = np.square(np.prod(np.diag(L)))
-    Ls = solve_triangular(L, gamma.conj())
-    lc = Ls.conj().T @ Ls
-    return np.exp(0.5 * lc) / np.sqrt(det) + recursiveLTor(
-        L, np.empty(0, dtype=np.int_), A, n, gamma
-    )
+    depth = min(n, depth)
+    n_tasks = 2**depth
+    partials = np.zeros(n_tasks, dtype=np.complex128)
+    for task in numba.prange(n_tasks):
+        modes, Zt = split_modes(task, depth, n)
+        sign = (-1) ** len(modes)
+        if len(Zt) == 0:
+            partials[task] = sign
+            continue
+        At = nb_ix(A, Zt, Zt)
+        gammat = gamma[Zt]
+        L = np.linalg.cholesky(np.eye(len(Zt)) - At)
+        det = np.square(np.prod(np.diag(L)))
+        Ls = solve_triangular(L, gammat.conj())
+        lc = Ls.conj().T @ Ls
+        partials[task] = sign * np.exp(0.5 * lc) / np.sqrt(det) + recursiveLTor(
+            L, modes, At, n, gammat, depth
+        )
+    return tree_sum(partials)
 
 
-@numba.jit(nopython=True)
+@numba.jit(nopython=True, cache=True)
 def numba_vac_prob(alpha, sigma):  # pragma: no cover
     r"""
     Return the vacuum probability of a Gaussian state with Q function `sigma`
@@ -367,13 +462,21 @@ def numba_vac_prob(alpha, sigma):  # pragma: no cover
     ).real
 
 
-@numba.jit(nopython=True, parallel=True)
-def numba_ltor(O, gamma):  # pragma: no cover
+@numba.jit(nopython=True, parallel=True, cache=True)
+def numba_ltor(O, gamma, n_chunks=SUM_CHUNKS, step_start=0, step_stop=-1):  # pragma: no cover
     r"""Returns the loop Torontonian of a matrix using numba.
 
+    The terms are split into ``n_chunks`` blocks that are summed in parallel with
+    compensated summation and combined in a fixed order, so the result does not depend on
+    the number of threads. Only the subsets of index ``step_start <= j < step_stop`` are summed.
+
     Args:
         O (array): a square, symmetric array of even dimensions.
         gamma (array): a vector of even dimension
+        n_chunks (int): number of blocks the sum is split into
+        step_start (int): index of the first subset summed
+        step_stop (int): one past the index of the last subset summed; negative for all the
+            subsets after ``step_start``
 
     Returns:
         np.complex128: the loop torontonian of matrix O, vector gamma
@@ -387,27 +490,37 @@ def numba_ltor(O, gamma):  # pragma: no cover
     gamma = gamma.astype(np.complex128)
     O = O.astype(np.complex128)
 
-    total = 0.0
-    for j in numba.prange(steps):
-        X_modes = find_kept_edges(j, ones)
-        lenX = X_modes.sum()
-        I = np.eye(2 * lenX, dtype=O.dtype)
-        plusminus = (-1) ** ((N_odd - lenX % 2) % 2)
+    if step_stop < 0 or step_stop > steps:
+        step_stop = steps
+    step_start = min(step_start, step_stop)
+
+    n_chunks = num_chunks(step_stop - step_start, n_chunks)
+    partials = np.zeros(n_chunks, dtype=np.complex128)
+    for c in numba.prange(n_chunks):
+        start, stop = chunk_range(c, n_chunks, step_stop - step_start)
+        start, stop = start + step_start, stop + step_start
+        total, comp = 0j, 0j
+        for j in range(start, stop):
+            X_modes = find_kept_edges(j, ones)
+            lenX = X_modes.sum()
+            I = np.eye(2 * lenX, dtype=O.dtype)
+            plusminus = (-1) ** ((N_odd - lenX % 2) % 2)
 
-        kept_modes = np.where(X_modes != 0)[0]
-        kept_rows = np.concatenate((kept_modes, kept_modes + N))
-        O_XX = nb_ix(O, kept_rows, kept_rows)
+            kept_modes = np.where(X_modes != 0)[0]
+            kept_rows = np.concatenate((kept_modes, kept_modes + N))
+            O_XX = nb_ix(O, kept_rows, kept_rows)
 
-        I_m_O_XX = I - O_XX
-        I_m_O_XX_inv = np.linalg.inv(I_m_O_XX)
+            I_m_O_XX = I - O_XX
+            I_m_O_XX_inv = np.linalg.inv(I_m_O_XX)
 
-        gamma_X = gamma[kept_rows]
+            gamma_X = gamma[kept_rows]
 
-        top = np.exp(0.5 * gamma_X @ I_m_O_XX_inv @ gamma_X.conj())
+            top = np.exp(0.5 * gamma_X @ I_m_O_XX_inv @ gamma_X.conj())
 
-        bottom_complex = np.linalg.det(I_m_O_XX)
-        bottom = np.sqrt(O.dtype.type(bottom_complex.real))
+            bottom_complex = np.linalg.det(I_m_O_XX)
+            bottom = np.sqrt(O.dtype.type(bottom_complex.real))
 
-        total += plusminus * top / bottom
+            total, comp = compensated_add(total, comp, plusminus * top / bottom)
+        partials[c] = total + comp
 
-    return total
+    return tree_sum(partials)
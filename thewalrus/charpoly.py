@@ -30,13 +30,17 @@ Summary
     reduce_matrix_to_hessenberg
     charpoly
     powertrace
+    powertrace_workspace
+    powertrace_into
+    matmul_split_into
 
 Code details
 ------------
 """
 # pylint: disable=too-many-branches
 import numpy as np
-from numba import jit
+from numba import jit, types
+from numba.extending import overload
 
 
 @jit(nopython=True, cache=True)
@@ -52,24 +56,34 @@ def get_reflection_vector(matrix, k):  # pragma: no cover
     Returns:
         array: reflection vector
     """
-    size = len(matrix)
-    sizeH = size - k
-    reflect_vector = np.zeros(sizeH, dtype=matrix.dtype)
-    offset = k - 1
+    reflect_vector = np.zeros(len(matrix) - k, dtype=matrix.dtype)
+    reflection_vector_into(matrix, k, reflect_vector)
+    return reflect_vector
 
-    matrix_column = np.zeros(sizeH, dtype=matrix.dtype)
-    for i in range(0, sizeH):
-        matrix_column[i] = matrix[k + i, offset]
 
-    sigma = np.linalg.norm(matrix_column)
-    if matrix_column[0] != 0:
-        sigma *= matrix_column[0] / np.abs(matrix_column[0])
+@jit(nopython=True, cache=True)
+def reflection_vector_into(matrix, k, reflect_vector):  # pragma: no cover
+    r"""Compute the reflection vector of :func:`get_reflection_vector` into the first
+    ``len(matrix) - k`` entries of a preallocated vector.
 
+    Args:
+        matrix (array): the matrix in the householder transformation
+        k (int): offset for submatrix
+        reflect_vector (array): vector of length at least ``len(matrix) - k``
+    """
+    sizeH = len(matrix) - k
+    offset = k - 1
+
+    norm_sqr = 0.0
     for i in range(0, sizeH):
-        reflect_vector[i] = matrix_column[i]
+        reflect_vector[i] = matrix[k + i, offset]
+        norm_sqr += np.abs(reflect_vector[i]) ** 2
+
+    sigma = np.sqrt(norm_sqr)
+    if reflect_vector[0] != 0:
+        sigma *= reflect_vector[0] / np.abs(reflect_vector[0])
 
     reflect_vector[0] += sigma
-    return reflect_vector
 
 
 @jit(nopython=True, cache=True)
@@ -84,13 +98,36 @@ def apply_householder(A, v, k):  # pragma: no cover
         k (int): offset for submatrix
     """
     size_A = len(A)
-    sizeH = len(v)
-    norm_v_sqr = np.linalg.norm(v) ** 2
+    vHA = np.zeros(size_A - k + 1, dtype=A.dtype)
+    Av = np.zeros(size_A, dtype=A.dtype)
+    apply_householder_into(A, v, len(v), k, vHA, Av)
+
+
+# pylint: disable=too-many-arguments
+@jit(nopython=True, cache=True)
+def apply_householder_into(A, v, sizeH, k, vHA, Av):  # pragma: no cover
+    r"""Apply the householder transformation of :func:`apply_householder` using
+    preallocated scratch vectors.
+
+    Args:
+        A (array): A matrix to apply householder on
+        v (array): reflection vector, of which the first ``sizeH`` entries are used
+        sizeH (int): length of the reflection vector
+        k (int): offset for submatrix
+        vHA (array): scratch vector of length at least ``len(A) - k + 1``
+        Av (array): scratch vector of length at least ``len(A)``
+    """
+    size_A = len(A)
+    norm_v_sqr = 0.0
+    for l in range(0, sizeH):
+        norm_v_sqr += np.abs(v[l]) ** 2
     if norm_v_sqr == 0:
         return
 
-    vHA = np.zeros(size_A - k + 1, dtype=A.dtype)
-    Av = np.zeros(size_A, dtype=A.dtype)
+    for j in range(0, size_A - k + 1):
+        vHA[j] = 0
+    for i in range(0, size_A):
+        Av[i] = 0
 
     for j in range(0, size_A - k + 1):
         for l in range(0, sizeH):
@@ -120,9 +157,23 @@ def reduce_matrix_to_hessenberg(matrix):  # pragma: no cover
     Returns:
         array: matrix in hessenberg form
     """
-    for i in range(1, len(matrix) - 1):
-        reflect_vector = get_reflection_vector(matrix, i)
-        apply_householder(matrix, reflect_vector, i)
+    vecs = np.zeros((3, len(matrix)), dtype=matrix.dtype)
+    reduce_matrix_to_hessenberg_into(matrix, vecs)
+
+
+@jit(nopython=True, cache=True)
+def reduce_matrix_to_hessenberg_into(matrix, vecs):  # pragma: no cover
+    r"""Reduce the matrix to upper hessenberg form in place, using the first three rows of
+    ``vecs`` as scratch space for the reflection vector and the householder products.
+
+    Args:
+        matrix (array): the matrix to be reduced
+        vecs (array): scratch vectors of shape at least ``(3, len(matrix))``
+    """
+    size = len(matrix)
+    for i in range(1, size - 1):
+        reflection_vector_into(matrix, i, vecs[0])
+        apply_householder_into(matrix, vecs[0], size - i, i, vecs[1], vecs[2])
 
 
 @jit(nopython=True, cache=True)
@@ -210,8 +261,25 @@ def _charpoly(H, k):  # pragma: no cover
     Returns:
         array: char-poly coeffs + auxiliary data (see comment in function)
     """
-    n = len(H)
     c = np.zeros_like(H)
+    coeffs = np.zeros(len(H), dtype=H.dtype)
+    charpoly_into(H, k, c, coeffs)
+    return coeffs
+
+
+@jit(nopython=True, cache=True)
+def charpoly_into(H, k, c, coeffs):  # pragma: no cover
+    r"""Compute the characteristic polynomial of :func:`_charpoly` using a preallocated
+    table for the auxiliary data.
+
+    Args:
+        H (array): matrix in Hessenberg form (RowMajor)
+        k (int): compute coefficients up to ``k`` (``k`` must be ``<= n``)
+        c (array): scratch matrix of the same shape as ``H``
+        coeffs (array): vector of length ``len(H)`` that receives the coefficients
+    """
+    n = len(H)
+    c[:, :] = 0
     c[mlo(1, 1)] = -alpha(H, 1)
     c[mlo(2, 1)] = c[mlo(1, 1)] - alpha(H, 2)
     c[mlo(2, 2)] = alpha(H, 1) * alpha(H, 2) - hij(H, 1, 2) * beta(H, 2)
@@ -277,9 +345,8 @@ def _charpoly(H, k):  # pragma: no cover
                     - suma
                     - hij(H, i - j + 1, i) * beta_prod
                 )
-    poly_list = [c[n - 1, i - 1] for i in range(1, n + 1)]
-
-    return poly_list
+    for i in range(1, n + 1):
+        coeffs[i - 1] = c[n - 1, i - 1]
 
 
 @jit(nopython=True, cache=True)
@@ -309,19 +376,214 @@ def powertrace(H, n):  # pragma: no cover
     Returns:
         (array): list of power traces from ``0`` to ``n-1``
     """
+    mats, vecs = powertrace_workspace(H)
+    pow_traces = np.zeros(max(n, 2), dtype=H.dtype)
+    powertrace_into(H, n, pow_traces, mats, vecs)
+    return pow_traces
+
+
+@jit(nopython=True, cache=True)
+def powertrace_workspace(H):  # pragma: no cover
+    """Allocates the scratch space used by :func:`powertrace_into` for matrices of the
+    same shape and type as ``H``.
+
+    Args:
+        H (array): square matrix
+
+    Returns:
+        tuple[tuple[array, array], array]: scratch matrices, together with the real and
+        imaginary planes of the powers of complex matrices (empty for real ones), and
+        scratch vectors
+    """
+    m = len(H)
+    m_planes = m if np.iscomplexobj(H) else 0
+    scratch = np.zeros((2, m, m), dtype=H.dtype)
+    planes = np.zeros((3, 2, m_planes, m_planes))
+    return (scratch, planes), np.zeros((4, m), dtype=H.dtype)
+
+
+@jit(nopython=True, cache=True)
+def matmul_into(X, Y, out):  # pragma: no cover
+    """Writes the product of the square matrices ``X`` and ``Y`` into ``out``.
+
+    Args:
+        X (array): square matrix
+        Y (array): square matrix
+        out (array): square matrix distinct from ``X`` and ``Y``
+    """
+    m = len(X)
+    for i in range(m):
+        for j in range(m):
+            out[i, j] = 0
+        for k in range(m):
+            x = X[i, k]
+            for j in range(m):
+                out[i, j] += x * Y[k, j]
+
+
+# pylint: disable=too-many-arguments
+@jit(nopython=True, cache=True)
+def matmul_split_into(Xr, Xi, Yr, Yi, out_r, out_i):  # pragma: no cover
+    """Writes the product of two complex square matrices, stored as separate real and
+    imaginary planes, into the planes ``out_r`` and ``out_i``. The inner loops only involve
+    contiguous real rows, which the compiler turns into fused multiply-add vector loops.
+
+    Args:
+        Xr (array): real part of the first matrix
+        Xi (array): imaginary part of the first matrix
+        Yr (array): real part of the second matrix
+        Yi (array): imaginary part of the second matrix
+        out_r (array): real part of the product, distinct from the inputs
+        out_i (array): imaginary part of the product, distinct from the inputs
+    """
+    m = len(Xr)
+    for i in range(m):
+        for j in range(m):
+            out_r[i, j] = 0.0
+            out_i[i, j] = 0.0
+        for k in range(m):
+            xr, xi = Xr[i, k], Xi[i, k]
+            for j in range(m):
+                out_r[i, j] += xr * Yr[k, j] - xi * Yi[k, j]
+                out_i[i, j] += xr * Yi[k, j] + xi * Yr[k, j]
+
+
+@jit(nopython=True, cache=True)
+def trace_of_product(X, Y):  # pragma: no cover
+    """Trace of the product of the square matrices ``X`` and ``Y``, without forming it.
+
+    Args:
+        X (array): square matrix
+        Y (array): square matrix
+
+    Returns:
+        float or complex: the trace of ``X @ Y``
+    """
+    m = len(X)
+    tr = X[0, 0] * 0
+    for i in range(m):
+        for k in range(m):
+            tr += X[i, k] * Y[k, i]
+    return tr
+
+
+@jit(nopython=True, cache=True)
+def power_traces_real(H, min_val, pow_traces, scratch):  # pragma: no cover
+    """Writes the traces of the powers ``2`` to ``min_val - 1`` of ``H`` into
+    ``pow_traces``, alternating the powers between the two scratch matrices. The last
+    trace is obtained from the previous power without forming the product.
+
+    Args:
+        H (array): square matrix
+        min_val (int): one past the largest power
+        pow_traces (array): vector receiving the traces
+        scratch (array): two scratch matrices of the shape of ``H``
+    """
+    scratch[0, :, :] = H
+    for p in range(2, min_val):
+        if p == min_val - 1:
+            pow_traces[p] = trace_of_product(scratch[p % 2], H)
+        else:
+            matmul_into(scratch[p % 2], H, scratch[1 - p % 2])
+            pow_traces[p] = np.trace(scratch[1 - p % 2])
+
+
+@jit(nopython=True, cache=True)
+def power_traces_split(H, min_val, pow_traces, planes):  # pragma: no cover
+    """Complex counterpart of :func:`power_traces_real`, with ``H`` and its powers stored
+    as separate real and imaginary planes.
+
+    Args:
+        H (array): square complex matrix
+        min_val (int): one past the largest power
+        pow_traces (array): vector receiving the traces
+        planes (array): scratch planes of shape ``(3, 2, len(H), len(H))``; the first pair
+            holds ``H`` and the other two the successive powers
+    """
+    planes[0, 0] = H.real
+    planes[0, 1] = H.imag
+    Hr, Hi = planes[0, 0], planes[0, 1]
+    for p in range(2, min_val):
+        src = 0 if p == 2 else 1 + (p - 1) % 2
+        Pr, Pi = planes[src, 0], planes[src, 1]
+        if p == min_val - 1:
+            tr_r = trace_of_product(Pr, Hr) - trace_of_product(Pi, Hi)
+            tr_i = trace_of_product(Pr, Hi) + trace_of_product(Pi, Hr)
+        else:
+            dst = 1 + p % 2
+            matmul_split_into(Pr, Pi, Hr, Hi, planes[dst, 0], planes[dst, 1])
+            tr_r, tr_i = np.trace(planes[dst, 0]), np.trace(planes[dst, 1])
+        pow_traces[p] = tr_r + 1j * tr_i
+
+
+def power_traces(H, min_val, pow_traces, scratch, planes):  # pragma: no cover
+    """Writes the traces of the powers ``2`` to ``min_val - 1`` of ``H`` into ``pow_traces``
+    with :func:`power_traces_split` for complex matrices and :func:`power_traces_real` for real
+    ones. In compiled code the kernel is picked from the type of ``H`` when compiling, so that
+    only the one matching it is typed.
+
+    Args:
+        H (array): square matrix
+        min_val (int): one past the largest power
+        pow_traces (array): vector receiving the traces
+        scratch (array): two scratch matrices of the shape of ``H``
+        planes (array): scratch planes of shape ``(3, 2, len(H), len(H))``
+    """
+    if np.iscomplexobj(H):
+        power_traces_split(H, min_val, pow_traces, planes)
+    else:
+        power_traces_real(H, min_val, pow_traces, scratch)
+
+
+@overload(power_traces)
+def _power_traces_overload(H, min_val, pow_traces, scratch, planes):
+    """Compiled version of :func:`power_traces`, selecting the kernel from the type of ``H``."""
+    # pylint: disable=unused-argument
+    if isinstance(H.dtype, types.Complex):
+
+        def split_impl(H, min_val, pow_traces, scratch, planes):  # pragma: no cover
+            power_traces_split(H, min_val, pow_traces, planes)
+
+        return split_impl
+
+    def real_impl(H, min_val, pow_traces, scratch, planes):  # pragma: no cover
+        power_traces_real(H, min_val, pow_traces, scratch)
+
+    return real_impl
+
+
+@jit(nopython=True, cache=True)
+def powertrace_into(H, n, pow_traces, mats, vecs):  # pragma: no cover
+    """Calculates the powertraces of the matrix ``H`` up to power ``n-1`` without
+    allocating, and without modifying ``H``.
+
+    Real matrices are multiplied in real arithmetic; complex ones as separate real and
+    imaginary planes (see :func:`matmul_split_into`).
+
+    Args:
+        H (array): square matrix
+        n (int): required order
+        pow_traces (array): vector of length at least ``max(n, 2)`` that receives the traces
+        mats (tuple[array, array]): scratch matrices as returned by :func:`powertrace_workspace`
+        vecs (array): scratch vectors as returned by :func:`powertrace_workspace`
+    """
+    scratch, planes = mats
     m = len(H)
     min_val = min(n, m)
-    pow_traces = [m, np.trace(H)]
-    A = H
-    for _ in range(min_val - 2):
-        A = A @ H
-        pow_traces.append(np.trace(A))
+    pow_traces[0] = m
+    pow_traces[1] = np.trace(H)
+    power_traces(H, min_val, pow_traces, scratch, planes)
     if n <= m:
-        return np.array(pow_traces, dtype=H.dtype)
-    char_pol = charpoly(H)
-    for _ in range(min_val, n):
+        return
+    # the powers are no longer needed: reuse the scratch matrices for the
+    # Hessenberg form and the La Budde table
+    hessenberg = scratch[0]
+    hessenberg[:, :] = H
+    reduce_matrix_to_hessenberg_into(hessenberg, vecs)
+    char_pol = vecs[3]
+    charpoly_into(hessenberg, m, scratch[1], char_pol)
+    for p in range(min_val, n):
         ssum = 0
         for k in range(m):
-            ssum -= char_pol[k] * pow_traces[-k - 1]
-        pow_traces.append(ssum)
-    return np.array(pow_traces, dtype=H.dtype)
+            ssum -= char_pol[k] * pow_traces[p - k - 1]
+        pow_traces[p] = ssum
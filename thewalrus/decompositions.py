@@ -22,6 +22,10 @@ Decompositions
 This module implements common shared matrix decompositions that are
 used to perform gate decompositions.
 
+The batched versions decompose stacks of matrices of shape ``(B, n, n)`` with the stacked
+linear algebra routines of NumPy, instead of one matrix per call. Their validation of the
+inputs can be skipped with ``check=False`` when the matrices are known to be valid.
+
 Summary
 -------
 
@@ -29,6 +33,11 @@ Summary
     williamson
     symplectic_eigenvals
     blochmessiah
+    takagi
+    williamson_batch
+    symplectic_eigenvals_batch
+    blochmessiah_batch
+    takagi_batch
 
 Code details
 ------------
@@ -229,3 +238,171 @@ def takagi(A, svd_order=True):
     if svd_order is False:
         return d[::-1], U[:, ::-1]
     return d, U
+
+
+def _sqrt_stack(V):
+    """Returns the square roots and the inverse square roots of a stack of positive definite
+    symmetric matrices, and their eigenvalues."""
+    vals, U = np.linalg.eigh(V)
+    Ut = np.swapaxes(U, 1, 2)
+    root = np.sqrt(np.abs(vals))[:, None, :]
+    return (U * root) @ Ut, (U / root) @ Ut, vals
+
+
+def _block_diag_stack(X, Y):
+    """Returns the block diagonal matrices of two stacks of square matrices."""
+    B, h, _ = X.shape
+    Z = np.zeros((B, 2 * h, 2 * h), dtype=np.result_type(X, Y))
+    Z[:, :h, :h] = X
+    Z[:, h:, h:] = Y
+    return Z
+
+
+def williamson_batch(V, rtol=1e-05, atol=1e-08, check=True):
+    r"""Williamson decompositions of a stack of positive-definite (real) symmetric matrices,
+    as returned by :func:`williamson` for each of them.
+
+    The diagonal of each ``Db`` holds the symplectic eigenvalues in ascending order, repeated
+    for the :math:`x` and :math:`p` quadratures.
+
+    Args:
+        V (array[float]): array of shape ``(B, 2n, 2n)`` of positive definite symmetric matrices
+        rtol (float): the relative tolerance parameter used in ``np.allclose``
+        atol (float): the absolute tolerance parameter used in ``np.allclose``
+        check (bool): whether to check the matrices are symmetric and positive definite
+
+    Returns:
+        tuple[array,array]: ``(Db, S)``, the stacks of the diagonal matrices and of the
+        symplectic matrices of the decompositions of each matrix
+    """
+    V = np.asarray(V)
+    (_, n, m) = V.shape
+
+    if n != m:
+        raise ValueError("The input matrix is not square")
+
+    if check and not np.allclose(V, np.swapaxes(V, 1, 2), rtol=rtol, atol=atol):
+        raise ValueError("The input matrix is not symmetric")
+
+    if n % 2 != 0:
+        raise ValueError("The input matrix must have an even number of rows/columns")
+
+    n = n // 2
+    Vh, Vmh, vals = _sqrt_stack(V)
+
+    if check and not np.all(vals > 0):
+        raise ValueError("Input matrix is not positive definite")
+
+    # The antisymmetric matrix r1 of williamson has eigenvalues +-1j/d; the real and imaginary
+    # parts of its eigenvectors of eigenvalue 1j/d are the columns of its real Schur form with a
+    # positive element above the diagonal, in the x_1, ..., x_n, p_1, ..., p_n ordering
+    r1 = Vmh @ sympmat(n) @ Vmh
+    w, v = np.linalg.eigh(1j * r1)
+    K = np.sqrt(2) * np.concatenate([v[:, :, :n].real, v[:, :, :n].imag], axis=2)
+    dd = np.tile(-1 / w[:, :n], 2)
+    Db = dd[:, :, None] * np.identity(2 * n)
+    return Db, Vh @ K / np.sqrt(dd)[:, None, :]
+
+
+def symplectic_eigenvals_batch(cov):
+    r"""Returns the symplectic eigenvalues of a stack of covariance matrices.
+
+    Args:
+        cov (array): array of shape ``(B, 2n, 2n)`` of covariance matrices
+
+    Returns:
+        (array): array of shape ``(B, n)`` of the symplectic eigenvalues of each covariance
+        matrix, in ascending order
+    """
+    n = cov.shape[1] // 2
+    Vh, _, _ = _sqrt_stack(np.asarray(cov))
+    return np.linalg.eigvalsh(1j * Vh @ sympmat(n) @ Vh)[:, n:]
+
+
+def takagi_batch(A, svd_order=True):
+    r"""Autonne-Takagi decompositions of a stack of complex symmetric matrices, as returned by
+    :func:`takagi` for each of them. The matrices are internally symmetrized.
+
+    The Takagi values are the nonnegative eigenvalues of the real symmetric matrix
+    :math:`\begin{pmatrix} \Re A & \Im A \\ \Im A & -\Re A \end{pmatrix}`, whose eigenvectors
+    :math:`(p, q)` give the columns :math:`p + iq` of the Takagi unitary. Each column is
+    signed so that its entry of largest modulus has a nonnegative real part.
+
+    Args:
+        A (array): array of shape ``(B, n, n)`` of symmetric matrices
+        svd_order (boolean): whether to return result by ordering the singular values of ``A``
+            in descending (``True``) or ascending (``False``) order.
+
+    Returns:
+        tuple[array, array]: (r, U), the stacks of the singular values and of the complex
+        Autonne-Takagi unitaries, such that :math:`A = U \diag(r) U^T` for each matrix.
+    """
+    A = np.asarray(A)
+    (_, n, m) = A.shape
+    if n != m:
+        raise ValueError("The input matrix is not square")
+    A = 0.5 * (A + np.swapaxes(A, 1, 2))
+    X, Y = A.real, A.imag
+    M = np.concatenate([np.concatenate([X, Y], axis=2), np.concatenate([Y, -X], axis=2)], axis=1)
+    w, v = np.linalg.eigh(M)
+    vals = w[:, n:][:, ::-1]
+    U = v[:, :n, n:][:, :, ::-1] + 1j * v[:, n:, n:][:, :, ::-1]
+    # the eigenvectors of a vanishing Takagi value may repeat a column up to a factor of 1j;
+    # any orthonormal completion of the other columns is a valid choice for them
+    Q, R = np.linalg.qr(U)
+    U = Q * np.exp(1j * np.angle(np.diagonal(R, axis1=1, axis2=2)))[:, None, :]
+    lead = np.take_along_axis(U, np.argmax(np.abs(U), axis=1)[:, None, :], axis=1)
+    U = U * np.where(lead.real < 0, -1, 1)
+    vals = np.maximum(vals, 0)
+    if svd_order is False:
+        return vals[:, ::-1], U[:, :, ::-1]
+    return vals, U
+
+
+def blochmessiah_batch(S, check=True):
+    """Returns the Bloch-Messiah decompositions of a stack of symplectic matrices, as returned
+    by :func:`blochmessiah` for each of them.
+
+    Args:
+        S (array[float]): array of shape ``(B, 2N, 2N)`` of real symplectic matrices
+        check (bool): whether to check the matrices are symplectic
+
+    Returns:
+        tuple(array[float], array[float], array[float]): the stacks of the orthogonal
+        symplectic matrices uff, of the diagonal matrices dff and of the orthogonal
+        symplectic matrices vff
+    """
+    S = np.asarray(S)
+    _, N, _ = S.shape
+    h = N // 2
+
+    if check:
+        omega = sympmat(h)
+        if S.shape[2] != N or not np.allclose(S @ omega @ np.swapaxes(S, 1, 2), omega):
+            raise ValueError("Input matrix is not symplectic.")
+
+    # Changing Basis
+    R = (1 / np.sqrt(2)) * np.block([[np.eye(h), 1j * np.eye(h)], [np.eye(h), -1j * np.eye(h)]])
+    Rh = np.conjugate(R).T
+    Sc = R @ S @ Rh
+    # Polar Decomposition
+    u1, d1, v1 = np.linalg.svd(Sc)
+    Sig = (u1 * d1[:, None, :]) @ np.conjugate(np.swapaxes(u1, 1, 2))
+    Unitary = u1 @ v1
+    # Blocks of Unitary and Hermitian symplectics
+    alpha = Unitary[:, :h, :h]
+    beta = Sig[:, :h, h:]
+    # Bloch-Messiah in this Basis
+    d2, takagibeta = takagi_batch(beta)
+    sval = np.arcsinh(d2)
+    uf = _block_diag_stack(takagibeta, takagibeta.conj())
+    blc = np.conjugate(np.swapaxes(takagibeta, 1, 2)) @ alpha
+    vf = _block_diag_stack(blc, blc.conj())
+    ch = np.cosh(sval)[:, :, None] * np.eye(h)
+    sh = np.sinh(sval)[:, :, None] * np.eye(h)
+    df = np.block([[ch, sh], [sh, ch]])
+    # Rotating Back to Original Basis
+    uff = np.real_if_close(Rh @ uf @ R)
+    vff = np.real_if_close(Rh @ vf @ R)
+    dff = np.real_if_close(Rh @ df @ R)
+    return uff, dff, vff
@@ -0,0 +1,291 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""
+Distributed evaluation
+======================
+
+**Module name:** :mod:`thewalrus.distributed`
+
+.. currentmodule:: thewalrus.distributed
+
+This submodule shares the evaluation of hafnians, torontonians and Bristolians between
+processes or machines.
+
+Each term of the exponential sums behind these functions only depends on its index, so the
+index space is split into contiguous ranges whose partial sums, returned by
+``hafnian(A, step_range=(start, stop))`` and the like, are evaluated independently and added up.
+
+The ranges are handed to an executor following the :class:`concurrent.futures.Executor`
+interface, for instance a :class:`~concurrent.futures.ProcessPoolExecutor` on a single machine,
+an ``mpi4py.futures.MPIPoolExecutor`` under MPI or the executor returned by
+``Client.get_executor()`` of Dask distributed. Without an executor, the ranges are evaluated one
+after the other in the calling process.
+
+The partial sums are stored in a checkpoint file as soon as they are received, so that a job
+that is interrupted can be resumed by calling the same function with the same checkpoint: the
+ranges already evaluated are not evaluated again. The partial sums are combined in a fixed
+order, so the result does not depend on the order in which the ranges complete.
+
+Summary
+-------
+
+.. autosummary::
+    step_ranges
+    hafnian_steps
+    distributed_sum
+    distributed_hafnian
+    distributed_tor
+    distributed_ltor
+    distributed_brs
+
+Code details
+------------
+"""
+import hashlib
+import json
+import os
+from concurrent.futures import as_completed
+
+import numpy as np
+
+from ._hafnian import hafnian
+from ._permanent import brs
+from ._summation import SUM_CHUNKS, num_chunks, chunk_range, tree_sum
+from ._torontonian import tor, ltor
+
+# default number of ranges the terms of a distributed sum are split into
+NUM_RANGES = 256
+
+
+def step_ranges(steps, n_ranges=NUM_RANGES):
+    """Splits the indices of the terms of a sum into contiguous, near-equal ranges.
+
+    Args:
+        steps (int): number of terms in the sum
+        n_ranges (int): requested number of ranges
+
+    Returns:
+        list[tuple[int, int]]: first index and one past the last index of each range
+    """
+    n_ranges = num_chunks(steps, n_ranges)
+    return [tuple(int(i) for i in chunk_range(r, n_ranges, steps)) for r in range(n_ranges)]
+
+
+def hafnian_steps(A, loop=False, method="glynn"):
+    """Number of terms of the sum evaluated by :func:`~thewalrus.hafnian`, that is the upper
+    bound of the indices accepted by its ``step_range`` argument.
+
+    Args:
+        A (array): a square, symmetric array
+        loop (bool): whether the loop hafnian is computed
+        method (str): ``"glynn"`` or ``"inclexcl"``; the loop hafnian always uses ``"glynn"``
+
+    Returns:
+        int: number of terms of the sum
+    """
+    n = A.shape[0]
+    if n == 0 or (n % 2 == 1 and not loop):
+        return 1
+    halved = (loop or method == "glynn") and n % 2 == 0
+    return 2 ** (n // 2 - int(halved))
+
+
+def fingerprint(function, args, ranges):
+    """Identifies a distributed sum, so that a checkpoint is only resumed by the same sum.
+
+    Args:
+        function (callable): function evaluating the partial sums
+        args (tuple): positional arguments of ``function``
+        ranges (list[tuple[int, int]]): ranges of terms
+
+    Returns:
+        str: hexadecimal digest of the function name, its arguments and the ranges
+    """
+    digest = hashlib.sha256()
+    name = getattr(function, "__qualname__", type(function).__name__)
+    digest.update(f"{function.__module__}.{name}".encode())
+    for arg in args:
+        arg = np.asarray(arg)
+        digest.update(f"{arg.dtype}{arg.shape}".encode())
+        digest.update(np.ascontiguousarray(arg).tobytes())
+    digest.update(json.dumps(ranges).encode())
+    return digest.hexdigest()
+
+
+def load_checkpoint(checkpoint, key):
+    """Reads the partial sums stored in a checkpoint file.
+
+    Args:
+        checkpoint (str or None): path of the checkpoint file
+        key (str): fingerprint of the sum being evaluated
+
+    Returns:
+        dict[int, float or complex]: partial sum of each range already evaluated
+
+    Raises:
+        ValueError: if the checkpoint was written by a different sum
+    """
+    if checkpoint is None or not os.path.exists(checkpoint):
+        return {}
+    with open(checkpoint, "r", encoding="utf-8") as file:
+        data = json.load(file)
+    if data["key"] != key:
+        raise ValueError("The checkpoint file was written for a different sum.")
+    done = data["done"]
+    return {int(r): complex(*value) if len(value) == 2 else value[0] for r, value in done.items()}
+
+
+def save_checkpoint(checkpoint, key, partials):
+    """Writes the partial sums evaluated so far to a checkpoint file. The file is replaced
+    atomically, so that an interruption never leaves a corrupted checkpoint.
+
+    Args:
+        checkpoint (str or None): path of the checkpoint file; nothing is written if ``None``
+        key (str): fingerprint of the sum being evaluated
+        partials (dict[int, float or complex]): partial sum of each range evaluated
+    """
+    if checkpoint is None:
+        return
+    done = {
+        str(r): [float(np.real(value)), float(np.imag(value))]
+        if np.iscomplexobj(value)
+        else [float(value)]
+        for r, value in partials.items()
+    }
+    with open(checkpoint + ".tmp", "w", encoding="utf-8") as file:
+        json.dump({"key": key, "done": done}, file)
+    os.replace(checkpoint + ".tmp", checkpoint)
+
+
+# pylint: disable=too-many-arguments
+def distributed_sum(function, args, steps, n_ranges=NUM_RANGES, executor=None, checkpoint=None):
+    """Evaluates a sum as partial sums over ranges of its terms and adds them up.
+
+    Args:
+        function (callable): function called as ``function(*args, step_range=(start, stop))``
+            that returns the partial sum over the terms of index ``start <= j < stop``; it must
+            be picklable if ``executor`` runs in other processes
+        args (tuple): positional arguments of ``function``
+        steps (int): number of terms in the sum
+        n_ranges (int): number of ranges the terms are split into
+        executor (concurrent.futures.Executor): executor the ranges are submitted to; if
+            ``None``, they are evaluated in the calling process
+        checkpoint (str): path of a file in which the partial sums are stored as they are
+            received, and from which they are read back if it exists
+
+    Returns:
+        float or complex: the sum
+    """
+    ranges = step_ranges(steps, n_ranges)
+    key = fingerprint(function, args, ranges)
+    partials = load_checkpoint(checkpoint, key)
+    pending = [r for r in range(len(ranges)) if r not in partials]
+
+    if executor is None:
+        for r in pending:
+            partials[r] = function(*args, step_range=ranges[r])
+            save_checkpoint(checkpoint, key, partials)
+    else:
+        futures = {executor.submit(function, *args, step_range=ranges[r]): r for r in pending}
+        for future in as_completed(futures):
+            partials[futures[future]] = future.result()
+            save_checkpoint(checkpoint, key, partials)
+
+    return tree_sum(np.array([partials[r] for r in range(len(ranges))]))
+
+
+def distributed_hafnian(
+    A, loop=False, method="glynn", n_ranges=NUM_RANGES, executor=None, checkpoint=None
+):
+    """Returns the hafnian of a matrix, evaluated by :func:`distributed_sum`.
+
+    Args:
+        A (array): a square, symmetric array
+        loop (bool): If ``True``, the loop hafnian is returned
+        method (str): ``"glynn"`` or ``"inclexcl"``
+        n_ranges (int): number of ranges the terms are split into
+        executor (concurrent.futures.Executor): executor the ranges are submitted to
+        checkpoint (str): path of the checkpoint file
+
+    Returns:
+        float or complex: the hafnian of matrix ``A``
+    """
+    return distributed_sum(
+        _hafnian_range,
+        (A, loop, method),
+        hafnian_steps(A, loop=loop, method=method),
+        n_ranges,
+        executor,
+        checkpoint,
+    )
+
+
+def distributed_tor(A, n_ranges=NUM_RANGES, executor=None, checkpoint=None):
+    """Returns the Torontonian of a matrix, evaluated by :func:`distributed_sum`.
+
+    Args:
+        A (array): a square array of even dimensions
+        n_ranges (int): number of ranges the ``2**(N/2)`` subsets are split into
+        executor (concurrent.futures.Executor): executor the ranges are submitted to
+        checkpoint (str): path of the checkpoint file
+
+    Returns:
+        float or complex: the Torontonian of matrix ``A``
+    """
+    return distributed_sum(tor, (A,), 2 ** (A.shape[0] // 2), n_ranges, executor, checkpoint)
+
+
+def distributed_ltor(A, gamma, n_ranges=NUM_RANGES, executor=None, checkpoint=None):
+    """Returns the loop Torontonian of a matrix and a vector, evaluated by
+    :func:`distributed_sum`.
+
+    Args:
+        A (array): an NxN array of even dimensions
+        gamma (array): an N-length vector
+        n_ranges (int): number of ranges the ``2**(N/2)`` subsets are split into
+        executor (concurrent.futures.Executor): executor the ranges are submitted to
+        checkpoint (str): path of the checkpoint file
+
+    Returns:
+        complex: the loop Torontonian of matrix ``A`` and vector ``gamma``
+    """
+    return distributed_sum(ltor, (A, gamma), 2 ** (A.shape[0] // 2), n_ranges, executor, checkpoint)
+
+
+def distributed_brs(A, E, n_ranges=NUM_RANGES, executor=None, checkpoint=None):
+    """Returns the Bristolian of two matrices, evaluated by :func:`distributed_sum`.
+
+    Args:
+        A (array): matrix of size [m, n]
+        E (array): matrix of size [r, n]
+        n_ranges (int): number of ranges the ``2**m`` row subsets are split into
+        executor (concurrent.futures.Executor): executor the ranges are submitted to
+        checkpoint (str): path of the checkpoint file
+
+    Returns:
+        float or complex: the Bristolian of matrices ``A`` and ``E``
+    """
+    return distributed_sum(_brs_range, (A, E), 2 ** A.shape[0], n_ranges, executor, checkpoint)
+
+
+def _hafnian_range(A, loop, method, step_range):
+    """Partial sum of :func:`~thewalrus.hafnian`, as a module level function that can be
+    sent to other processes."""
+    return hafnian(A, loop=loop, method=method, step_range=step_range)
+
+
+def _brs_range(A, E, step_range):
+    """Partial sum of :func:`~thewalrus.brs`, as a module level function that can be sent
+    to other processes."""
+    return brs(A, E, SUM_CHUNKS, *step_range)
@@ -21,6 +21,9 @@ Fock representations
 
 This module contains the Fock representation of the standard Gaussian gates as well as their gradients.
 
+Every gate and gradient has a batched version, taking arrays of parameters and filling a
+preallocated array with one gate per parameter value, in parallel over the batch.
+
 Summary
 -------
 
@@ -35,30 +38,30 @@ Summary
 	grad_beamsplitter
 	grad_two_mode_squeezing
 	grad_mzgate
+	displacement_batch
+	squeezing_batch
+	beamsplitter_batch
+	two_mode_squeezing_batch
+	mzgate_batch
+	grad_displacement_batch
+	grad_squeezing_batch
+	grad_beamsplitter_batch
+	grad_two_mode_squeezing_batch
+	grad_mzgate_batch
 
 Code details
 ------------
 """
 import numpy as np
 
-from numba import jit
-
-
-@jit(nopython=True)
-def displacement(r, phi, cutoff, dtype=np.complex128):  # pragma: no cover
-    r"""Calculates the matrix elements of the displacement gate using a recurrence relation.
+from numba import jit, prange
 
-    Args:
-        r (float): displacement magnitude
-        phi (float): displacement angle
-        cutoff (int): Fock ladder cutoff
-        dtype (data type): Specifies the data type used for the calculation
 
-    Returns:
-        array[complex]: matrix representing the displacement operation.
-    """
-    D = np.zeros((cutoff, cutoff), dtype=dtype)
-    sqrt = np.sqrt(np.arange(cutoff, dtype=dtype))
+@jit(nopython=True, cache=True)
+def _displacement(r, phi, sqrt, D):  # pragma: no cover
+    """Fills the zero array ``D`` with the gate of :func:`displacement`, given the square roots
+    ``sqrt`` of the photon numbers."""
+    cutoff = D.shape[0]
     mu = np.array([r * np.exp(1j * phi), -r * np.exp(-1j * phi)])
 
     D[0, 0] = np.exp(-0.5 * r**2)
@@ -72,27 +75,33 @@ def displacement(r, phi, cutoff, dtype=np.complex128):  # pragma: no cover
     return D
 
 
-@jit(nopython=True)
-def grad_displacement(T, r, phi):  # pragma: no cover
-    r"""Calculates the gradients of the displacement gate with respect to the displacement magnitude and angle.
+@jit(nopython=True, cache=True)
+def displacement(r, phi, cutoff, dtype=np.complex128):  # pragma: no cover
+    r"""Calculates the matrix elements of the displacement gate using a recurrence relation.
 
     Args:
-        T (array[complex]): array representing the gate
         r (float): displacement magnitude
         phi (float): displacement angle
+        cutoff (int): Fock ladder cutoff
+        dtype (data type): Specifies the data type used for the calculation
 
     Returns:
-        tuple[array[complex], array[complex]]: The gradient of the displacement gate with respect to r and phi
+        array[complex]: matrix representing the displacement operation.
     """
+    D = np.zeros((cutoff, cutoff), dtype=dtype)
+    sqrt = np.sqrt(np.arange(cutoff, dtype=dtype))
+    return _displacement(r, phi, sqrt, D)
+
+
+@jit(nopython=True, cache=True)
+def _grad_displacement(T, r, phi, sqrt, grad_r, grad_phi):  # pragma: no cover
+    """Fills ``grad_r`` and ``grad_phi`` as done by :func:`grad_displacement`, given the square
+    roots ``sqrt`` of the photon numbers."""
     cutoff = T.shape[0]
-    dtype = T.dtype
     ei = np.exp(1j * phi)
     eic = np.exp(-1j * phi)
     alpha = r * ei
     alphac = r * eic
-    sqrt = np.sqrt(np.arange(cutoff, dtype=dtype))
-    grad_r = np.zeros((cutoff, cutoff), dtype=dtype)
-    grad_phi = np.zeros((cutoff, cutoff), dtype=dtype)
 
     for m in range(cutoff):
         for n in range(cutoff):
@@ -104,21 +113,31 @@ def grad_displacement(T, r, phi):  # pragma: no cover
     return grad_r, grad_phi
 
 
-@jit(nopython=True)
-def squeezing(r, theta, cutoff, dtype=np.complex128):  # pragma: no cover
-    r"""Calculates the matrix elements of the squeezing gate using a recurrence relation.
+@jit(nopython=True, cache=True)
+def grad_displacement(T, r, phi):  # pragma: no cover
+    r"""Calculates the gradients of the displacement gate with respect to the displacement magnitude and angle.
 
     Args:
-        r (float): squeezing magnitude
-        theta (float): squeezing angle
-        cutoff (int): Fock ladder cutoff
-        dtype (data type): Specifies the data type used for the calculation
+        T (array[complex]): array representing the gate
+        r (float): displacement magnitude
+        phi (float): displacement angle
 
     Returns:
-        array[complex]: matrix representing the squeezing gate.
+        tuple[array[complex], array[complex]]: The gradient of the displacement gate with respect to r and phi
     """
-    S = np.zeros((cutoff, cutoff), dtype=dtype)
+    cutoff = T.shape[0]
+    dtype = T.dtype
     sqrt = np.sqrt(np.arange(cutoff, dtype=dtype))
+    grad_r = np.zeros((cutoff, cutoff), dtype=dtype)
+    grad_phi = np.zeros((cutoff, cutoff), dtype=dtype)
+    return _grad_displacement(T, r, phi, sqrt, grad_r, grad_phi)
+
+
+@jit(nopython=True, cache=True)
+def _squeezing(r, theta, sqrt, S):  # pragma: no cover
+    """Fills the zero array ``S`` with the gate of :func:`squeezing`, given the square roots
+    ``sqrt`` of the photon numbers."""
+    cutoff = S.shape[0]
 
     eitheta_tanhr = np.exp(1j * theta) * np.tanh(r)
     sechr = 1.0 / np.cosh(r)
@@ -143,23 +162,29 @@ def squeezing(r, theta, cutoff, dtype=np.complex128):  # pragma: no cover
     return S
 
 
-@jit(nopython=True)
-def grad_squeezing(T, r, phi):  # pragma: no cover
-    r"""Calculates the gradients of the squeezing gate with respect to the squeezing magnitude and angle
+@jit(nopython=True, cache=True)
+def squeezing(r, theta, cutoff, dtype=np.complex128):  # pragma: no cover
+    r"""Calculates the matrix elements of the squeezing gate using a recurrence relation.
 
     Args:
-        T (array[complex]): array representing the gate
         r (float): squeezing magnitude
-        phi (float): squeezing angle
+        theta (float): squeezing angle
+        cutoff (int): Fock ladder cutoff
+        dtype (data type): Specifies the data type used for the calculation
 
     Returns:
-        tuple[array[complex], array[complex]]: The gradient of the squeezing gate with respect to the r and phi
+        array[complex]: matrix representing the squeezing gate.
     """
-    cutoff = T.shape[0]
-    dtype = T.dtype
+    S = np.zeros((cutoff, cutoff), dtype=dtype)
     sqrt = np.sqrt(np.arange(cutoff, dtype=dtype))
-    grad_r = np.zeros((cutoff, cutoff), dtype=dtype)
-    grad_phi = np.zeros((cutoff, cutoff), dtype=dtype)
+    return _squeezing(r, theta, sqrt, S)
+
+
+@jit(nopython=True, cache=True)
+def _grad_squeezing(T, r, phi, sqrt, grad_r, grad_phi):  # pragma: no cover
+    """Fills ``grad_r`` and ``grad_phi`` as done by :func:`grad_squeezing`, given the square
+    roots ``sqrt`` of the photon numbers."""
+    cutoff = T.shape[0]
 
     sechr = 1.0 / np.cosh(r)
     tanhr = np.tanh(r)
@@ -182,22 +207,31 @@ def grad_squeezing(T, r, phi):  # pragma: no cover
     return grad_r, grad_phi
 
 
-@jit(nopython=True)
-def two_mode_squeezing(r, theta, cutoff, dtype=np.complex128):  # pragma: no cover
-    """Calculates the matrix elements of the two-mode squeezing gate recursively.
+@jit(nopython=True, cache=True)
+def grad_squeezing(T, r, phi):  # pragma: no cover
+    r"""Calculates the gradients of the squeezing gate with respect to the squeezing magnitude and angle
 
     Args:
+        T (array[complex]): array representing the gate
         r (float): squeezing magnitude
-        theta (float): squeezing angle
-        cutoff (int): Fock ladder cutoff
-        dtype (data type): Specifies the data type used for the calculation
+        phi (float): squeezing angle
 
     Returns:
-        array[float]: The Fock representation of the gate
-
+        tuple[array[complex], array[complex]]: The gradient of the squeezing gate with respect to the r and phi
     """
+    cutoff = T.shape[0]
+    dtype = T.dtype
     sqrt = np.sqrt(np.arange(cutoff, dtype=dtype))
-    Z = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
+    grad_r = np.zeros((cutoff, cutoff), dtype=dtype)
+    grad_phi = np.zeros((cutoff, cutoff), dtype=dtype)
+    return _grad_squeezing(T, r, phi, sqrt, grad_r, grad_phi)
+
+
+@jit(nopython=True, cache=True)
+def _two_mode_squeezing(r, theta, sqrt, Z):  # pragma: no cover
+    """Fills the zero array ``Z`` with the gate of :func:`two_mode_squeezing`, given the square
+    roots ``sqrt`` of the photon numbers."""
+    cutoff = Z.shape[0]
 
     sc = 1.0 / np.cosh(r)
     eiptr = np.exp(-1j * theta) * np.tanh(r)
@@ -236,29 +270,34 @@ def two_mode_squeezing(r, theta, cutoff, dtype=np.complex128):  # pragma: no cov
     return Z
 
 
-@jit(nopython=True)
-def grad_two_mode_squeezing(T, r, theta):  # pragma: no cover
-    """Calculates the gradients of the two-mode squeezing gate with respect to the squeezing magnitude and angle
+@jit(nopython=True, cache=True)
+def two_mode_squeezing(r, theta, cutoff, dtype=np.complex128):  # pragma: no cover
+    """Calculates the matrix elements of the two-mode squeezing gate recursively.
 
     Args:
-        T (array[complex]): array representing the gate
         r (float): squeezing magnitude
         theta (float): squeezing angle
+        cutoff (int): Fock ladder cutoff
+        dtype (data type): Specifies the data type used for the calculation
 
     Returns:
-        tuple[array[complex], array[complex]]: The gradient of the two-mode squeezing gate with respect to r and phi
+        array[float]: The Fock representation of the gate
 
     """
+    sqrt = np.sqrt(np.arange(cutoff, dtype=dtype))
+    Z = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
+    return _two_mode_squeezing(r, theta, sqrt, Z)
+
+
+@jit(nopython=True, cache=True)
+def _grad_two_mode_squeezing(T, r, theta, sqrt, grad_r, grad_theta):  # pragma: no cover
+    """Fills ``grad_r`` and ``grad_theta`` as done by :func:`grad_two_mode_squeezing`, given the
+    square roots ``sqrt`` of the photon numbers."""
     cutoff = T.shape[0]
-    dtype = T.dtype
     sechr = 1.0 / np.cosh(r)
     tanhr = np.tanh(r)
     ei = np.exp(1j * theta)
     eic = np.exp(-1j * theta)
-    sqrt = np.sqrt(np.arange(cutoff, dtype=dtype))
-
-    grad_r = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
-    grad_theta = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
 
     grad_r[0, 0, 0, 0] = -sechr * tanhr
 
@@ -301,20 +340,32 @@ def grad_two_mode_squeezing(T, r, theta):  # pragma: no cover
     return grad_r, grad_theta
 
 
-@jit(nopython=True)
-def beamsplitter(theta, phi, cutoff, dtype=np.complex128):  # pragma: no cover
-    r"""Calculates the Fock representation of the beamsplitter.
+@jit(nopython=True, cache=True)
+def grad_two_mode_squeezing(T, r, theta):  # pragma: no cover
+    """Calculates the gradients of the two-mode squeezing gate with respect to the squeezing magnitude and angle
 
     Args:
-        theta (float): transmissivity angle of the beamsplitter. The transmissivity is :math:`t=\cos(\theta)`
-        phi (float): reflection phase of the beamsplitter
-        cutoff (int): Fock ladder cutoff
-        dtype (data type): Specifies the data type used for the calculation
+        T (array[complex]): array representing the gate
+        r (float): squeezing magnitude
+        theta (float): squeezing angle
 
     Returns:
-        array[float]: The Fock representation of the gate
+        tuple[array[complex], array[complex]]: The gradient of the two-mode squeezing gate with respect to r and phi
+
     """
+    cutoff = T.shape[0]
+    dtype = T.dtype
     sqrt = np.sqrt(np.arange(cutoff, dtype=dtype))
+    grad_r = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
+    grad_theta = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
+    return _grad_two_mode_squeezing(T, r, theta, sqrt, grad_r, grad_theta)
+
+
+@jit(nopython=True, cache=True)
+def _beamsplitter(theta, phi, sqrt, Z):  # pragma: no cover
+    """Fills the zero array ``Z`` with the gate of :func:`beamsplitter`, given the square roots
+    ``sqrt`` of the photon numbers."""
+    cutoff = Z.shape[0]
     ct = np.cos(theta)
     st = np.sin(theta) * np.exp(1j * phi)
     R = np.array(
@@ -326,7 +377,6 @@ def beamsplitter(theta, phi, cutoff, dtype=np.complex128):  # pragma: no cover
         ]
     )
 
-    Z = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
     Z[0, 0, 0, 0] = 1.0
 
     # rank 3
@@ -352,23 +402,29 @@ def beamsplitter(theta, phi, cutoff, dtype=np.complex128):  # pragma: no cover
     return Z
 
 
-@jit(nopython=True)
-def grad_beamsplitter(T, theta, phi):  # pragma: no cover
-    r"""Calculates the gradients of the beamsplitter gate with respect to the transmissivity angle and reflection phase
+@jit(nopython=True, cache=True)
+def beamsplitter(theta, phi, cutoff, dtype=np.complex128):  # pragma: no cover
+    r"""Calculates the Fock representation of the beamsplitter.
 
     Args:
-        T (array[complex]): array representing the gate
         theta (float): transmissivity angle of the beamsplitter. The transmissivity is :math:`t=\cos(\theta)`
         phi (float): reflection phase of the beamsplitter
+        cutoff (int): Fock ladder cutoff
+        dtype (data type): Specifies the data type used for the calculation
 
     Returns:
-        tuple[array[complex], array[complex]]: The gradient of the beamsplitter gate with respect to theta and phi
+        array[float]: The Fock representation of the gate
     """
-    cutoff = T.shape[0]
-    dtype = T.dtype
     sqrt = np.sqrt(np.arange(cutoff, dtype=dtype))
-    grad_theta = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
-    grad_phi = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
+    Z = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
+    return _beamsplitter(theta, phi, sqrt, Z)
+
+
+@jit(nopython=True, cache=True)
+def _grad_beamsplitter(T, theta, phi, sqrt, grad_theta, grad_phi):  # pragma: no cover
+    """Fills ``grad_theta`` and ``grad_phi`` as done by :func:`grad_beamsplitter`, given the
+    square roots ``sqrt`` of the photon numbers."""
+    cutoff = T.shape[0]
 
     ct = np.cos(theta)
     st = np.sin(theta)
@@ -405,20 +461,31 @@ def grad_beamsplitter(T, theta, phi):  # pragma: no cover
     return grad_theta, grad_phi
 
 
-@jit(nopython=True)
-def mzgate(theta, phi, cutoff, dtype=np.complex128):  # pragma: no cover
-    r"""Calculates the Fock representation of the Mach-Zehnder interferometer.
+@jit(nopython=True, cache=True)
+def grad_beamsplitter(T, theta, phi):  # pragma: no cover
+    r"""Calculates the gradients of the beamsplitter gate with respect to the transmissivity angle and reflection phase
 
     Args:
-        theta (float): internal phase of the Mach-Zehnder interferometer
-        phi (float): external phase of the Mach-Zehnder interferometer
-        cutoff (int): Fock ladder cutoff
-        dtype (data type): Specifies the data type used for the calculation
+        T (array[complex]): array representing the gate
+        theta (float): transmissivity angle of the beamsplitter. The transmissivity is :math:`t=\cos(\theta)`
+        phi (float): reflection phase of the beamsplitter
 
     Returns:
-        array[float]: The Fock representation of the gate
+        tuple[array[complex], array[complex]]: The gradient of the beamsplitter gate with respect to theta and phi
     """
+    cutoff = T.shape[0]
+    dtype = T.dtype
     sqrt = np.sqrt(np.arange(cutoff, dtype=dtype))
+    grad_theta = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
+    grad_phi = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
+    return _grad_beamsplitter(T, theta, phi, sqrt, grad_theta, grad_phi)
+
+
+@jit(nopython=True, cache=True)
+def _mzgate(theta, phi, sqrt, Z):  # pragma: no cover
+    """Fills the zero array ``Z`` with the gate of :func:`mzgate`, given the square roots
+    ``sqrt`` of the photon numbers."""
+    cutoff = Z.shape[0]
     v = np.exp(1j * theta)
     u = np.exp(1j * phi)
     R = 0.5 * np.array(
@@ -430,7 +497,6 @@ def mzgate(theta, phi, cutoff, dtype=np.complex128):  # pragma: no cover
         ]
     )
 
-    Z = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
     Z[0, 0, 0, 0] = 1.0
 
     # rank 3
@@ -456,23 +522,29 @@ def mzgate(theta, phi, cutoff, dtype=np.complex128):  # pragma: no cover
     return Z
 
 
-@jit(nopython=True)
-def grad_mzgate(T, theta, phi):  # pragma: no cover
-    r"""Calculates the gradients of the Mach-Zehnder interferometer with respect to the transmissivity angle and reflection phase
+@jit(nopython=True, cache=True)
+def mzgate(theta, phi, cutoff, dtype=np.complex128):  # pragma: no cover
+    r"""Calculates the Fock representation of the Mach-Zehnder interferometer.
 
     Args:
-        T (array[complex]): array representing the gate
-        theta (float): internal of the mzgate
-        phi (float): external phase of the mzgate
+        theta (float): internal phase of the Mach-Zehnder interferometer
+        phi (float): external phase of the Mach-Zehnder interferometer
+        cutoff (int): Fock ladder cutoff
+        dtype (data type): Specifies the data type used for the calculation
 
     Returns:
-        tuple[array[complex], array[complex]]: The gradient of the mzgate gate with respect to theta and phi
+        array[float]: The Fock representation of the gate
     """
-    cutoff = T.shape[0]
-    dtype = T.dtype
     sqrt = np.sqrt(np.arange(cutoff, dtype=dtype))
-    grad_theta = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
-    grad_phi = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
+    Z = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
+    return _mzgate(theta, phi, sqrt, Z)
+
+
+@jit(nopython=True, cache=True)
+def _grad_mzgate(T, theta, phi, sqrt, grad_theta, grad_phi):  # pragma: no cover
+    """Fills ``grad_theta`` and ``grad_phi`` as done by :func:`grad_mzgate`, given the square
+    roots ``sqrt`` of the photon numbers."""
+    cutoff = T.shape[0]
 
     v = np.exp(1j * theta)
     u = np.exp(1j * phi)
@@ -508,3 +580,266 @@ def grad_mzgate(T, theta, phi):  # pragma: no cover
                     ]
 
     return grad_theta, grad_phi
+
+
+@jit(nopython=True, cache=True)
+def grad_mzgate(T, theta, phi):  # pragma: no cover
+    r"""Calculates the gradients of the Mach-Zehnder interferometer with respect to the transmissivity angle and reflection phase
+
+    Args:
+        T (array[complex]): array representing the gate
+        theta (float): internal of the mzgate
+        phi (float): external phase of the mzgate
+
+    Returns:
+        tuple[array[complex], array[complex]]: The gradient of the mzgate gate with respect to theta and phi
+    """
+    cutoff = T.shape[0]
+    dtype = T.dtype
+    sqrt = np.sqrt(np.arange(cutoff, dtype=dtype))
+    grad_theta = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
+    grad_phi = np.zeros((cutoff, cutoff, cutoff, cutoff), dtype=dtype)
+    return _grad_mzgate(T, theta, phi, sqrt, grad_theta, grad_phi)
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def displacement_batch(r, phi, out):  # pragma: no cover
+    r"""Calculates the gates of :func:`displacement` for arrays of parameters, in parallel over the
+    batch, writing them into a preallocated array.
+
+    Args:
+        r (array[float]): displacement magnitudes, one per gate
+        phi (array[float]): displacement angles, one per gate
+        out (array[complex]): array overwritten by the gates, of shape
+            ``(B, cutoff, cutoff)``; its type is the data type used for the calculation
+
+    Returns:
+        array[complex]: the array ``out``
+    """
+    sqrt = np.sqrt(np.arange(out.shape[1], dtype=out.dtype))
+    for b in prange(len(r)):
+        out[b] = 0
+        _displacement(r[b], phi[b], sqrt, out[b])
+    return out
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def grad_displacement_batch(T, r, phi, grad_r, grad_phi):  # pragma: no cover
+    r"""Calculates the gradients of :func:`grad_displacement` for a batch of gates, in parallel over
+    the batch, writing them into preallocated arrays.
+
+    Args:
+        T (array[complex]): the gates, as returned by :func:`displacement_batch`
+        r (array[float]): displacement magnitudes, one per gate
+        phi (array[float]): displacement angles, one per gate
+        grad_r (array[complex]): array of the shape of ``T`` overwritten by the gradients with
+            respect to r
+        grad_phi (array[complex]): array of the shape of ``T`` overwritten by the gradients with
+            respect to phi
+
+    Returns:
+        tuple[array[complex], array[complex]]: the arrays ``grad_r`` and ``grad_phi``
+    """
+    sqrt = np.sqrt(np.arange(T.shape[1], dtype=T.dtype))
+    for b in prange(len(r)):
+        grad_r[b] = 0
+        grad_phi[b] = 0
+        _grad_displacement(T[b], r[b], phi[b], sqrt, grad_r[b], grad_phi[b])
+    return grad_r, grad_phi
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def squeezing_batch(r, theta, out):  # pragma: no cover
+    r"""Calculates the gates of :func:`squeezing` for arrays of parameters, in parallel over the
+    batch, writing them into a preallocated array.
+
+    Args:
+        r (array[float]): squeezing magnitudes, one per gate
+        theta (array[float]): squeezing angles, one per gate
+        out (array[complex]): array overwritten by the gates, of shape
+            ``(B, cutoff, cutoff)``; its type is the data type used for the calculation
+
+    Returns:
+        array[complex]: the array ``out``
+    """
+    sqrt = np.sqrt(np.arange(out.shape[1], dtype=out.dtype))
+    for b in prange(len(r)):
+        out[b] = 0
+        _squeezing(r[b], theta[b], sqrt, out[b])
+    return out
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def grad_squeezing_batch(T, r, phi, grad_r, grad_phi):  # pragma: no cover
+    r"""Calculates the gradients of :func:`grad_squeezing` for a batch of gates, in parallel over
+    the batch, writing them into preallocated arrays.
+
+    Args:
+        T (array[complex]): the gates, as returned by :func:`squeezing_batch`
+        r (array[float]): squeezing magnitudes, one per gate
+        phi (array[float]): squeezing angles, one per gate
+        grad_r (array[complex]): array of the shape of ``T`` overwritten by the gradients with
+            respect to r
+        grad_phi (array[complex]): array of the shape of ``T`` overwritten by the gradients with
+            respect to phi
+
+    Returns:
+        tuple[array[complex], array[complex]]: the arrays ``grad_r`` and ``grad_phi``
+    """
+    sqrt = np.sqrt(np.arange(T.shape[1], dtype=T.dtype))
+    for b in prange(len(r)):
+        grad_r[b] = 0
+        grad_phi[b] = 0
+        _grad_squeezing(T[b], r[b], phi[b], sqrt, grad_r[b], grad_phi[b])
+    return grad_r, grad_phi
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def two_mode_squeezing_batch(r, theta, out):  # pragma: no cover
+    r"""Calculates the gates of :func:`two_mode_squeezing` for arrays of parameters, in parallel
+    over the batch, writing them into a preallocated array.
+
+    Args:
+        r (array[float]): squeezing magnitudes, one per gate
+        theta (array[float]): squeezing angles, one per gate
+        out (array[complex]): array overwritten by the gates, of shape
+            ``(B, cutoff, cutoff, cutoff, cutoff)``; its type is the data type used for the
+            calculation
+
+    Returns:
+        array[complex]: the array ``out``
+    """
+    sqrt = np.sqrt(np.arange(out.shape[1], dtype=out.dtype))
+    for b in prange(len(r)):
+        out[b] = 0
+        _two_mode_squeezing(r[b], theta[b], sqrt, out[b])
+    return out
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def grad_two_mode_squeezing_batch(T, r, theta, grad_r, grad_theta):  # pragma: no cover
+    r"""Calculates the gradients of :func:`grad_two_mode_squeezing` for a batch of gates, in
+    parallel over the batch, writing them into preallocated arrays.
+
+    Args:
+        T (array[complex]): the gates, as returned by :func:`two_mode_squeezing_batch`
+        r (array[float]): squeezing magnitudes, one per gate
+        theta (array[float]): squeezing angles, one per gate
+        grad_r (array[complex]): array of the shape of ``T`` overwritten by the gradients with
+            respect to r
+        grad_theta (array[complex]): array of the shape of ``T`` overwritten by the gradients with
+            respect to theta
+
+    Returns:
+        tuple[array[complex], array[complex]]: the arrays ``grad_r`` and ``grad_theta``
+    """
+    sqrt = np.sqrt(np.arange(T.shape[1], dtype=T.dtype))
+    for b in prange(len(r)):
+        grad_r[b] = 0
+        grad_theta[b] = 0
+        _grad_two_mode_squeezing(T[b], r[b], theta[b], sqrt, grad_r[b], grad_theta[b])
+    return grad_r, grad_theta
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def beamsplitter_batch(theta, phi, out):  # pragma: no cover
+    r"""Calculates the gates of :func:`beamsplitter` for arrays of parameters, in parallel over the
+    batch, writing them into a preallocated array.
+
+    Args:
+        theta (array[float]): transmissivity angles, one per gate
+        phi (array[float]): reflection phases, one per gate
+        out (array[complex]): array overwritten by the gates, of shape
+            ``(B, cutoff, cutoff, cutoff, cutoff)``; its type is the data type used for the
+            calculation
+
+    Returns:
+        array[complex]: the array ``out``
+    """
+    sqrt = np.sqrt(np.arange(out.shape[1], dtype=out.dtype))
+    for b in prange(len(theta)):
+        out[b] = 0
+        _beamsplitter(theta[b], phi[b], sqrt, out[b])
+    return out
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def grad_beamsplitter_batch(T, theta, phi, grad_theta, grad_phi):  # pragma: no cover
+    r"""Calculates the gradients of :func:`grad_beamsplitter` for a batch of gates, in parallel over
+    the batch, writing them into preallocated arrays.
+
+    Args:
+        T (array[complex]): the gates, as returned by :func:`beamsplitter_batch`
+        theta (array[float]): transmissivity angles, one per gate
+        phi (array[float]): reflection phases, one per gate
+        grad_theta (array[complex]): array of the shape of ``T`` overwritten by the gradients with
+            respect to theta
+        grad_phi (array[complex]): array of the shape of ``T`` overwritten by the gradients with
+            respect to phi
+
+    Returns:
+        tuple[array[complex], array[complex]]: the arrays ``grad_theta`` and ``grad_phi``
+    """
+    sqrt = np.sqrt(np.arange(T.shape[1], dtype=T.dtype))
+    for b in prange(len(theta)):
+        grad_theta[b] = 0
+        grad_phi[b] = 0
+        _grad_beamsplitter(T[b], theta[b], phi[b], sqrt, grad_theta[b], grad_phi[b])
+    return grad_theta, grad_phi
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def mzgate_batch(theta, phi, out):  # pragma: no cover
+    r"""Calculates the gates of :func:`mzgate` for arrays of parameters, in parallel over the batch,
+    writing them into a preallocated array.
+
+    Args:
+        theta (array[float]): internal phases, one per gate
+        phi (array[float]): external phases, one per gate
+        out (array[complex]): array overwritten by the gates, of shape
+            ``(B, cutoff, cutoff, cutoff, cutoff)``; its type is the data type used for the
+            calculation
+
+    Returns:
+        array[complex]: the array ``out``
+    """
+    sqrt = np.sqrt(np.arange(out.shape[1], dtype=out.dtype))
+    for b in prange(len(theta)):
+        out[b] = 0
+        _mzgate(theta[b], phi[b], sqrt, out[b])
+    return out
+
+
+# pylint: disable=not-an-iterable
+@jit(nopython=True, parallel=True, cache=True)
+def grad_mzgate_batch(T, theta, phi, grad_theta, grad_phi):  # pragma: no cover
+    r"""Calculates the gradients of :func:`grad_mzgate` for a batch of gates, in parallel over the
+    batch, writing them into preallocated arrays.
+
+    Args:
+        T (array[complex]): the gates, as returned by :func:`mzgate_batch`
+        theta (array[float]): internal phases, one per gate
+        phi (array[float]): external phases, one per gate
+        grad_theta (array[complex]): array of the shape of ``T`` overwritten by the gradients with
+            respect to theta
+        grad_phi (array[complex]): array of the shape of ``T`` overwritten by the gradients with
+            respect to phi
+
+    Returns:
+        tuple[array[complex], array[complex]]: the arrays ``grad_theta`` and ``grad_phi``
+    """
+    sqrt = np.sqrt(np.arange(T.shape[1], dtype=T.dtype))
+    for b in prange(len(theta)):
+        grad_theta[b] = 0
+        grad_phi[b] = 0
+        _grad_mzgate(T[b], theta[b], phi[b], sqrt, grad_theta[b], grad_phi[b])
+    return grad_theta, grad_phi
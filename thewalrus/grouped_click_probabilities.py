@@ -1,62 +1,120 @@
 """Functions for computing grouped click probabilities"""
 import numpy as np
-from numba import jit
+from numba import jit, prange
+
+from .random import philox_normals
+
+# number of samples whose transfer matrix products are evaluated together
+CHUNK_SIZE = 256
+
+
+@jit(nopython=True, cache=True)
+def _click_distribution(no_click, out):  # pragma: no cover
+    r"""Distribution of the number of clicks of independent detectors, as the coefficients of
+    the polynomial :math:`\prod_i (p_i + z (1 - p_i))`, which the transform of its values at
+    the roots of unity would give back.
+
+    Args:
+        no_click (array): probability :math:`p_i` that each detector does not click
+        out (array): overwritten with the probability of each number of clicks
+    """
+    out[:] = 0
+    out[0] = 1
+    for i, p in enumerate(no_click):
+        for n in range(i + 1, 0, -1):
+            out[n] = out[n] * p + out[n - 1] * (1 - p)
+        out[0] *= p
 
 
 # pylint: disable=too-many-arguments
+@jit(nopython=True, cache=True)
+def _chunk_click_sums(drp, drm, t_rows, key0, key1, start, stop):  # pragma: no cover
+    """Sum of the click distributions of the samples of index ``start <= j < stop``.
+
+    Args:
+        drp (array): coefficients of the first normal variate of each input mode
+        drm (array): coefficients of the second normal variate of each input mode
+        t_rows (array): transpose of the transfer matrix
+        key0, key1 (int): 32-bit words of the key of the counter-based generator
+        start (int): index of the first sample
+        stop (int): one past the index of the last sample
+
+    Returns:
+        array: sum of the click distributions
+    """
+    num_input, num_modes = t_rows.shape
+    plus = np.empty((stop - start, num_input), dtype=np.complex128)
+    minus = np.empty((stop - start, num_input), dtype=np.complex128)
+    for j in range(start, stop):
+        for i in range(num_input):
+            wrp, wrm = philox_normals(key0, key1, j, i)
+            plus[j - start, i] = drp[i] * wrp + 1j * drm[i] * wrm
+            minus[j - start, i] = drp[i] * wrp - 1j * drm[i] * wrm
+    no_click = np.exp(-(plus @ t_rows) * (minus @ t_rows.conj()))
+    dist = np.empty(num_modes + 1, dtype=np.complex128)
+    sums = np.zeros(num_modes + 1, dtype=np.float64)
+    for j in range(stop - start):
+        _click_distribution(no_click[j], dist)
+        sums += dist.real
+    return sums
+
+
 # pylint: disable=too-many-locals
-@jit(nopython=True)
+@jit(nopython=True, parallel=True, cache=True)
 def grouped_click_probabilities(
-    phn, chn, t_matrix, num_samples, num_groups, seed=1990
+    phn, chn, t_matrix, num_samples, num_groups, seed=1990, chunk_size=CHUNK_SIZE
 ):  # pragma: no cover
     """Computes click probabilities and errors for input states sent into a lossy interferometer
+
+    The samples of each group are split into chunks evaluated in parallel, the transfer matrix
+    acting on all the samples of a chunk at once. As the random numbers of every sample only
+    depend on its index and the chunk sums are added in a fixed order, the result does not
+    depend on the number of threads. Changing the chunk size regroups the sums, so that the
+    result only agrees up to rounding.
+
     Args:
         phn (array): mean photon numbers of input modes
         chn (array): coherences of input modes
         t_matrix (array): transfer matrix
         num_samples (int): number of samples
         num_groups (int): number of groups into which the samples are divided for error computation
-        seed (int): seed of the random number generator
+        seed (int): 64-bit key of the counter-based generator; the random numbers of sample
+            ``j`` only depend on ``seed`` and ``j``
+        chunk_size (int): number of samples evaluated together
     Returns:
         tuple (prob, error): array of grouped click probabilities and array of corresponding errors
     """
-    np.random.seed(seed)
+    key0, key1 = seed & 0xFFFFFFFF, (seed >> 32) & 0xFFFFFFFF
     samp_per_group = num_samples // num_groups
     num_modes, num_input = max(t_matrix.shape), min(t_matrix.shape)
-    drp = np.array([(0.5 * np.complex128(phn[i] + chn[i])) ** 0.5 for i in range(num_input)])
-    drm = np.array([(0.5 * np.complex128(phn[i] - chn[i])) ** 0.5 for i in range(num_input)])
-    delta = 2 * np.pi / (num_modes + 1)
-    f_mat = np.asarray(
-        [
-            [(1 / (num_modes + 1)) * np.exp(1j * q * p * delta) for q in range(num_modes + 1)]
-            for p in range(num_modes + 1)
-        ]
-    )
-    acc = np.zeros(num_modes + 1, dtype=np.float64)
+    drp = np.sqrt(0.5 * (phn[:num_input] + chn[:num_input]) + 0j)
+    drm = np.sqrt(0.5 * (phn[:num_input] - chn[:num_input]) + 0j)
+    t_rows = np.ascontiguousarray(t_matrix.T.astype(np.complex128))
+
+    chunks_per_group = -(-samp_per_group // chunk_size)
+    sums = np.zeros((num_groups * chunks_per_group, num_modes + 1), dtype=np.float64)
+    # pylint: disable=not-an-iterable
+    for c in prange(num_groups * chunks_per_group):
+        group, chunk = c // chunks_per_group, c % chunks_per_group
+        start = group * samp_per_group + chunk * chunk_size
+        stop = min(start + chunk_size, (group + 1) * samp_per_group)
+        sums[c] = _chunk_click_sums(drp, drm, t_rows, key0, key1, start, stop)
+
     bcc = np.zeros(num_modes + 1, dtype=np.float64)
     qcc = np.zeros(num_modes + 1, dtype=np.float64)
-    fix = np.zeros(num_modes + 1, dtype=np.float64)
-    for j in range(num_samples):
-        wrp = np.array([np.random.normal() for _ in range(num_input)])
-        wrm = np.array([np.random.normal() for _ in range(num_input)])
-        alpha = t_matrix @ (drp * wrp + 1j * drm * wrm)
-        beta = t_matrix.conj() @ (drp * wrp - 1j * drm * wrm)
-        gth = np.empty(num_modes + 1, dtype=np.complex128)
-        for k in range(num_modes + 1):
-            gth[k] = np.prod(
-                np.exp(-alpha * beta) + np.exp(-1j * k * delta) * (1 - np.exp(-alpha * beta))
-            )
-        acc = acc + (f_mat @ gth).real
-        if (j + 1) % samp_per_group == 0:
-            bcc = bcc + (acc - fix) / samp_per_group
-            qcc = qcc + ((acc - fix) / samp_per_group) ** 2
-            fix = acc
+    for group in range(num_groups):
+        mean = np.zeros(num_modes + 1, dtype=np.float64)
+        for c in range(group * chunks_per_group, (group + 1) * chunks_per_group):
+            mean += sums[c]
+        mean /= samp_per_group
+        bcc = bcc + mean
+        qcc = qcc + mean**2
     return bcc / num_groups, (qcc / num_groups - (bcc / num_groups) ** 2) ** 0.5
 
 
-@jit(nopython=True)
+@jit(nopython=True, cache=True)
 def grouped_click_probabilities_squeezed(
-    input_sq, t_matrix, num_samples, num_groups, seed=1990
+    input_sq, t_matrix, num_samples, num_groups, seed=1990, chunk_size=CHUNK_SIZE
 ):  # pragma: no cover
     """Computes click probabilities for input squeezed states sent into a lossy interferometer
     Args:
@@ -64,10 +122,13 @@ def grouped_click_probabilities_squeezed(
         t_matrix (array): transfer matrix
         num_samples (int): number of samples
         num_groups (int): number of groups into which the samples are divided for error computation
-        seed (int): seed of the random number generator
+        seed (int): 64-bit key of the counter-based generator
+        chunk_size (int): number of samples evaluated together
     Returns:
         tuple (prob, error): array of grouped click probabilities and array of corresponding errors
     """
     phn = np.sinh(input_sq) ** 2
     chn = 0.5 * np.sinh(2 * input_sq)
-    return grouped_click_probabilities(phn, chn, t_matrix, num_samples, num_groups, seed)
+    return grouped_click_probabilities(
+        phn, chn, t_matrix, num_samples, num_groups, seed, chunk_size
+    )
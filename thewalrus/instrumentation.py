@@ -0,0 +1,221 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""
+Instrumentation
+===============
+
+**Module name:** :mod:`thewalrus.instrumentation`
+
+.. currentmodule:: thewalrus.instrumentation
+
+This submodule records, when it is enabled, the number of calls, the wall time and the number
+of steps of the main kernels of The Walrus, together with the time Numba spends compiling
+them. It is disabled by default, in which case an instrumented function only checks a flag
+before calling the kernel.
+
+The statistics are accumulated per kernel and returned by :func:`stats`. Each measurement is
+also passed to the ``sink`` given to :func:`enable`, which can forward it to a profiler or a
+metrics system:
+
+.. code-block:: python
+
+    with instrument(sink=lambda event: logger.info("%s", event)):
+        hafnian(A)
+    print(stats()["_haf"])
+
+A measurement is a dictionary with the name of the ``kernel`` and its ``kind``. A ``"call"``
+gives the ``wall_time`` of a call of an instrumented function and its number of ``steps``, the
+number of terms of the sum it evaluates. A ``"compile"`` gives the ``compile_time`` of a
+compilation of a Numba function, whose name is the qualified name of its Python function.
+The compilation times are also added to the instrumented calls during which they happen, so
+that the compilation and the evaluation of a kernel can be told apart.
+
+The kernels loaded from the Numba cache, for instance after :func:`~thewalrus.precompile`, are
+not compiled and do not give ``"compile"`` measurements.
+
+Summary
+-------
+
+.. autosummary::
+    enable
+    disable
+    enabled
+    instrument
+    stats
+    reset
+    instrumented
+
+Code details
+------------
+"""
+import functools
+import threading
+import time
+from contextlib import contextmanager
+
+from numba.core import event
+
+_lock = threading.Lock()
+_local = threading.local()
+_state = {"enabled": False, "sink": None, "stats": {}}
+
+
+def _record(kernel, kind, **values):
+    """Adds a measurement to the statistics of a kernel and passes it to the sink."""
+    with _lock:
+        record = _state["stats"].setdefault(
+            kernel,
+            {"calls": 0, "wall_time": 0.0, "steps": 0, "compilations": 0, "compile_time": 0.0},
+        )
+        if kind == "call":
+            record["calls"] += 1
+            record["wall_time"] += values["wall_time"]
+            record["steps"] += values["steps"]
+            record["compile_time"] += values["compile_time"]
+        else:
+            record["compilations"] += 1
+            record["compile_time"] += values["compile_time"]
+        sink = _state["sink"]
+    if sink is not None:
+        sink(dict(kernel=kernel, kind=kind, **values))
+
+
+def _active_calls():
+    """Compilation times of the instrumented calls running in the current thread."""
+    if not hasattr(_local, "calls"):
+        _local.calls = []
+        _local.compiles = []
+    return _local.calls
+
+
+class _CompileListener(event.Listener):
+    """Records the compilations of the Numba functions."""
+
+    def on_start(self, ev):
+        _active_calls()
+        _local.compiles.append(time.perf_counter())
+
+    def on_end(self, ev):
+        _active_calls()
+        if not _local.compiles:  # pragma: no cover
+            return
+        elapsed = time.perf_counter() - _local.compiles.pop()
+        if _local.compiles:
+            # a function compiled while compiling another one is counted in the outer one
+            return
+        for call in _local.calls:
+            call[0] += elapsed
+        py_func = ev.data["dispatcher"].py_func
+        _record(f"{py_func.__module__}.{py_func.__qualname__}", "compile", compile_time=elapsed)
+
+
+_listener = _CompileListener()
+
+
+def enable(sink=None):
+    """Enables the instrumentation.
+
+    Args:
+        sink (callable): function called with every measurement, as a dictionary
+    """
+    with _lock:
+        if not _state["enabled"]:
+            event.register("numba:compile", _listener)
+        _state["enabled"] = True
+        _state["sink"] = sink
+
+
+def disable():
+    """Disables the instrumentation. The statistics recorded are kept."""
+    with _lock:
+        if _state["enabled"]:
+            event.unregister("numba:compile", _listener)
+        _state["enabled"] = False
+        _state["sink"] = None
+
+
+def enabled():
+    """Whether the instrumentation is enabled.
+
+    Returns:
+        bool: ``True`` if it is enabled
+    """
+    return _state["enabled"]
+
+
+@contextmanager
+def instrument(sink=None):
+    """Context manager enabling the instrumentation inside its block.
+
+    Args:
+        sink (callable): function called with every measurement, as a dictionary
+    """
+    enable(sink)
+    try:
+        yield
+    finally:
+        disable()
+
+
+def stats():
+    """Statistics recorded for each kernel.
+
+    Returns:
+        dict[str, dict]: number of ``calls``, total ``wall_time``, total number of ``steps``,
+        number of ``compilations`` and total ``compile_time`` of each kernel, the times being in
+        seconds
+    """
+    with _lock:
+        return {kernel: dict(record) for kernel, record in _state["stats"].items()}
+
+
+def reset():
+    """Removes the statistics recorded."""
+    with _lock:
+        _state["stats"].clear()
+
+
+def instrumented(kernel, steps=None):
+    """Decorator recording the calls of a function when the instrumentation is enabled.
+
+    Args:
+        kernel (str): name under which the calls are recorded
+        steps (callable): function of the arguments of the decorated function returning the
+            number of steps of a call
+
+    Returns:
+        callable: the decorator
+    """
+
+    def decorator(f):
+        @functools.wraps(f)
+        def wrapper(*args, **kwargs):
+            if not _state["enabled"]:
+                return f(*args, **kwargs)
+            call = [0.0]
+            calls = _active_calls()
+            calls.append(call)
+            start = time.perf_counter()
+            try:
+                result = f(*args, **kwargs)
+            finally:
+                wall_time = time.perf_counter() - start
+                calls.pop()
+            steps_done = int(steps(*args, **kwargs)) if steps is not None else 0
+            _record(kernel, "call", wall_time=wall_time, steps=steps_done, compile_time=call[0])
+            return result
+
+        return wrapper
+
+    return decorator
@@ -36,18 +36,21 @@ Code details
 """
 import numpy as np
 import numba
+from thewalrus._summation import num_chunks, chunk_range
 from thewalrus._hafnian import (
     precompute_binoms,
     matched_reps,
-    find_kept_edges,
-    f_loop,
-    f_loop_odd,
-    get_submatrices,
-    get_submatrix_batch_odd0,
+    gray_code_start,
+    gray_code_next,
+    set_AX_edge,
+    set_VX_edge,
+    make_workspace,
+    f_loop_into,
+    f_loop_odd_into,
 )
 
 
-# pylint: disable = too-many-arguments, not-an-iterable
+# pylint: disable = too-many-arguments, not-an-iterable, too-many-locals
 @numba.jit(nopython=True, parallel=True, cache=True)
 def _calc_loop_hafnian_batch_even(
     A, D, fixed_edge_reps, batch_max, odd_cutoff, glynn=True
@@ -76,44 +79,73 @@ def _calc_loop_hafnian_batch_even(
     N_max = N_fixed + 2 * batch_max + odd_cutoff
 
     edge_reps = np.concatenate((np.array([batch_max]), fixed_edge_reps))
-    steps = np.prod(edge_reps + 1)
+    bases = edge_reps + 1
+    steps = np.prod(bases)
     # precompute binomial coefficients
     max_binom = edge_reps.max() + odd_cutoff
     binoms = precompute_binoms(max_binom)
 
-    H_batch = np.zeros(2 * batch_max + odd_cutoff + 1, dtype=np.complex128)
-    # prange to range
-    for j in numba.prange(steps):
-        Hnew = np.zeros(2 * batch_max + odd_cutoff + 1, dtype=np.complex128)
-
-        kept_edges = find_kept_edges(j, edge_reps)
-        edges_sum = kept_edges.sum()
-
-        binom_prod = 1.0
-        for i in range(1, n // 2):
-            binom_prod *= binoms[edge_reps[i], kept_edges[i]]
-
-        delta = 2 * kept_edges - edge_reps if glynn else kept_edges
-
-        AX_S, XD_S, D_S, oddVX_S = get_submatrices(delta, A, D, oddV)
-
-        AX_S_copy = AX_S.copy()
-
-        f_even = f_loop(AX_S_copy, AX_S, XD_S, D_S, N_max)
-        f_odd = f_loop_odd(AX_S_copy, AX_S, XD_S, D_S, N_max, oddloop, oddVX_S)
-
-        for N_det in range(2 * kept_edges[0], 2 * batch_max + odd_cutoff + 1):
-            N = N_fixed + N_det
-            plus_minus = (-1.0) ** (N // 2 - edges_sum)
-
-            n_det_binom_prod = binoms[N_det // 2, kept_edges[0]] * binom_prod
-
-            if N_det % 2 == 0:
-                Hnew[N_det] += n_det_binom_prod * plus_minus * f_even[N // 2]
-            else:
-                Hnew[N_det] += n_det_binom_prod * plus_minus * f_odd[N]
-
-        H_batch += Hnew
+    n_chunks = num_chunks(steps)
+    H_chunks = np.zeros((n_chunks, 2 * batch_max + odd_cutoff + 1), dtype=np.complex128)
+
+    for c in numba.prange(n_chunks):
+        start, stop = chunk_range(c, n_chunks, steps)
+        digits, kept_edges, direction = gray_code_start(start, bases)
+
+        AX_S = np.empty((n, n), dtype=np.complex128)
+        XD_S = np.empty(n, dtype=np.complex128)
+        oddVX_S = np.empty(n, dtype=np.complex128)
+        comb, powtrace, mats, vecs, loop_vecs = make_workspace(AX_S, N_max)
+        # the even and odd coefficients are used together, so they need separate tables
+        comb_odd = np.zeros_like(comb)
+        for i in range(n // 2):
+            delta = 2 * kept_edges[i] - edge_reps[i] if glynn else kept_edges[i]
+            set_AX_edge(i, delta, A, AX_S)
+            set_VX_edge(i, delta, D, XD_S)
+            set_VX_edge(i, delta, oddV, oddVX_S)
+
+        for j in range(start, stop):
+            if j > start:
+                i = gray_code_next(digits, kept_edges, direction, bases)
+                delta = 2 * kept_edges[i] - edge_reps[i] if glynn else kept_edges[i]
+                set_AX_edge(i, delta, A, AX_S)
+                set_VX_edge(i, delta, D, XD_S)
+                set_VX_edge(i, delta, oddV, oddVX_S)
+
+            edges_sum = kept_edges.sum()
+
+            binom_prod = 1.0
+            for i in range(1, n // 2):
+                binom_prod *= binoms[edge_reps[i], kept_edges[i]]
+
+            f_even = f_loop_into(AX_S, AX_S, XD_S, D, N_max, comb, powtrace, mats, vecs, loop_vecs)
+            f_odd = f_loop_odd_into(
+                AX_S,
+                AX_S,
+                XD_S,
+                D,
+                N_max,
+                oddloop,
+                oddVX_S,
+                comb_odd,
+                powtrace,
+                mats,
+                vecs,
+                loop_vecs,
+            )
+
+            for N_det in range(2 * kept_edges[0], 2 * batch_max + odd_cutoff + 1):
+                N = N_fixed + N_det
+                plus_minus = (-1.0) ** (N // 2 - edges_sum)
+
+                n_det_binom_prod = binoms[N_det // 2, kept_edges[0]] * binom_prod
+
+                if N_det % 2 == 0:
+                    H_chunks[c, N_det] += n_det_binom_prod * plus_minus * f_even[N // 2]
+                else:
+                    H_chunks[c, N_det] += n_det_binom_prod * plus_minus * f_odd[N]
+
+    H_batch = H_chunks.sum(axis=0)
 
     if glynn:
         for j in range(H_batch.shape[0]):
@@ -123,7 +155,7 @@ def _calc_loop_hafnian_batch_even(
     return H_batch
 
 
-# pylint: disable = too-many-arguments, not-an-iterable
+# pylint: disable = too-many-arguments, not-an-iterable, too-many-locals
 @numba.jit(nopython=True, parallel=True, cache=True)
 def _calc_loop_hafnian_batch_odd(
     A, D, fixed_edge_reps, batch_max, even_cutoff, glynn=True
@@ -156,49 +188,94 @@ def _calc_loop_hafnian_batch_odd(
     N_max = N_fixed + 2 * batch_max + even_cutoff + 1
 
     edge_reps = np.concatenate((np.array([batch_max, 1]), fixed_edge_reps))
-    steps = np.prod(edge_reps + 1)
+    bases = edge_reps + 1
+    steps = np.prod(bases)
     # precompute binomial coefficients
     max_binom = edge_reps.max() + even_cutoff
     binoms = precompute_binoms(max_binom)
 
-    H_batch = np.zeros(2 * batch_max + even_cutoff + 2, dtype=np.complex128)
-    for j in numba.prange(steps):
-        Hnew = np.zeros(2 * batch_max + even_cutoff + 2, dtype=np.complex128)
-
-        kept_edges = find_kept_edges(j, edge_reps)
-        edges_sum = kept_edges.sum()
-
-        binom_prod = 1.0
-        for i in range(1, n // 2):
-            binom_prod *= binoms[edge_reps[i], kept_edges[i]]
-
-        delta = 2 * kept_edges - edge_reps if glynn else kept_edges
-
-        AX_S, XD_S, D_S, oddVX_S = get_submatrices(delta, A, D, oddV)
-
-        AX_S_copy = AX_S.copy()
-
-        if kept_edges[0] == 0 and kept_edges[1] == 0:
-            oddVX_S0 = get_submatrix_batch_odd0(delta, oddV0)
-            plus_minus = (-1) ** (N_fixed // 2 - edges_sum)
-            f = f_loop_odd(AX_S_copy, AX_S, XD_S, D_S, N_fixed, oddloop0, oddVX_S0)[N_fixed]
-            H_batch[0] += binom_prod * plus_minus * f
-
-        f_even = f_loop(AX_S_copy, AX_S, XD_S, D_S, N_max)
-        f_odd = f_loop_odd(AX_S_copy, AX_S, XD_S, D_S, N_max, oddloop, oddVX_S)
-
-        for N_det in range(2 * kept_edges[0] + 1, 2 * batch_max + even_cutoff + 2):
-            N = N_fixed + N_det
-            plus_minus = (-1) ** (N // 2 - edges_sum)
-
-            n_det_binom_prod = binoms[(N_det - 1) // 2, kept_edges[0]] * binom_prod
-
-            if N % 2 == 0:
-                Hnew[N_det] += n_det_binom_prod * plus_minus * f_even[N // 2]
-            else:
-                Hnew[N_det] += n_det_binom_prod * plus_minus * f_odd[N]
-
-        H_batch += Hnew
+    n_chunks = num_chunks(steps)
+    H_chunks = np.zeros((n_chunks, 2 * batch_max + even_cutoff + 2), dtype=np.complex128)
+
+    for c in numba.prange(n_chunks):
+        start, stop = chunk_range(c, n_chunks, steps)
+        digits, kept_edges, direction = gray_code_start(start, bases)
+
+        AX_S = np.empty((n, n), dtype=np.complex128)
+        XD_S = np.empty(n, dtype=np.complex128)
+        oddVX_S = np.empty(n, dtype=np.complex128)
+        comb, powtrace, mats, vecs, loop_vecs = make_workspace(AX_S, N_max)
+        # the even and odd coefficients are used together, so they need separate tables
+        comb_odd = np.zeros_like(comb)
+        oddVX_S0 = np.empty(n, dtype=np.complex128)
+        for i in range(n // 2):
+            delta = 2 * kept_edges[i] - edge_reps[i] if glynn else kept_edges[i]
+            set_AX_edge(i, delta, A, AX_S)
+            set_VX_edge(i, delta, D, XD_S)
+            set_VX_edge(i, delta, oddV, oddVX_S)
+            set_VX_edge(i, delta, oddV0, oddVX_S0)
+
+        for j in range(start, stop):
+            if j > start:
+                i = gray_code_next(digits, kept_edges, direction, bases)
+                delta = 2 * kept_edges[i] - edge_reps[i] if glynn else kept_edges[i]
+                set_AX_edge(i, delta, A, AX_S)
+                set_VX_edge(i, delta, D, XD_S)
+                set_VX_edge(i, delta, oddV, oddVX_S)
+                set_VX_edge(i, delta, oddV0, oddVX_S0)
+
+            edges_sum = kept_edges.sum()
+
+            binom_prod = 1.0
+            for i in range(1, n // 2):
+                binom_prod *= binoms[edge_reps[i], kept_edges[i]]
+
+            if kept_edges[0] == 0 and kept_edges[1] == 0:
+                plus_minus = (-1) ** (N_fixed // 2 - edges_sum)
+                f = f_loop_odd_into(
+                    AX_S,
+                    AX_S,
+                    XD_S,
+                    D,
+                    N_fixed,
+                    oddloop0,
+                    oddVX_S0,
+                    comb,
+                    powtrace,
+                    mats,
+                    vecs,
+                    loop_vecs,
+                )[N_fixed]
+                H_chunks[c, 0] += binom_prod * plus_minus * f
+
+            f_even = f_loop_into(AX_S, AX_S, XD_S, D, N_max, comb, powtrace, mats, vecs, loop_vecs)
+            f_odd = f_loop_odd_into(
+                AX_S,
+                AX_S,
+                XD_S,
+                D,
+                N_max,
+                oddloop,
+                oddVX_S,
+                comb_odd,
+                powtrace,
+                mats,
+                vecs,
+                loop_vecs,
+            )
+
+            for N_det in range(2 * kept_edges[0] + 1, 2 * batch_max + even_cutoff + 2):
+                N = N_fixed + N_det
+                plus_minus = (-1) ** (N // 2 - edges_sum)
+
+                n_det_binom_prod = binoms[(N_det - 1) // 2, kept_edges[0]] * binom_prod
+
+                if N % 2 == 0:
+                    H_chunks[c, N_det] += n_det_binom_prod * plus_minus * f_even[N // 2]
+                else:
+                    H_chunks[c, N_det] += n_det_binom_prod * plus_minus * f_odd[N]
+
+    H_batch = H_chunks.sum(axis=0)
 
     if glynn:
         for j in range(H_batch.shape[0]):
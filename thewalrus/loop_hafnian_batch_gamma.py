@@ -28,6 +28,7 @@ Summary
     _calc_loop_hafnian_batch_gamma_even
     _calc_loop_hafnian_batch_gamma_odd
     loop_hafnian_batch_gamma
+    LoopHafnianBatchContext
 
 Code details
 ------------
@@ -35,20 +36,27 @@ Code details
 import numpy as np
 import numba
 from numba import prange
+from thewalrus._summation import num_chunks, chunk_range
 from thewalrus._hafnian import (
     precompute_binoms,
     matched_reps,
-    find_kept_edges,
-    f_loop,
-    f_loop_odd,
-    get_submatrices,
-    get_submatrix_batch_odd0,
-    get_Dsubmatrices,
+    gray_code_start,
+    gray_code_next,
+    set_AX_edge,
+    set_VX_edge,
+    make_workspace,
+    f_loop_into,
+    f_loop_odd_into,
+)
+from thewalrus.loop_hafnian_batch import (
+    add_batch_edges_odd,
+    add_batch_edges_even,
+    _calc_loop_hafnian_batch_even,
+    _calc_loop_hafnian_batch_odd,
 )
-from thewalrus.loop_hafnian_batch import add_batch_edges_odd, add_batch_edges_even
 
 
-# pylint: disable = too-many-arguments, not-an-iterable
+# pylint: disable = too-many-arguments, not-an-iterable, too-many-locals
 @numba.jit(nopython=True, cache=True, parallel=True)
 def _calc_loop_hafnian_batch_gamma_even(
     A, D, fixed_edge_reps, batch_max, odd_cutoff, glynn=True
@@ -77,47 +85,79 @@ def _calc_loop_hafnian_batch_gamma_even(
     N_max = N_fixed + 2 * batch_max + odd_cutoff
 
     edge_reps = np.concatenate((np.array([batch_max]), fixed_edge_reps))
-    steps = np.prod(edge_reps + 1)
+    bases = edge_reps + 1
+    steps = np.prod(bases)
     # precompute binomial coefficients
     max_binom = edge_reps.max() + odd_cutoff
     binoms = precompute_binoms(max_binom)
     n_D = D.shape[0]
 
-    H_batch = np.zeros((n_D, 2 * batch_max + odd_cutoff + 1), dtype=np.complex128)
-
-    for j in prange(steps):
-        Hnew = np.zeros((n_D, 2 * batch_max + odd_cutoff + 1), dtype=np.complex128)
-
-        kept_edges = find_kept_edges(j, edge_reps)
-        edges_sum = kept_edges.sum()
-
-        binom_prod = 1.0
-        for i in range(1, n // 2):
-            binom_prod *= binoms[edge_reps[i], kept_edges[i]]
-
-        delta = 2 * kept_edges - edge_reps if glynn else kept_edges
-
-        AX_S, XD_S, D_S, oddVX_S = get_submatrices(delta, A, D[0, :], oddV)
-
-        AX_S_copy = AX_S.copy()
-
-        for k in range(n_D):
-            XD_S, D_S = get_Dsubmatrices(delta, D[k, :])
-
-            f_even = f_loop(AX_S_copy, AX_S, XD_S, D_S, N_max)
-            f_odd = f_loop_odd(AX_S_copy, AX_S, XD_S, D_S, N_max, oddloop[k], oddVX_S)
-
-            for N_det in range(2 * kept_edges[0], 2 * batch_max + odd_cutoff + 1):
-                N = N_fixed + N_det
-                plus_minus = (-1.0) ** (N // 2 - edges_sum)
-
-                n_det_binom_prod = binoms[N_det // 2, kept_edges[0]] * binom_prod
-
-                if N_det % 2 == 0:
-                    Hnew[k, N_det] += n_det_binom_prod * plus_minus * f_even[N // 2]
-                else:
-                    Hnew[k, N_det] += n_det_binom_prod * plus_minus * f_odd[N]
-        H_batch += Hnew
+    n_chunks = num_chunks(steps)
+    H_chunks = np.zeros((n_chunks, n_D, 2 * batch_max + odd_cutoff + 1), dtype=np.complex128)
+
+    for c in prange(n_chunks):
+        start, stop = chunk_range(c, n_chunks, steps)
+        digits, kept_edges, direction = gray_code_start(start, bases)
+
+        AX_S = np.empty((n, n), dtype=np.complex128)
+        XD_S = np.empty((n_D, n), dtype=np.complex128)
+        oddVX_S = np.empty(n, dtype=np.complex128)
+        comb, powtrace, mats, vecs, loop_vecs = make_workspace(AX_S, N_max)
+        # the even and odd coefficients are used together, so they need separate tables
+        comb_odd = np.zeros_like(comb)
+        for i in range(n // 2):
+            delta = 2 * kept_edges[i] - edge_reps[i] if glynn else kept_edges[i]
+            set_AX_edge(i, delta, A, AX_S)
+            set_VX_edge(i, delta, oddV, oddVX_S)
+            for k in range(n_D):
+                set_VX_edge(i, delta, D[k], XD_S[k])
+
+        for j in range(start, stop):
+            if j > start:
+                i = gray_code_next(digits, kept_edges, direction, bases)
+                delta = 2 * kept_edges[i] - edge_reps[i] if glynn else kept_edges[i]
+                set_AX_edge(i, delta, A, AX_S)
+                set_VX_edge(i, delta, oddV, oddVX_S)
+                for k in range(n_D):
+                    set_VX_edge(i, delta, D[k], XD_S[k])
+
+            edges_sum = kept_edges.sum()
+
+            binom_prod = 1.0
+            for i in range(1, n // 2):
+                binom_prod *= binoms[edge_reps[i], kept_edges[i]]
+
+            for k in range(n_D):
+                f_even = f_loop_into(
+                    AX_S, AX_S, XD_S[k], D[k], N_max, comb, powtrace, mats, vecs, loop_vecs
+                )
+                f_odd = f_loop_odd_into(
+                    AX_S,
+                    AX_S,
+                    XD_S[k],
+                    D[k],
+                    N_max,
+                    oddloop[k],
+                    oddVX_S,
+                    comb_odd,
+                    powtrace,
+                    mats,
+                    vecs,
+                    loop_vecs,
+                )
+
+                for N_det in range(2 * kept_edges[0], 2 * batch_max + odd_cutoff + 1):
+                    N = N_fixed + N_det
+                    plus_minus = (-1.0) ** (N // 2 - edges_sum)
+
+                    n_det_binom_prod = binoms[N_det // 2, kept_edges[0]] * binom_prod
+
+                    if N_det % 2 == 0:
+                        H_chunks[c, k, N_det] += n_det_binom_prod * plus_minus * f_even[N // 2]
+                    else:
+                        H_chunks[c, k, N_det] += n_det_binom_prod * plus_minus * f_odd[N]
+
+    H_batch = H_chunks.sum(axis=0)
 
     if glynn:
         for j in range(H_batch.shape[1]):
@@ -127,7 +167,7 @@ def _calc_loop_hafnian_batch_gamma_even(
     return H_batch
 
 
-# pylint: disable = too-many-arguments, not-an-iterable
+# pylint: disable = too-many-arguments, not-an-iterable, too-many-locals
 @numba.jit(nopython=True, cache=True, parallel=True)
 def _calc_loop_hafnian_batch_gamma_odd(
     A, D, fixed_edge_reps, batch_max, even_cutoff, glynn=True
@@ -163,53 +203,99 @@ def _calc_loop_hafnian_batch_gamma_odd(
     n_D = D.shape[0]
 
     edge_reps = np.concatenate((np.array([batch_max, 1]), fixed_edge_reps))
-    steps = np.prod(edge_reps + 1)
+    bases = edge_reps + 1
+    steps = np.prod(bases)
     # precompute binomial coefficients
     max_binom = edge_reps.max() + even_cutoff
     binoms = precompute_binoms(max_binom)
 
-    H_batch = np.zeros((n_D, 2 * batch_max + even_cutoff + 2), dtype=np.complex128)
-    # for j in range(rank, steps, size):
-    for j in prange(steps):
-        Hnew = np.zeros((n_D, 2 * batch_max + even_cutoff + 2), dtype=np.complex128)
-
-        kept_edges = find_kept_edges(j, edge_reps)
-        edges_sum = kept_edges.sum()
-
-        binom_prod = 1.0
-        for i in range(1, n // 2):
-            binom_prod *= binoms[edge_reps[i], kept_edges[i]]
-
-        delta = 2 * kept_edges - edge_reps if glynn else kept_edges
-
-        AX_S, XD_S, D_S, oddVX_S = get_submatrices(delta, A, D[0, :], oddV)
-
-        AX_S_copy = AX_S.copy()
-
-        for k in range(n_D):
-            XD_S, D_S = get_Dsubmatrices(delta, D[k, :])
-
-            if kept_edges[0] == 0 and kept_edges[1] == 0:
-                oddVX_S0 = get_submatrix_batch_odd0(delta, oddV0)
-                plus_minus = (-1) ** (N_fixed // 2 - edges_sum)
-                f = f_loop_odd(AX_S_copy, AX_S, XD_S, D_S, N_fixed, oddloop0[k], oddVX_S0)[N_fixed]
-                Hnew[k, 0] += binom_prod * plus_minus * f
-
-            f_even = f_loop(AX_S_copy, AX_S, XD_S, D_S, N_max)
-            f_odd = f_loop_odd(AX_S_copy, AX_S, XD_S, D_S, N_max, oddloop[k], oddVX_S)
-
-            for N_det in range(2 * kept_edges[0] + 1, 2 * batch_max + even_cutoff + 2):
-                N = N_fixed + N_det
-                plus_minus = (-1) ** (N // 2 - edges_sum)
-
-                n_det_binom_prod = binoms[(N_det - 1) // 2, kept_edges[0]] * binom_prod
-
-                if N % 2 == 0:
-                    Hnew[k, N_det] += n_det_binom_prod * plus_minus * f_even[N // 2]
-                else:
-                    Hnew[k, N_det] += n_det_binom_prod * plus_minus * f_odd[N]
-
-        H_batch += Hnew
+    n_chunks = num_chunks(steps)
+    H_chunks = np.zeros((n_chunks, n_D, 2 * batch_max + even_cutoff + 2), dtype=np.complex128)
+
+    for c in prange(n_chunks):
+        start, stop = chunk_range(c, n_chunks, steps)
+        digits, kept_edges, direction = gray_code_start(start, bases)
+
+        AX_S = np.empty((n, n), dtype=np.complex128)
+        XD_S = np.empty((n_D, n), dtype=np.complex128)
+        oddVX_S = np.empty(n, dtype=np.complex128)
+        comb, powtrace, mats, vecs, loop_vecs = make_workspace(AX_S, N_max)
+        # the even and odd coefficients are used together, so they need separate tables
+        comb_odd = np.zeros_like(comb)
+        oddVX_S0 = np.empty(n, dtype=np.complex128)
+        for i in range(n // 2):
+            delta = 2 * kept_edges[i] - edge_reps[i] if glynn else kept_edges[i]
+            set_AX_edge(i, delta, A, AX_S)
+            set_VX_edge(i, delta, oddV, oddVX_S)
+            set_VX_edge(i, delta, oddV0, oddVX_S0)
+            for k in range(n_D):
+                set_VX_edge(i, delta, D[k], XD_S[k])
+
+        for j in range(start, stop):
+            if j > start:
+                i = gray_code_next(digits, kept_edges, direction, bases)
+                delta = 2 * kept_edges[i] - edge_reps[i] if glynn else kept_edges[i]
+                set_AX_edge(i, delta, A, AX_S)
+                set_VX_edge(i, delta, oddV, oddVX_S)
+                set_VX_edge(i, delta, oddV0, oddVX_S0)
+                for k in range(n_D):
+                    set_VX_edge(i, delta, D[k], XD_S[k])
+
+            edges_sum = kept_edges.sum()
+
+            binom_prod = 1.0
+            for i in range(1, n // 2):
+                binom_prod *= binoms[edge_reps[i], kept_edges[i]]
+
+            for k in range(n_D):
+                if kept_edges[0] == 0 and kept_edges[1] == 0:
+                    plus_minus = (-1) ** (N_fixed // 2 - edges_sum)
+                    f = f_loop_odd_into(
+                        AX_S,
+                        AX_S,
+                        XD_S[k],
+                        D[k],
+                        N_fixed,
+                        oddloop0[k],
+                        oddVX_S0,
+                        comb,
+                        powtrace,
+                        mats,
+                        vecs,
+                        loop_vecs,
+                    )[N_fixed]
+                    H_chunks[c, k, 0] += binom_prod * plus_minus * f
+
+                f_even = f_loop_into(
+                    AX_S, AX_S, XD_S[k], D[k], N_max, comb, powtrace, mats, vecs, loop_vecs
+                )
+                f_odd = f_loop_odd_into(
+                    AX_S,
+                    AX_S,
+                    XD_S[k],
+                    D[k],
+                    N_max,
+                    oddloop[k],
+                    oddVX_S,
+                    comb_odd,
+                    powtrace,
+                    mats,
+                    vecs,
+                    loop_vecs,
+                )
+
+                for N_det in range(2 * kept_edges[0] + 1, 2 * batch_max + even_cutoff + 2):
+                    N = N_fixed + N_det
+                    plus_minus = (-1) ** (N // 2 - edges_sum)
+
+                    n_det_binom_prod = binoms[(N_det - 1) // 2, kept_edges[0]] * binom_prod
+
+                    if N % 2 == 0:
+                        H_chunks[c, k, N_det] += n_det_binom_prod * plus_minus * f_even[N // 2]
+                    else:
+                        H_chunks[c, k, N_det] += n_det_binom_prod * plus_minus * f_odd[N]
+
+    H_batch = H_chunks.sum(axis=0)
 
     if glynn:
         for j in range(H_batch.shape[1]):
@@ -267,3 +353,94 @@ def loop_hafnian_batch_gamma(A, D, fixed_reps, N_cutoff, glynn=True):
     return _calc_loop_hafnian_batch_gamma_odd(
         Ax, Dx, fixed_m_reps, batch_max, even_cutoff, glynn=glynn
     )
+
+
+class LoopHafnianBatchContext:
+    r"""Loop hafnian batches of the leading submatrices of a fixed matrix, as evaluated at every
+    mode of the chain-rule samplers.
+
+    The loop hafnian batch of the leading ``m`` modes only depends on the matrix through the
+    pattern of fixed repetitions of the first ``m - 1`` modes. The gather of the rows and
+    columns kept, the pairing of the repeated modes by :func:`~thewalrus._hafnian.matched_reps`
+    and the batch edges are therefore prepared once per pattern and reused by every chain, and
+    every later call, that reaches the same pattern; only the vector ``D`` is gathered at every
+    call. The results are those of :func:`~thewalrus.loop_hafnian_batch.loop_hafnian_batch`
+    and :func:`loop_hafnian_batch_gamma`.
+
+    Args:
+        A (array): the full matrix, whose leading submatrices are used
+        N_cutoff (int): max number of photons of the last mode
+        glynn (boolean): determines the method used to evaluate the loop hafnian batch.
+        max_patterns (int): number of prepared patterns kept, the oldest being discarded first
+    """
+
+    def __init__(self, A, N_cutoff, glynn=True, max_patterns=4096):
+        self.A = np.asarray(A, dtype=np.complex128)
+        self.N_cutoff = N_cutoff
+        self.glynn = glynn
+        self.max_patterns = max_patterns
+        self._prepared = {}
+
+    def prepare(self, fixed_reps):
+        """Prepares the evaluation of the loop hafnian batch of a pattern of fixed repetitions.
+
+        Args:
+            fixed_reps (array): fixed number of repetitions of the first ``m - 1`` modes
+
+        Returns:
+            tuple: indices of the rows gathered, gathered matrix, repetitions of the matched
+            edges, whether there is no unpaired mode, and the batch bounds of the kernel
+        """
+        key = tuple(int(r) for r in fixed_reps)
+        prepared = self._prepared.get(key)
+        if prepared is not None:
+            return prepared
+
+        fixed_reps = np.asarray(key, dtype=int)
+        nz = np.nonzero(list(key) + [1])[0]
+        fixed_edges, fixed_m_reps, oddmode = matched_reps(fixed_reps[nz[:-1]])
+        if oddmode is None:
+            edges = add_batch_edges_even(fixed_edges)
+            bounds = (self.N_cutoff // 2, self.N_cutoff % 2)
+        else:
+            edges = add_batch_edges_odd(fixed_edges, oddmode)
+            bounds = ((self.N_cutoff - 1) // 2, 1 - (self.N_cutoff % 2))
+        index = nz[edges]
+        prepared = (index, self.A[np.ix_(index, index)], fixed_m_reps, oddmode is None, bounds)
+
+        if len(self._prepared) >= self.max_patterns:
+            del self._prepared[next(iter(self._prepared))]
+        self._prepared[key] = prepared
+        return prepared
+
+    def batch(self, D, fixed_reps):
+        """Loop hafnian batch of a single vector, as returned by
+        :func:`~thewalrus.loop_hafnian_batch.loop_hafnian_batch`.
+
+        Args:
+            D (array): diagonal, of at least ``len(fixed_reps) + 1`` entries
+            fixed_reps (array): fixed number of repetitions of the first ``m - 1`` modes
+
+        Returns:
+            array: loop hafnian for every photon number of mode ``m``
+        """
+        index, Ax, reps, even, bounds = self.prepare(fixed_reps)
+        kernel = _calc_loop_hafnian_batch_even if even else _calc_loop_hafnian_batch_odd
+        Dx = np.asarray(D, dtype=np.complex128)[index]
+        return kernel(Ax, Dx, reps, *bounds, glynn=self.glynn)
+
+    def batch_gamma(self, D, fixed_reps):
+        """Loop hafnian batches of several vectors, as returned by
+        :func:`loop_hafnian_batch_gamma`.
+
+        Args:
+            D (array): one diagonal per row, of at least ``len(fixed_reps) + 1`` entries
+            fixed_reps (array): fixed number of repetitions of the first ``m - 1`` modes
+
+        Returns:
+            array: loop hafnian for every vector and every photon number of mode ``m``
+        """
+        index, Ax, reps, even, bounds = self.prepare(fixed_reps)
+        kernel = _calc_loop_hafnian_batch_gamma_even if even else _calc_loop_hafnian_batch_gamma_odd
+        Dx = np.ascontiguousarray(np.asarray(D, dtype=np.complex128)[:, index])
+        return kernel(Ax, Dx, reps, *bounds, glynn=self.glynn)
@@ -17,10 +17,13 @@ through an interferometer.
 """
 
 import numpy as np
+
+from thewalrus.random import sample_streams, seed_sequence
+
 from .photon_number_distributions import _squeezed_state_distribution
 
 
-def sample(T, rs, n_samples=100, input_cutoff=50):
+def sample(T, rs, n_samples=100, input_cutoff=50, rng=None):
     """
     Calculates a resultant photon number samples when distinguishable squeezers are sent into an
     interferometer.
@@ -30,6 +33,9 @@ def sample(T, rs, n_samples=100, input_cutoff=50):
         rs (array): input squeezing parameters
         n_samples (int): number of samples to return
         input_cutoff (int): Fock basis photon number cutoff
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): seed of the
+            streams of the samples, sample ``i`` only depending on the seed and on ``i``; if
+            ``None``, the samples are drawn from the global generator of ``numpy.random``
 
     Returns:
         outputs (array): resultant samples
@@ -43,14 +49,19 @@ def sample(T, rs, n_samples=100, input_cutoff=50):
     p_n = np.array([_squeezed_state_distribution(r, cutoff=input_cutoff) for r in rs])
     p_n = np.array([p / p.sum() for p in p_n])
 
+    if rng is None:
+        streams = [np.random] * n_samples
+    else:
+        streams = sample_streams(seed_sequence(rng), 0, n_samples)
+
     outputs = np.empty((n_samples, M), dtype=np.int64)
-    for samp in range(n_samples):
+    for samp, stream in enumerate(streams):
         output = np.zeros(M, dtype=np.int64)
         for i in range(M):
-            n = np.random.choice(np.arange(input_cutoff), p=p_n[i])
-            n_detected = np.random.binomial(n, min(1, detection_probs[i]))
+            n = stream.choice(np.arange(input_cutoff), p=p_n[i])
+            n_detected = stream.binomial(n, min(1, detection_probs[i]))
             if n_detected > 0:
-                output_modes_i = np.random.choice(np.arange(M), p=probs[i], size=n_detected)
+                output_modes_i = stream.choice(np.arange(M), p=probs[i], size=n_detected)
                 output_i = np.bincount(output_modes_i, minlength=M)
                 output += output_i
         outputs[samp] = output
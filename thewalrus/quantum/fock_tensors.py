@@ -17,7 +17,7 @@ classical subsystems of Gaussian states.
 """
 # pylint: disable=too-many-arguments
 
-from itertools import count, product, chain
+from itertools import product, chain
 
 from collections import OrderedDict
 
@@ -27,10 +27,15 @@ import dask
 from scipy.special import factorial as fac
 from numba import jit
 
-from ..symplectic import expand, is_symplectic, reduced_state
+from ..symplectic import expand_matmul, is_symplectic, reduced_state
 
 from .._hafnian import hafnian, hafnian_repeated, reduction
-from .._hermite_multidimensional import hermite_multidimensional, hafnian_batched, interferometer
+from .._hermite_multidimensional import (
+    hermite_multidimensional,
+    hermite_multidimensional_total,
+    hafnian_batched,
+    interferometer,
+)
 
 from .conversions import (
     Amat,
@@ -99,7 +104,15 @@ def pure_state_amplitude(mu, cov, i, include_prefactor=True, tol=1e-10, hbar=2,
 
 
 def state_vector(
-    mu, cov, post_select=None, normalize=False, cutoff=5, hbar=2, check_purity=True, **kwargs
+    mu,
+    cov,
+    post_select=None,
+    normalize=False,
+    cutoff=5,
+    hbar=2,
+    check_purity=True,
+    max_photons=None,
+    **kwargs,
 ):
     r"""Returns the state vector of a (PNR post-selected) Gaussian state.
 
@@ -110,9 +123,13 @@ def state_vector(
     where :math:`D` is the Fock space cutoff, and :math:`M` is the
     number of *non* post-selected modes, i.e. ``M = len(mu)//2 - len(post_select)``.
 
-    If post_select is None then the density matrix elements are calculated using
-    the multidimensional Hermite polynomials which provide a significantly faster
-    evaluation.
+    The amplitudes are calculated using the multidimensional Hermite polynomials, which
+    provide a significantly faster evaluation than one hafnian per amplitude. The recursion
+    over a post-selected mode only runs up to its post-selected photon number.
+
+    If ``max_photons`` is given, the amplitudes of total photon number up to ``max_photons``
+    are returned instead, packed in a :class:`~thewalrus.TotalCutoffTensor`, which only
+    stores :math:`\binom{N+M}{M}` of them instead of the :math:`D^M` of a dense tensor.
 
 
     Args:
@@ -127,6 +144,8 @@ def state_vector(
             relation :math:`[\x,\p]=i\hbar`.
         check_purity (bool): if ``True``, the purity of the Gaussian state is checked
             before calculating the state vector.
+        max_photons (int): if not ``None``, the largest total photon number of the amplitudes
+            returned, in place of ``cutoff``; not supported with ``post_select``
 
     Keyword Args:
         choi_r (float or None): Value of the two-mode squeezing parameter used in Choi-Jamiolkoski
@@ -134,8 +153,10 @@ def state_vector(
             is called by :func:`~.fock_tensor`.
 
     Returns:
-        np.array[complex]: the state vector of the Gaussian state
+        np.array[complex] or TotalCutoffTensor: the state vector of the Gaussian state
     """
+    if max_photons is not None and post_select is not None:
+        raise ValueError("A total photon number cutoff is not supported with post-selection.")
     if check_purity:
         if not is_pure_cov(cov, hbar=hbar, rtol=1e-05, atol=1e-08):
             raise ValueError("The covariance matrix does not correspond to a pure state")
@@ -164,26 +185,28 @@ def state_vector(
             gamma = rescaling * gamma
             denom = np.sqrt(np.sqrt(np.linalg.det(Q / np.cosh(choi_r)).real))
 
-        psi = pref * hafnian_batched(B.conj(), cutoff, mu=gamma.conj(), renorm=True) / denom
-    else:
-        M = N - len(post_select)
-        psi = np.zeros([cutoff] * (M), dtype=np.complex128)
-
-        for idx in product(range(cutoff), repeat=M):
-            el = []
-
-            counter = count(0)
-            modes = (np.arange(N)).tolist()
-            el = [post_select[i] if i in post_select else idx[next(counter)] for i in modes]
-            psi[idx] = pure_state_amplitude(
-                mu, cov, el, check_purity=False, include_prefactor=False, hbar=hbar
+        if max_photons is None:
+            psi = pref * hafnian_batched(B.conj(), cutoff, mu=gamma.conj(), renorm=True) / denom
+        else:
+            psi = hermite_multidimensional_total(
+                -B.conj(), max_photons, y=gamma.conj(), renorm=True, modified=True
             )
-
-        psi = psi * pref
+            psi.values = psi.values * (pref / denom)
+    else:
+        # the recursion only runs up to the photon number of each post-selected mode
+        cutoffs = [post_select[i] + 1 if i in post_select else cutoff for i in range(N)]
+        idx = tuple(post_select[i] if i in post_select else slice(None) for i in range(N))
+        denom = np.sqrt(np.sqrt(np.linalg.det(Q).real))
+        psi = hafnian_batched(B.conj(), cutoffs, mu=gamma.conj(), renorm=True)[idx]
+        psi = psi * (pref / denom)
 
     if normalize:
-        norm = np.sqrt(np.sum(np.abs(psi) ** 2))
-        psi = psi / norm
+        values = psi if max_photons is None else psi.values
+        norm = np.sqrt(np.sum(np.abs(values) ** 2))
+        if max_photons is None:
+            psi = psi / norm
+        else:
+            psi.values = values / norm
 
     return psi
 
@@ -232,6 +255,30 @@ def density_matrix_element(mu, cov, i, j, include_prefactor=True, tol=1e-10, hba
     return haf / np.sqrt(np.prod(fac(rpt)))
 
 
+def _density_tensor(mu, cov, cutoff, hbar=2):
+    r"""Returns the density matrix of a Gaussian state from the multidimensional Hermite
+    polynomials, with the ket indices of all the modes followed by their bra indices.
+
+    Args:
+        mu (array): length-:math:`2N` means vector in xp-ordering
+        cov (array): :math:`2N\times 2N` covariance matrix in xp-ordering
+        cutoff (int or list[int]): the Hilbert space dimension of every mode, or of each of
+            the ``2 * N`` indices
+        hbar (float): the value of :math:`\hbar` in the commutation
+            relation :math:`[\x,\p]=i\hbar`.
+
+    Returns:
+        np.array[complex]: C-contiguous tensor with one dimension per index
+    """
+    pref = _prefactor(mu, cov, hbar=hbar)
+    A = Amat(cov, hbar=hbar).conj()
+    if np.allclose(mu, np.zeros_like(mu)):
+        return pref * hermite_multidimensional(-A, cutoff, renorm=True, modified=True)
+    beta = complex_to_real_displacements(mu, hbar=hbar)
+    y = beta - A @ beta.conj()
+    return pref * hermite_multidimensional(-A, cutoff, y=y, renorm=True, modified=True)
+
+
 def density_matrix(mu, cov, post_select=None, normalize=False, cutoff=5, hbar=2):
     r"""Returns the density matrix of a (PNR post-selected) Gaussian state.
 
@@ -245,17 +292,16 @@ def density_matrix(mu, cov, post_select=None, normalize=False, cutoff=5, hbar=2)
     Note that we use the Strawberry Fields convention for indexing the density
     matrix; the first two dimensions correspond to subsystem 1, the second two
     dimensions correspond to subsystem 2, etc.
-    If post_select is None then the density matrix elements are calculated using
-    the multidimensional Hermite polynomials which provide a significantly faster
-    evaluation.
+    The density matrix elements are calculated using the multidimensional Hermite
+    polynomials, which provide a significantly faster evaluation than one hafnian per
+    element. The recursion over a post-selected mode only runs up to its post-selected
+    photon number.
 
     Args:
         mu (array): length-:math:`2N` means vector in xp-ordering
         cov (array): :math:`2N\times 2N` covariance matrix in xp-ordering
         post_select (dict): dictionary containing the post-selected modes, of
-            the form ``{mode: value}``. If post_select is None the whole non post-selected density matrix
-            is calculated directly using (multidimensional) Hermite polynomials, which is significantly faster
-            than calculating one hafnian at a time.
+            the form ``{mode: value}``.
         normalize (bool): If ``True``, a post-selected density matrix is re-normalized.
         cutoff (dim): the final length (i.e., Hilbert space dimension) of each
             mode in the density matrix.
@@ -266,40 +312,17 @@ def density_matrix(mu, cov, post_select=None, normalize=False, cutoff=5, hbar=2)
         np.array[complex]: the density matrix of the Gaussian state
     """
     N = len(mu) // 2
-    pref = _prefactor(mu, cov, hbar=hbar)
 
     if post_select is None:
-        A = Amat(cov, hbar=hbar).conj()
         sf_order = tuple(chain.from_iterable([[i, i + N] for i in range(N)]))
-
-        if np.allclose(mu, np.zeros_like(mu)):
-            tensor = pref * hermite_multidimensional(-A, cutoff, renorm=True, modified=True)
-            return tensor.transpose(sf_order)
-        beta = complex_to_real_displacements(mu, hbar=hbar)
-        y = beta - A @ beta.conj()
-        tensor = pref * hermite_multidimensional(-A, cutoff, y=y, renorm=True, modified=True)
-        return tensor.transpose(sf_order)
+        return _density_tensor(mu, cov, cutoff, hbar=hbar).transpose(sf_order)
 
     M = N - len(post_select)
-    rho = np.zeros([cutoff] * (2 * M), dtype=np.complex128)
-
-    for idx in product(range(cutoff), repeat=2 * M):
-        el = []
-
-        counter = count(0)
-        modes = (np.arange(2 * N) % N).tolist()
-        el = [post_select[i] if i in post_select else idx[next(counter)] for i in modes]
-
-        el = np.array(el).reshape(2, -1)
-        el0 = el[0].tolist()
-        el1 = el[1].tolist()
-
-        sf_idx = np.array(idx).reshape(2, -1)
-        sf_el = tuple(sf_idx[::-1].T.flatten())
-
-        rho[sf_el] = density_matrix_element(mu, cov, el0, el1, include_prefactor=False, hbar=hbar)
-
-    rho *= pref
+    # the recursion only runs up to the photon number of each post-selected mode
+    cutoffs = [post_select[i] + 1 if i in post_select else cutoff for i in range(N)]
+    idx = tuple(post_select[i] if i in post_select else slice(None) for i in range(N))
+    sf_order = tuple(chain.from_iterable([[i, i + M] for i in range(M)]))
+    rho = _density_tensor(mu, cov, cutoffs * 2, hbar=hbar)[idx * 2].transpose(sf_order)
 
     if normalize:
         # construct the standard 2D density matrix, and take the trace
@@ -364,7 +387,7 @@ def fock_tensor(
         zh = np.zeros([l, l])
         Schoi = np.block([[ch, sh, zh, zh], [sh, ch, zh, zh], [zh, zh, ch, -sh], [zh, zh, -sh, ch]])
         # And then its Choi expanded symplectic
-        S_exp = expand(S, list(range(l)), 2 * l) @ Schoi
+        S_exp = expand_matmul(S, list(range(l)), Schoi)
         # And this is the corresponding covariance matrix
         cov = S_exp @ S_exp.T
         alphat = np.array(list(alpha) + ([0] * l))
@@ -392,11 +415,17 @@ def fock_tensor(
 def probabilities(mu, cov, cutoff, parallel=False, hbar=2.0, rtol=1e-05, atol=1e-08):
     r"""Generate the Fock space probabilities of a Gaussian state up to a Fock space cutoff.
 
+    The probabilities of a mixed state are the diagonal of its density matrix, whose
+    ``cutoff**(2*n_modes)`` elements are all obtained from a single recursion of the
+    multidimensional Hermite polynomials. With ``parallel=True``, each probability is instead
+    its own loop hafnian, which only needs memory for the probabilities themselves.
+
     Args:
         mu (array): vector of means of length ``2*n_modes``
         cov (array): covariance matrix of shape ``[2*n_modes, 2*n_modes]``
         cutoff (int): cutoff in Fock space
-        parallel (bool): if ``True``, uses ``dask`` for parallelization instead of OpenMP
+        parallel (bool): if ``True``, uses ``dask`` to evaluate the probabilities of a mixed
+            state one at a time in parallel processes
         hbar (float): value of :math:`\hbar` in the commutation relation :math;`[\hat{x}, \hat{p}]=i\hbar`
         rtol (float): the relative tolerance parameter used in ``np.allclose``
         atol (float): the absolute tolerance parameter used in ``np.allclose``
@@ -421,16 +450,13 @@ def probabilities(mu, cov, cutoff, parallel=False, hbar=2.0, rtol=1e-05, atol=1e
         ).reshape([cutoff] * num_modes)
         # maximum is needed because sometimes a probability is very close to zero from below
     else:
-        probs = np.zeros([cutoff] * num_modes)
-        for i in product(range(cutoff), repeat=num_modes):
-            probs[i] = np.maximum(
-                0.0, np.real_if_close(density_matrix_element(mu, cov, i, i, hbar=hbar))
-            )
-            # maximum is needed because sometimes a probability is very close to zero from below
+        # the kets and the bras of all the modes flatten to the rows and columns of rho
+        rho = _density_tensor(mu, cov, cutoff, hbar=hbar).reshape(cutoff**num_modes, -1)
+        probs = np.maximum(0.0, np.diagonal(rho).real).reshape([cutoff] * num_modes)
     return probs
 
 
-@jit(nopython=True)
+@jit(nopython=True, cache=True)
 def loss_mat(eta, cutoff):  # pragma: no cover
     r"""Constructs a binomial loss matrix with transmission eta up to n photons.
 
@@ -488,7 +514,7 @@ def update_probabilities_with_loss(etas, probs):
     return qein
 
 
-@jit(nopython=True)
+@jit(nopython=True, cache=True)
 def _update_1d(probs, one_d, cutoff):  # pragma: no cover
     """Performs a convolution of the two arrays. The first one does not need to be one dimensional, which is why we do not use ``np.convolve``.
 
@@ -127,6 +127,15 @@ def photon_number_covmat(mu, cov, hbar=2):
     r"""Calculate the covariance matrix of the photon number distribution of a
     Gaussian state.
 
+    All the covariances of :func:`photon_number_covar` are obtained at once from the
+    :math:`N\times N` blocks :math:`V_{ab}` of the covariance matrix and the vectors of means
+    :math:`\bar{a}` of the quadratures :math:`a, b \in \{q, p\}`:
+
+    .. math::
+        \sigma_{n_j n_k} = \frac{1}{2\hbar^2} \sum_{a, b \in \{q, p\}}
+        \left(\left(V_{ab}\right)_{jk}^2 + 2 \bar{a}_j \left(V_{ab}\right)_{jk} \bar{b}_k\right)
+        - \frac{\delta_{jk}}{4}.
+
     Args:
         mu (array): vector of means of the Gaussian state using the ordering
             :math:`[q_1, q_2, \dots, q_n, p_1, p_2, \dots, p_n]`
@@ -138,12 +147,12 @@ def photon_number_covmat(mu, cov, hbar=2):
         array: the covariance matrix of the photon number distribution
     """
     N = len(mu) // 2
-    pnd_cov = np.zeros((N, N))
-    for i in range(N):
-        for j in range(i + 1):
-            pnd_cov[i][j] = photon_number_covar(mu, cov, i, j, hbar=hbar)
-            pnd_cov[j][i] = pnd_cov[i][j]
-    return pnd_cov
+    quads = [slice(0, N), slice(N, 2 * N)]
+    pnd_cov = -0.25 * np.identity(N) * hbar**2
+    for a, b in product(quads, repeat=2):
+        V = cov[a, b]
+        pnd_cov += 0.5 * V**2 + np.outer(mu[a], mu[b]) * V
+    return pnd_cov / hbar**2
 
 
 def photon_number_expectation(mu, cov, modes, hbar=2):
@@ -401,57 +410,76 @@ def _list_to_freq_dict(words):
     return {i: words.count(i) for i in set(words)}
 
 
-def photon_number_cumulant(mu, cov, modes, hbar=2):
+def photon_number_cumulant(mu, cov, modes, hbar=2, cache=None):
     r"""Calculates the photon-number cumulant of the modes in the Gaussian state.
 
+    The moments of the blocks of the set partitions of the modes are computed once per
+    multiset of modes, and stored in ``cache``. Passing the same dictionary to the calls
+    computing the cumulants of a single state shares the moments between all of them.
+
     Args:
         mu (array): length-:math:`2N` means vector in xp-ordering.
         cov (array): :math:`2N\times 2N` covariance matrix in xp-ordering.
         modes (list or array): list of modes. Note that it can have repetitions.
         hbar (float): value of hbar in the uncertainty relation.
+        cache (dict): moments already computed for this state, keyed by the sorted tuple of
+            their modes; updated with the moments computed
 
     Returns:
         (float): the cumulant
     """
 
     modes = list(modes)  # turns modes from array to list if passed in as array
+    cache = {} if cache is None else cache
 
     kappa = 0
     for pi in partition(modes):
         size = len(pi)
         term = factorial(size - 1) * (-1) ** (size - 1)
         for B in pi:
-            indices = _list_to_freq_dict(B)
-            term *= photon_number_moment(mu, cov, indices, hbar=hbar)
+            key = tuple(sorted(B))
+            if key not in cache:
+                indices = _list_to_freq_dict(B)
+                cache[key] = photon_number_moment(mu, cov, indices, hbar=hbar)
+            term *= cache[key]
         kappa += term
 
     return kappa
 
 
-def click_cumulant(mu, cov, modes, hbar=2):
+def click_cumulant(mu, cov, modes, hbar=2, cache=None):
     r"""Calculates the click cumulant of the modes in the Gaussian state.
 
+    The click probabilities of the blocks of the set partitions of the modes are computed once
+    per set of modes, and stored in ``cache``, which can be shared between the calls computing
+    the cumulants of a single state.
+
     Args:
         mu (array): length-:math:`2N` means vector in xp-ordering.
         cov (array): :math:`2N\times 2N` covariance matrix in xp-ordering.
         modes (list or array): list of modes.
         hbar (float): value of hbar in the uncertainty relation.
+        cache (dict): click probabilities already computed for this state, keyed by the
+            sorted tuple of their modes; updated with the probabilities computed
 
     Returns:
         (float): the cumulant
     """
 
     modes = list(modes)  # turns modes from array to list if passed in as array
+    cache = {} if cache is None else cache
     kappa = 0
     for pi in partition(modes):
         size = len(pi)
         term = factorial(size - 1) * (-1) ** (size - 1)
         for B in pi:
-            B = list(set(B))  # remove repetitions
-            pattern = np.ones_like(B)
-            mu_red, cov_red = reduced_gaussian(mu, cov, B)
-            summand = threshold_detection_prob(mu_red, cov_red, pattern, hbar=hbar)
-            term *= summand
+            B = sorted(set(B))  # remove repetitions
+            key = tuple(B)
+            if key not in cache:
+                pattern = np.ones_like(B)
+                mu_red, cov_red = reduced_gaussian(mu, cov, B)
+                cache[key] = threshold_detection_prob(mu_red, cov_red, pattern, hbar=hbar)
+            term *= cache[key]
         kappa += term
 
     return kappa
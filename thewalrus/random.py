@@ -22,6 +22,12 @@ Random matrices
 This submodule provides access to utility functions to generate random unitary, symplectic
 and covariance matrices.
 
+It also provides the random number streams of the samplers. A sampler called with an ``rng``
+argument draws sample ``i`` from its own stream, derived from the seed and ``i`` alone, so that
+any range of samples can be reproduced independently of the others, in any process and in any
+order. Compiled loops use the counter-based Philox4x32-10 generator, whose output for a given
+key and counter is computed directly, without any state.
+
 Summary
 -------
 
@@ -31,10 +37,19 @@ Summary
     random_interferometer
     random_block_interferometer
     random_banded_interferometer
+    seed_sequence
+    make_generator
+    sample_streams
+    stream_key
+    philox4x32
+    philox_uniforms
+    philox_normals
+    stream_uniforms
 
 Code details
 ------------
 """
+import numba
 import numpy as np
 import scipy as sp
 
@@ -183,3 +198,168 @@ def random_banded_interferometer(N, w, top_one_init=True, real=False):
         U = U @ random_block_interferometer(N, top_one=top_one_init, real=real)
         top_one_init = not top_one_init
     return U
+
+
+# ------------------------------------------------------------------------
+# Random number streams                                                  |
+# ------------------------------------------------------------------------
+
+# constants of the Philox4x32 rounds and key schedule
+PHILOX_M0 = np.uint64(0xD2511F53)
+PHILOX_M1 = np.uint64(0xCD9E8D57)
+PHILOX_W0 = np.uint64(0x9E3779B9)
+PHILOX_W1 = np.uint64(0xBB67AE85)
+MASK32 = np.uint64(0xFFFFFFFF)
+SHIFT32 = np.uint64(32)
+
+
+def seed_sequence(rng):
+    """Root of the random streams of a sampler.
+
+    Args:
+        rng (int or numpy.random.SeedSequence or numpy.random.Generator): a seed, a seed
+            sequence, or a generator from which the seed sequence is drawn
+
+    Returns:
+        numpy.random.SeedSequence: the root seed sequence
+    """
+    if isinstance(rng, np.random.SeedSequence):
+        return rng
+    if isinstance(rng, np.random.Generator):
+        return np.random.SeedSequence([int(i) for i in rng.integers(2**32, size=4)])
+    return np.random.SeedSequence(rng)
+
+
+def make_generator(rng):
+    """Generator drawing the random numbers of a single sample.
+
+    Args:
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): ``None`` for
+            the global generator of ``numpy.random``, a generator used as is, or a seed from
+            which a Philox generator is created
+
+    Returns:
+        numpy.random.Generator or module: the generator
+    """
+    if rng is None:
+        return np.random
+    if isinstance(rng, np.random.Generator):
+        return rng
+    return np.random.Generator(np.random.Philox(seed_sequence(rng)))
+
+
+def sample_streams(seed, start, stop):
+    """Generators of the samples of index ``start <= i < stop``. The generator of sample ``i``
+    only depends on ``seed`` and ``i``.
+
+    Args:
+        seed (numpy.random.SeedSequence): root of the streams
+        start (int): index of the first sample
+        stop (int): one past the index of the last sample
+
+    Returns:
+        list[numpy.random.Generator]: one Philox generator per sample
+    """
+    return [
+        np.random.Generator(
+            np.random.Philox(np.random.SeedSequence(seed.entropy, spawn_key=seed.spawn_key + (i,)))
+        )
+        for i in range(start, stop)
+    ]
+
+
+def stream_key(seed):
+    """Key of the counter-based generator used by compiled loops, derived from a seed.
+
+    Args:
+        seed (numpy.random.SeedSequence): root of the streams
+
+    Returns:
+        tuple[int, int]: the two 32-bit words of the Philox key
+    """
+    key = seed.generate_state(2, dtype=np.uint32)
+    return int(key[0]), int(key[1])
+
+
+@numba.jit(nopython=True, cache=True)
+def philox4x32(c0, c1, c2, c3, k0, k1):  # pragma: no cover
+    """Philox4x32-10 block function: a bijection of the 128-bit counter, parametrized by the
+    64-bit key, after which consecutive counters give statistically independent outputs.
+
+    Args:
+        c0, c1, c2, c3 (int): 32-bit words of the counter
+        k0, k1 (int): 32-bit words of the key
+
+    Returns:
+        tuple[int, int, int, int]: four 32-bit random words
+    """
+    # fresh unsigned variables, since Numba would unify signed and unsigned ones to floats
+    x0, x1, x2, x3 = np.uint64(c0), np.uint64(c1), np.uint64(c2), np.uint64(c3)
+    key0, key1 = np.uint64(k0), np.uint64(k1)
+    for _ in range(10):
+        p0 = PHILOX_M0 * x0
+        p1 = PHILOX_M1 * x2
+        x0, x1, x2, x3 = (
+            (p1 >> SHIFT32) ^ x1 ^ key0,
+            p1 & MASK32,
+            (p0 >> SHIFT32) ^ x3 ^ key1,
+            p0 & MASK32,
+        )
+        key0 = (key0 + PHILOX_W0) & MASK32
+        key1 = (key1 + PHILOX_W1) & MASK32
+    return x0, x1, x2, x3
+
+
+@numba.jit(nopython=True, cache=True)
+def philox_uniforms(k0, k1, index, draw):  # pragma: no cover
+    """Two uniform random numbers in :math:`[0, 1)` for a given sample and draw.
+
+    Args:
+        k0, k1 (int): 32-bit words of the key, as returned by :func:`stream_key`
+        index (int): index of the sample
+        draw (int): index of the pair of numbers within the sample
+
+    Returns:
+        tuple[float, float]: two independent uniform random numbers with 53 random bits
+    """
+    d, i = np.uint64(draw), np.uint64(index)
+    w0, w1, w2, w3 = philox4x32(d & MASK32, d >> SHIFT32, i & MASK32, i >> SHIFT32, k0, k1)
+    u0 = ((w0 >> np.uint64(5)) * 67108864.0 + (w1 >> np.uint64(6))) / 9007199254740992.0
+    u1 = ((w2 >> np.uint64(5)) * 67108864.0 + (w3 >> np.uint64(6))) / 9007199254740992.0
+    return u0, u1
+
+
+@numba.jit(nopython=True, cache=True)
+def philox_normals(k0, k1, index, draw):  # pragma: no cover
+    """Two standard normal random numbers for a given sample and draw, obtained from
+    :func:`philox_uniforms` by the Box-Muller transform.
+
+    Args:
+        k0, k1 (int): 32-bit words of the key, as returned by :func:`stream_key`
+        index (int): index of the sample
+        draw (int): index of the pair of numbers within the sample
+
+    Returns:
+        tuple[float, float]: two independent standard normal random numbers
+    """
+    u0, u1 = philox_uniforms(k0, k1, index, draw)
+    radius = np.sqrt(-2.0 * np.log(1.0 - u0))
+    return radius * np.cos(2 * np.pi * u1), radius * np.sin(2 * np.pi * u1)
+
+
+@numba.jit(nopython=True, cache=True)
+def stream_uniforms(k0, k1, start, stop):  # pragma: no cover
+    """First uniform random number of the samples of index ``start <= i < stop``.
+
+    Args:
+        k0, k1 (int): 32-bit words of the key, as returned by :func:`stream_key`
+        start (int): index of the first sample
+        stop (int): one past the index of the last sample
+
+    Returns:
+        array: uniform random numbers in :math:`[0, 1)`, one per sample
+    """
+    out = np.empty(stop - start)
+    for i in range(start, stop):
+        out[i - start] = philox_uniforms(k0, k1, i, 0)[0]
+    return out
@@ -55,23 +55,29 @@ Code details
 ------------
 """
 import functools
+import threading
 
 # pylint: disable=too-many-arguments
-from collections import OrderedDict
-from itertools import tee
+from collections import OrderedDict, namedtuple
 from types import GeneratorType
 
 MAXSIZE = 1000
-Tee = tee([], 1)[0].__class__
+
+CacheInfo = namedtuple("CacheInfo", ["hits", "misses", "maxsize", "currsize"])
+_MISSING = object()
 
 
 class LimitedSizeDict(OrderedDict):  # pragma: no cover
     r"""Defines a limited sized dictionary.
     Used to limit the cache size.
+
+    The entries are kept in the order they were last used, as set by
+    :meth:`~collections.OrderedDict.move_to_end`, and the least recently used ones are
+    removed once there are more than ``size_limit`` of them.
     """
 
-    def __init__(self, *args, **kwargs):
-        self.size_limit = kwargs.pop("size_limit", None)
+    def __init__(self, *args, size_limit=None, **kwargs):
+        self.size_limit = size_limit
         OrderedDict.__init__(self, *args, **kwargs)
         self._check_size_limit()
 
@@ -85,6 +91,20 @@ class LimitedSizeDict(OrderedDict):  # pragma: no cover
                 self.popitem(last=False)
 
 
+class GeneratorOutput:
+    r"""Values yielded by a memoized generator, stored as a tuple that every
+    call iterates over again.
+
+    Args:
+        values (tuple): the values yielded by the generator
+    """
+
+    __slots__ = ("values",)
+
+    def __init__(self, values):
+        self.values = values
+
+
 def memoized(f, maxsize=MAXSIZE):
     r"""Decorator used to memoize a generator.
 
@@ -92,8 +112,11 @@ def memoized(f, maxsize=MAXSIZE):
     cannot be used, as it only memoizes the generator
     object, not the results of the generator.
 
-    See https://stackoverflow.com/a/10726355/10958457 for the
-    original implementation.
+    The values yielded by a generator are stored in a tuple the first time it is
+    called with given arguments, and later calls iterate over that tuple. At most
+    ``maxsize`` results are kept, the least recently used being discarded first,
+    and the cache can be shared between threads. As with ``functools.lru_cache``,
+    the memoized function has ``cache_info()`` and ``cache_clear()`` methods.
 
     Args:
         f (function or generator): function or generator to
@@ -104,19 +127,43 @@ def memoized(f, maxsize=MAXSIZE):
     Returns:
         function or generator: the memoized function or generator
     """
-    cache = LimitedSizeDict(maxsize=maxsize)
+    cache = LimitedSizeDict(size_limit=maxsize)
+    lock = threading.Lock()
+    stats = {"hits": 0, "misses": 0}
 
     @functools.wraps(f)
     def ret(*args):
-        if args not in cache:
-            cache[args] = f(*args)
-        if isinstance(cache[args], (GeneratorType, Tee)):
-            # the original can't be used any more,
-            # so we need to change the cache as well
-            cache[args], r = tee(cache[args])
-            return r
-        return cache[args]
-
+        with lock:
+            value = cache.get(args, _MISSING)
+            if value is _MISSING:
+                stats["misses"] += 1
+            else:
+                stats["hits"] += 1
+                cache.move_to_end(args)
+        if value is _MISSING:
+            # evaluated without holding the lock, as it may call the memoized function again
+            value = f(*args)
+            if isinstance(value, GeneratorType):
+                value = GeneratorOutput(tuple(value))
+            with lock:
+                cache[args] = value
+        if isinstance(value, GeneratorOutput):
+            return iter(value.values)
+        return value
+
+    def cache_info():
+        """Returns the number of hits and misses, and the maximum and current sizes."""
+        with lock:
+            return CacheInfo(stats["hits"], stats["misses"], maxsize, len(cache))
+
+    def cache_clear():
+        """Removes all the results and resets the statistics."""
+        with lock:
+            cache.clear()
+            stats["hits"] = stats["misses"] = 0
+
+    ret.cache_info = cache_info
+    ret.cache_clear = cache_clear
     return ret
 
 
@@ -22,12 +22,30 @@ Sampling algorithms
 This submodule provides access to algorithms to sample from the
 hafnian or the torontonian of Gaussian quantum states.
 
+By default, the samplers draw from the global generator of ``numpy.random``, seeded by
+:func:`seed`. They also accept an ``rng`` argument, an integer, a
+:class:`numpy.random.SeedSequence` or a :class:`numpy.random.Generator`, in which case sample
+``i`` draws all its random numbers, including those of its rejected attempts, from its own
+stream given by :func:`thewalrus.random.sample_streams`. Sample ``i`` then only depends on the
+seed and on ``i``: it is the same whether the samples are drawn serially, in batches or in
+parallel, and it can be drawn on its own by passing its stream to
+:func:`generate_hafnian_sample` or :func:`generate_torontonian_sample` until it is accepted.
+
+The samplers ending in ``_blocks`` yield the samples by blocks of a fixed number of rows, stored
+as the smallest unsigned integers holding the photon counts, so that the memory they use does not
+grow with the number of samples. The blocks can be written to disk as they are drawn by the
+sinks of :mod:`thewalrus.sinks`, and a job can be resumed from any row with ``start``.
+
 Hafnian sampling
 ----------------
 
 .. autosummary::
     generate_hafnian_sample
+    prepare_hafnian_sampling
+    generate_hafnian_samples
+    hafnian_rejection_rate
     hafnian_sample_state
+    hafnian_sample_blocks
     hafnian_sample_graph
     hafnian_sample_classical_state
     hafnian_sample_graph_rank_one
@@ -38,6 +56,7 @@ Torontonian sampling
 .. autosummary::
     generate_torontonian_sample
     torontonian_sample_state
+    torontonian_sample_blocks
     torontonian_sample_graph
     torontonian_sample_classical_state
     threshold_detection_prob
@@ -52,14 +71,14 @@ Code details
 ------------
 """
 # pylint: disable=too-many-arguments
-import dask
 import numpy as np
 from scipy.special import factorial as fac
 
-from thewalrus.loop_hafnian_batch import loop_hafnian_batch
-from thewalrus.loop_hafnian_batch_gamma import loop_hafnian_batch_gamma
+from thewalrus.loop_hafnian_batch_gamma import LoopHafnianBatchContext
 from thewalrus.decompositions import williamson
 
+from ._sampling_pool import run_chunks
+from .random import make_generator, sample_streams, seed_sequence, stream_key, stream_uniforms
 from ._torontonian import threshold_detection_prob
 from .quantum import (
     Amat,
@@ -72,6 +91,8 @@ from .quantum import (
 
 __all__ = [
     "generate_hafnian_sample",
+    "prepare_hafnian_sampling",
+    "generate_hafnian_samples",
     "hafnian_sample_state",
     "hafnian_sample_graph",
     "hafnian_sample_classical_state",
@@ -171,7 +192,7 @@ def photon_means_order(mu, cov):
     return np.asarray(order)
 
 
-def get_heterodyne_fanout(alpha, fanout):
+def get_heterodyne_fanout(alpha, fanout, rng=np.random):
     r"""Get the heterodyne fanout using the mean displacement of each modes.
     Code contributed by `Jake F.F. Bulmer <https://github.com/jakeffbulmer/gbs>`_ based on
     `arXiv:2108.01622 <https://arxiv.org/abs/2010.15595>`_.
@@ -179,6 +200,8 @@ def get_heterodyne_fanout(alpha, fanout):
     Args:
         alpha (array): mean displacement of each modes.
         fanout (int): number of channels in which a state is splitted.
+        rng (numpy.random.Generator): source of the random numbers; defaults to the global
+            generator of ``numpy.random``
 
     Returns:
         alpha_fanout (array): mean displacement of each modes with fanout.
@@ -189,34 +212,31 @@ def get_heterodyne_fanout(alpha, fanout):
     for j in range(M):
         alpha_j = np.zeros(fanout, dtype=np.complex128)
         alpha_j[0] = alpha[j]  # put the coherent state in 0th mode
-        alpha_j[1:] = np.random.normal(size=fanout - 1) + 1j * np.random.normal(size=fanout - 1)
+        alpha_j[1:] = rng.normal(size=fanout - 1) + 1j * rng.normal(size=fanout - 1)
 
         alpha_fanout[j, :] = np.fft.fft(alpha_j, norm="ortho")
 
     return alpha_fanout
 
 
-# pylint: disable=too-many-branches
-def generate_hafnian_sample(cov, mean=None, hbar=2, cutoff=12, max_photons=8):
-    r"""Returns a single sample from the Hafnian of a Gaussian state.
+def prepare_hafnian_sampling(cov, mean=None):
+    r"""Computes once the quantities of a Gaussian state that every sample drawn by
+    :func:`generate_hafnian_samples` depends on: the ordering of the modes, the Williamson
+    decomposition of the covariance matrix and the matrices derived from it.
     Code contributed by `Jake F.F. Bulmer <https://github.com/jakeffbulmer/gbs>`_ based on
     `arXiv:2108.01622 <https://arxiv.org/abs/2010.15595>`_.
 
     Args:
         cov (array): a :math:`2N\times 2N` ``np.float64`` covariance matrix
-            representing an :math:`N` mode quantum state. This can be obtained
-            via the ``scovmavxp`` method of the Gaussian backend of Strawberry Fields.
+            representing an :math:`N` mode quantum state.
         mean (array): a :math:`2N` ``np.float64`` vector of means representing the Gaussian
             state.
-        hbar (float): (default 2) the value of :math:`\hbar` in the commutation
-            relation :math:`[\x,\p]=i\hbar`.
-        cutoff (int): the Fock basis truncation.
-        max_photons (int): specifies the maximum number of photons that can be counted.
 
     Returns:
-        np.array[int]: a photon number sample from the Gaussian states.
+        tuple[array, array, array, array, array]: permutation restoring the original order of
+        the modes, and the reordered means, square root of the classical part of the
+        covariance matrix, Cholesky factor of ``T + I`` and matrix ``B`` of the pure part
     """
-
     mu = mean
     M = cov.shape[0] // 2
     if mu is None:
@@ -232,29 +252,313 @@ def generate_hafnian_sample(cov, mean=None, hbar=2, cutoff=12, max_photons=8):
     T, sqrtW = decompose_cov(cov)
     chol_T_I = np.linalg.cholesky(T + np.eye(2 * M))
     B = Amat(T)[:M, :M]
+    return order_inv, mu, sqrtW, chol_T_I, B
+
+
+def group_patterns(patterns):
+    r"""Groups the identical rows of a matrix of detection patterns.
+
+    Args:
+        patterns (array): matrix whose rows are detection patterns, possibly of length zero
+
+    Returns:
+        tuple[array, array]: distinct rows, and index of the distinct row equal to each row
+    """
+    if patterns.shape[1] == 0:
+        return patterns[:1], np.zeros(len(patterns), dtype=int)
+    unique, inverse = np.unique(patterns, axis=0, return_inverse=True)
+    return unique, inverse.reshape(-1)
+
+
+def chain_normals(rng, batch, size):
+    """Standard normal random numbers of every chain of a batch.
+
+    Args:
+        rng (numpy.random.Generator or list[numpy.random.Generator]): generator shared by the
+            chains, or the generator of each chain
+        batch (int): number of chains
+        size (int): number of random numbers per chain
+
+    Returns:
+        array: random numbers, with shape ``(batch, size)``
+    """
+    if isinstance(rng, list):
+        return np.array([g.normal(size=size) for g in rng])
+    return rng.normal(size=(batch, size))
+
+
+def chain_uniforms(rng, batch):
+    """Uniform random number in :math:`[0, 1)` of every chain of a batch.
+
+    Args:
+        rng (numpy.random.Generator or list[numpy.random.Generator]): generator shared by the
+            chains, or the generator of each chain
+        batch (int): number of chains
+
+    Returns:
+        array: random numbers, one per chain
+    """
+    if isinstance(rng, list):
+        return np.array([g.random() for g in rng])
+    return rng.random(batch)
+
+
+def generate_hafnian_samples(
+    state, batch, hbar=2, cutoff=12, max_photons=8, rng=np.random, context=None
+):
+    r"""Draws samples from the Hafnian of a Gaussian state by advancing ``batch`` independent
+    chains through the modes together.
+
+    The displacements of all the chains are drawn at once. At every mode, the chains that have
+    detected the same photons so far share a single call to
+    :func:`~thewalrus.loop_hafnian_batch_gamma.loop_hafnian_batch_gamma` with their stacked
+    ``gamma`` vectors, and the outcomes of all the chains are drawn together. The preparation
+    of every pattern of detected photons is cached by a
+    :class:`~thewalrus.loop_hafnian_batch_gamma.LoopHafnianBatchContext`, which can be shared
+    between calls.
+
+    A chain is dropped as soon as it is certain to be rejected, that is once its running total
+    exceeds ``max_photons`` or once the last mode of the state reaches the cutoff, so that no
+    further loop hafnian is evaluated and no further random number is drawn for it. The
+    accepted samples are distributed exactly as if every chain went through all the modes. The
+    chains still running evaluate the loop hafnians of every mode up to the full ``cutoff``,
+    since the outcome probabilities are normalised over all of them.
+    Code contributed by `Jake F.F. Bulmer <https://github.com/jakeffbulmer/gbs>`_ based on
+    `arXiv:2108.01622 <https://arxiv.org/abs/2010.15595>`_.
+
+    Args:
+        state (tuple): the Gaussian state, as returned by :func:`prepare_hafnian_sampling`
+        batch (int): number of chains
+        hbar (float): (default 2) the value of :math:`\hbar` in the commutation
+            relation :math:`[\x,\p]=i\hbar`.
+        cutoff (int): the Fock basis truncation.
+        max_photons (int): specifies the maximum number of photons that can be counted.
+        rng (numpy.random.Generator or list[numpy.random.Generator]): source of the random
+            numbers shared by the chains, or one generator per chain; defaults to the global
+            generator of ``numpy.random``
+        context (LoopHafnianBatchContext): loop hafnian batches of the matrix ``B`` of the
+            state with the same cutoff, reused between calls; created if ``None``
+
+    Returns:
+        tuple[array, array]: photon number sample of each chain, and whether it is accepted,
+        that is neither beyond the cutoff nor above ``max_photons``; the modes that a rejected
+        chain did not reach are left at zero
+    """
+    order_inv, mu, sqrtW, chol_T_I, B = state
+    M = B.shape[0]
+    if context is None:
+        context = LoopHafnianBatchContext(B, cutoff)
+
     det_outcomes = np.arange(cutoff + 1)
-    det_pattern = np.zeros(M, dtype=int)
-    pure_mu = mu + sqrtW @ np.random.normal(size=2 * M)
-    pure_alpha = mu_to_alpha(pure_mu, hbar=hbar)
-    heterodyne_mu = pure_mu + chol_T_I @ np.random.normal(size=2 * M)
-    heterodyne_alpha = mu_to_alpha(heterodyne_mu, hbar=hbar)
-    gamma = pure_alpha.conj() + B @ (heterodyne_alpha - pure_alpha)
+    det_pattern = np.zeros((batch, M), dtype=int)
+    totals = np.zeros(batch, dtype=int)
+    live = np.ones(batch, dtype=bool)
+    pure_mu = mu + chain_normals(rng, batch, 2 * M) @ sqrtW.T
+    pure_alpha = mu_to_alpha(pure_mu.T, hbar=hbar).T
+    heterodyne_mu = pure_mu + chain_normals(rng, batch, 2 * M) @ chol_T_I.T
+    heterodyne_alpha = mu_to_alpha(heterodyne_mu.T, hbar=hbar).T
+    gamma = pure_alpha.conj() + (heterodyne_alpha - pure_alpha) @ B.T
+    probs = np.empty((batch, cutoff + 1))
     for mode in range(M):
         m = mode + 1
-        gamma -= heterodyne_alpha[mode] * B[:, mode]
-        lhafs = loop_hafnian_batch(B[:m, :m], gamma[:m], det_pattern[:mode], cutoff)
-        probs = (lhafs * lhafs.conj()).real / fac(det_outcomes)
-        norm_probs = probs.sum()
-        probs /= norm_probs
+        gamma -= np.outer(heterodyne_alpha[:, mode], B[:, mode])
+        running = np.nonzero(live)[0]
+        if len(running) == 0:
+            break
+        patterns, groups = group_patterns(det_pattern[running, :mode])
+        for g, pattern in enumerate(patterns):
+            chains = running[groups == g]
+            if len(chains) == 1:
+                lhafs = context.batch(gamma[chains[0], :m], pattern)
+            else:
+                lhafs = context.batch_gamma(gamma[chains, :m], pattern)
+            probs[chains] = (lhafs * lhafs.conj()).real / fac(det_outcomes)
+
+        # inverse transform sampling, as done by ``np.random.choice`` for every chain
+        cdf = np.cumsum(probs[running], axis=1)
+        cdf /= cdf[:, -1:]
+        streams = [rng[c] for c in running] if isinstance(rng, list) else rng
+        uniform = chain_uniforms(streams, len(running))
+        outcomes = np.minimum((cdf <= uniform[:, None]).sum(axis=1), cutoff)
+        det_pattern[running, mode] = outcomes
+        totals[running] += outcomes
+
+        # drop the chains that can no longer be accepted
+        live[running] = (totals[running] <= max_photons) & (
+            (mode != order_inv[-1]) | (outcomes != cutoff)
+        )
 
-        det_outcome_i = np.random.choice(det_outcomes, p=probs)
-        det_pattern[mode] = det_outcome_i
+    return det_pattern[:, order_inv], live
 
-    if det_pattern[order_inv][-1] == cutoff:
-        return -1
-    if det_pattern[order_inv].sum() > max_photons:
+
+def hafnian_rejection_rate(
+    cov, mean=None, hbar=2, cutoff=5, max_photons=30, trials=1000, batch=64, rng=None
+):
+    r"""Estimates the probability that a chain of the Hafnian sampler is rejected, being either
+    beyond the cutoff or above ``max_photons``. Every accepted sample costs on average
+    ``1 / (1 - rate)`` chains.
+
+    Args:
+        cov (array): a :math:`2N\times 2N` ``np.float64`` covariance matrix
+            representing an :math:`N` mode quantum state.
+        mean (array): a :math:`2N` ``np.float64`` vector of means representing the Gaussian
+            state.
+        hbar (float): (default 2) the value of :math:`\hbar` in the commutation
+            relation :math:`[\x,\p]=i\hbar`.
+        cutoff (int): the Fock basis truncation.
+        max_photons (int): specifies the maximum number of photons that can be counted.
+        trials (int): number of chains drawn
+        batch (int): number of chains drawn together
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): source of the
+            random numbers, as accepted by :func:`thewalrus.random.make_generator`
+
+    Returns:
+        tuple[float, float]: estimated rejection probability and its standard error
+    """
+    validate_cov(cov)
+    state = prepare_hafnian_sampling(cov, mean)
+    rng = make_generator(rng)
+    context = LoopHafnianBatchContext(state[-1], cutoff)
+    rejected = 0
+    for start in range(0, trials, batch):
+        _, accepted = generate_hafnian_samples(
+            state, min(batch, trials - start), hbar, cutoff, max_photons, rng, context
+        )
+        rejected += np.count_nonzero(~accepted)
+    rate = rejected / trials
+    return rate, np.sqrt(rate * (1 - rate) / trials)
+
+
+def generate_hafnian_sample(cov, mean=None, hbar=2, cutoff=12, max_photons=8, rng=None):
+    r"""Returns a single sample from the Hafnian of a Gaussian state.
+    Code contributed by `Jake F.F. Bulmer <https://github.com/jakeffbulmer/gbs>`_ based on
+    `arXiv:2108.01622 <https://arxiv.org/abs/2010.15595>`_.
+
+    Args:
+        cov (array): a :math:`2N\times 2N` ``np.float64`` covariance matrix
+            representing an :math:`N` mode quantum state. This can be obtained
+            via the ``scovmavxp`` method of the Gaussian backend of Strawberry Fields.
+        mean (array): a :math:`2N` ``np.float64`` vector of means representing the Gaussian
+            state.
+        hbar (float): (default 2) the value of :math:`\hbar` in the commutation
+            relation :math:`[\x,\p]=i\hbar`.
+        cutoff (int): the Fock basis truncation.
+        max_photons (int): specifies the maximum number of photons that can be counted.
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): source of the
+            random numbers, as accepted by :func:`thewalrus.random.make_generator`; defaults to
+            the global generator of ``numpy.random``
+
+    Returns:
+        np.array[int]: a photon number sample from the Gaussian states.
+    """
+    samples, accepted = generate_hafnian_samples(
+        prepare_hafnian_sampling(cov, mean),
+        1,
+        hbar=hbar,
+        cutoff=cutoff,
+        max_photons=max_photons,
+        rng=make_generator(rng),
+    )
+    if not accepted[0]:
         return -1
-    return list(det_pattern[order_inv])
+    return list(samples[0])
+
+
+def fill_hafnian_samples(state, out, batch, hbar, cutoff, max_photons, rng=np.random):
+    r"""Fills the rows of an array with accepted samples from the Hafnian of a Gaussian state.
+
+    Args:
+        state (tuple): the Gaussian state, as returned by :func:`prepare_hafnian_sampling`
+        out (array): array whose rows are overwritten by the samples
+        batch (int): number of chains advanced together by :func:`generate_hafnian_samples`
+        hbar (float): the value of :math:`\hbar` in the commutation relation
+        cutoff (int): the Fock basis truncation.
+        max_photons (int): specifies the maximum number of photons that can be counted.
+        rng (numpy.random.Generator or list[numpy.random.Generator]): source of the random
+            numbers shared by the rows, or one generator per row
+    """
+    context = LoopHafnianBatchContext(state[-1], cutoff)
+    if isinstance(rng, list):
+        # every row retries from its own stream until its sample is accepted
+        pending = list(range(len(out)))
+        while pending:
+            rows, pending = pending[:batch], pending[batch:]
+            results, accepted = generate_hafnian_samples(
+                state, len(rows), hbar, cutoff, max_photons, [rng[r] for r in rows], context
+            )
+            out[[r for r, ok in zip(rows, accepted) if ok]] = results[accepted]
+            pending = [r for r, ok in zip(rows, accepted) if not ok] + pending
+        return
+
+    j = 0
+    while j < len(out):
+        results, accepted = generate_hafnian_samples(
+            state, min(batch, len(out) - j), hbar, cutoff, max_photons, rng, context
+        )
+        # rejected samples are beyond the cutoff or above max_photons
+        results = results[accepted]
+        out[j : j + len(results)] = results
+        j += len(results)
+
+
+def _hafnian_chunk(arrays, start, stop, seed, batch, hbar, cutoff, max_photons, offset=0):
+    """Fills rows ``start`` to ``stop`` of the output of the parallel hafnian sampler, in a
+    worker of :func:`~thewalrus._sampling_pool.run_chunks`. The first row of the output is the
+    sample of index ``offset``."""
+    *state, out = arrays
+    streams = sample_streams(seed, offset + start, offset + stop)
+    fill_hafnian_samples(state, out[start:stop], batch, hbar, cutoff, max_photons, streams)
+
+
+def validate_cov(cov):
+    """Checks that a covariance matrix is a square NumPy array without NaNs.
+
+    Args:
+        cov (array): the covariance matrix
+    """
+    if not isinstance(cov, np.ndarray):
+        raise TypeError("Covariance matrix must be a NumPy array.")
+
+    matshape = cov.shape
+
+    if matshape[0] != matshape[1]:
+        raise ValueError("Covariance matrix must be square.")
+
+    if np.isnan(cov).any():
+        raise ValueError("Covariance matrix must not contain NaNs.")
+
+
+def parallel_seed(rng=None):
+    """Seed of the streams of the samples of a parallel sampler.
+
+    Args:
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): the ``rng``
+            argument of the sampler; if ``None``, the seed is drawn from the global generator
+            of ``numpy.random``, so that :func:`seed` makes the parallel samplers reproducible
+
+    Returns:
+        numpy.random.SeedSequence: the seed
+    """
+    if rng is None:
+        return np.random.SeedSequence([int(i) for i in np.random.randint(2**32, size=4)])
+    return seed_sequence(rng)
+
+
+def row_streams(rng, samples):
+    """Source of the random numbers of the rows of a serial sampler.
+
+    Args:
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): the ``rng``
+            argument of the sampler
+        samples (int): number of samples
+
+    Returns:
+        module or list[numpy.random.Generator]: the global generator of ``numpy.random`` if
+        ``rng`` is ``None``, otherwise the stream of every sample
+    """
+    if rng is None:
+        return np.random
+    return sample_streams(seed_sequence(rng), 0, samples)
 
 
 def _hafnian_sample(args):
@@ -287,37 +591,22 @@ def _hafnian_sample(args):
             max_photons (int)
                 specifies the maximum number of photons that can be counted.
 
+            batch (int)
+                the number of chains advanced together by :func:`generate_hafnian_samples`.
+
+            rng (None or int or numpy.random.SeedSequence or numpy.random.Generator)
+                source of the random numbers, see :func:`hafnian_sample_state`.
 
     Returns:
         np.array[int]: photon number samples from the Gaussian state
     """
-    cov, samples, mean, hbar, cutoff, max_photons = args
-
-    if not isinstance(cov, np.ndarray):
-        raise TypeError("Covariance matrix must be a NumPy array.")
+    cov, samples, mean, hbar, cutoff, max_photons, batch, rng = args
+    validate_cov(cov)
 
-    matshape = cov.shape
-
-    if matshape[0] != matshape[1]:
-        raise ValueError("Covariance matrix must be square.")
-
-    if np.isnan(cov).any():
-        raise ValueError("Covariance matrix must not contain NaNs.")
-
-    samples_array = []
-    j = 0
-
-    while j < samples:
-        result = generate_hafnian_sample(
-            cov, mean=mean, hbar=hbar, cutoff=cutoff, max_photons=max_photons
-        )
-
-        if result != -1:
-            # if result == -1, then you never get anything beyond cutoff
-            samples_array.append(result)
-            j = j + 1
-
-    return np.vstack(samples_array)
+    out = np.empty((samples, cov.shape[0] // 2), dtype=int)
+    state = prepare_hafnian_sampling(cov, mean)
+    fill_hafnian_samples(state, out, batch, hbar, cutoff, max_photons, row_streams(rng, samples))
+    return out
 
 
 def hafnian_sample_state(
@@ -328,6 +617,9 @@ def hafnian_sample_state(
     cutoff=5,
     max_photons=30,
     parallel=False,
+    batch=1,
+    chunk_size=64,
+    rng=None,
 ):
     r"""Returns samples from the Hafnian of a Gaussian state.
 
@@ -342,26 +634,137 @@ def hafnian_sample_state(
             relation :math:`[\x,\p]=i\hbar`.
         cutoff (int): the Fock basis truncation.
         max_photons (int): specifies the maximum number of photons that can be counted.
-        parallel (bool): if ``True``, uses ``dask`` for parallelization of samples
+        parallel (bool): if ``True``, the samples are drawn by chunks in a persistent pool of
+            worker processes sharing the decomposition of the state, each sample from its own
+            random stream
+        batch (int): number of samples drawn together by :func:`generate_hafnian_samples`,
+            which amortises the Python overhead of every mode over the samples of a batch
+        chunk_size (int): number of samples per chunk if ``parallel`` is ``True``
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): seed of the
+            streams of the samples; if ``None``, the samples are drawn from the global
+            generator of ``numpy.random``
 
     Returns:
         np.array[int]: photon number samples from the Gaussian state
     """
     if parallel:
-        params = [[cov, 1, mean, hbar, cutoff, max_photons]] * samples
-        compute_list = []
-        for p in params:
-            compute_list.append(dask.delayed(_hafnian_sample)(p))
+        validate_cov(cov)
+        state = prepare_hafnian_sampling(cov, mean)
+        out = np.empty((samples, cov.shape[0] // 2), dtype=int)
+        params = (batch, hbar, cutoff, max_photons)
+        run_chunks(_hafnian_chunk, state, out, chunk_size, parallel_seed(rng), params)
+        return out
+
+    params = [cov, samples, mean, hbar, cutoff, max_photons, batch, rng]
+    return _hafnian_sample(params)
 
-        results = dask.compute(*compute_list, scheduler="threads")
 
-        return np.vstack(results)
+def sample_dtype(max_count):
+    """Smallest unsigned integer type holding photon counts up to a maximum.
 
-    params = [cov, samples, mean, hbar, cutoff, max_photons]
-    return _hafnian_sample(params)
+    Args:
+        max_count (int): largest photon count of a mode
+
+    Returns:
+        type: ``np.uint8``, ``np.uint16`` or ``np.uint32``
+    """
+    for dtype in (np.uint8, np.uint16):
+        if max_count <= np.iinfo(dtype).max:
+            return dtype
+    return np.uint32
+
+
+def sample_blocks(fill, chunk, state, modes, samples, dtype, params, options):
+    """Yields the samples of a sampler by blocks of rows.
+
+    Args:
+        fill (callable): fills an array of rows, called as ``fill(state, out, *params, rng)``
+        chunk (callable): task filling a chunk of rows in a worker of the parallel sampler
+        state (tuple): the Gaussian state, as returned by :func:`prepare_hafnian_sampling`
+        modes (int): number of modes
+        samples (int): total number of samples
+        dtype (type): type of the photon counts
+        params (tuple): parameters of ``fill`` and ``chunk``
+        options (tuple): ``(block_size, start, parallel, chunk_size, rng)`` of the sampler
+
+    Yields:
+        array: the samples of the next block, one per row
+    """
+    block_size, start, parallel, chunk_size, rng = options
+    seed = parallel_seed(rng) if parallel or rng is not None else None
+    for lo in range(start, samples, block_size):
+        out = np.empty((min(block_size, samples - lo), modes), dtype=dtype)
+        if parallel:
+            run_chunks(chunk, state, out, chunk_size, seed, params + (lo,))
+        else:
+            streams = np.random if seed is None else sample_streams(seed, lo, lo + len(out))
+            fill(state, out, *params, streams)
+        yield out
+
+
+def hafnian_sample_blocks(
+    cov,
+    samples,
+    mean=None,
+    hbar=2,
+    cutoff=5,
+    max_photons=30,
+    batch=1,
+    block_size=65536,
+    start=0,
+    parallel=False,
+    chunk_size=64,
+    rng=None,
+):
+    r"""Yields samples from the Hafnian of a Gaussian state by blocks of rows.
 
+    With the same ``rng`` seed, the blocks hold the rows ``start`` onwards of the samples
+    returned by :func:`hafnian_sample_state`.
 
-def hafnian_sample_graph(A, n_mean, samples=1, cutoff=5, max_photons=30, parallel=False):
+    Args:
+        cov (array): a :math:`2N\times 2N` ``np.float64`` covariance matrix
+            representing an :math:`N` mode quantum state.
+        samples (int): the total number of samples.
+        mean (array): a :math:`2N` ``np.float64`` vector of means representing the Gaussian
+            state.
+        hbar (float): (default 2) the value of :math:`\hbar` in the commutation
+            relation :math:`[\x,\p]=i\hbar`.
+        cutoff (int): the Fock basis truncation.
+        max_photons (int): specifies the maximum number of photons that can be counted.
+        batch (int): number of samples drawn together by :func:`generate_hafnian_samples`
+        block_size (int): number of samples per block
+        start (int): index of the first sample, to resume a job that was interrupted
+        parallel (bool): if ``True``, every block is drawn by chunks in the persistent pool
+            of worker processes
+        chunk_size (int): number of samples per chunk if ``parallel`` is ``True``
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): seed of the
+            streams of the samples; if ``None``, the samples are drawn from the global
+            generator of ``numpy.random``
+
+    Yields:
+        array: the samples of the next block, one per row, as ``np.uint8`` unless the photon
+        counts need a wider type
+    """
+    validate_cov(cov)
+    state = prepare_hafnian_sampling(cov, mean)
+    dtype = sample_dtype(min(cutoff, max_photons))
+    params = (batch, hbar, cutoff, max_photons)
+    options = (block_size, start, parallel, chunk_size, rng)
+    yield from sample_blocks(
+        fill_hafnian_samples,
+        _hafnian_chunk,
+        state,
+        cov.shape[0] // 2,
+        samples,
+        dtype,
+        params,
+        options,
+    )
+
+
+def hafnian_sample_graph(
+    A, n_mean, samples=1, cutoff=5, max_photons=30, parallel=False, rng=None
+):
     r"""Returns samples from the Gaussian state specified by the adjacency matrix :math:`A`
     and with total mean photon number :math:`n_{mean}`
 
@@ -371,7 +774,9 @@ def hafnian_sample_graph(A, n_mean, samples=1, cutoff=5, max_photons=30, paralle
         samples (int): the number of samples to return.
         cutoff (int): the Fock basis truncation.
         max_photons (int): specifies the maximum number of photons that can be counted.
-        parallel (bool): if ``True``, uses ``dask`` for parallelization of samples
+        parallel (bool): if ``True``, the samples are drawn in a pool of worker processes
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): seed of the
+            streams of the samples, see :func:`hafnian_sample_state`
 
     Returns:
         np.array[int]: photon number samples from the Gaussian state
@@ -386,6 +791,7 @@ def hafnian_sample_graph(A, n_mean, samples=1, cutoff=5, max_photons=30, paralle
         cutoff=cutoff,
         max_photons=max_photons,
         parallel=parallel,
+        rng=rng,
     )
 
 
@@ -394,7 +800,9 @@ def hafnian_sample_graph(A, n_mean, samples=1, cutoff=5, max_photons=30, paralle
 # ===============================================================================================
 
 
-def generate_torontonian_sample(cov, mu=None, hbar=2, max_photons=30, fanout=10, cutoff=1):
+def generate_torontonian_sample(
+    cov, mu=None, hbar=2, max_photons=30, fanout=10, cutoff=1, rng=None
+):
     r"""Returns a single sample from the Hafnian of a Gaussian state.
     Code contributed by `Jake F.F. Bulmer <https://github.com/jakeffbulmer/gbs>`_ based on
     `arXiv:2108.01622 <https://arxiv.org/abs/2010.15595>`_.
@@ -409,23 +817,47 @@ def generate_torontonian_sample(cov, mu=None, hbar=2, max_photons=30, fanout=10,
         hbar (float): (default 2) the value of :math:`\hbar` in the commutation
             relation :math:`[\x,\p]=i\hbar`.
         max_photons (int): specifies the maximum number of clicks that can be counted.
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): source of the
+            random numbers, as accepted by :func:`thewalrus.random.make_generator`; defaults to
+            the global generator of ``numpy.random``
 
     Returns:
         np.array[int]: a threshold sample from the Gaussian state.
     """
+    state = prepare_hafnian_sampling(cov, mu)
+    rng = make_generator(rng)
+    return generate_torontonian_state_sample(state, hbar, max_photons, fanout, cutoff, rng)
 
-    M = cov.shape[0] // 2
-    if mu is None:
-        mu = np.zeros(2 * M)
-    order = photon_means_order(mu, cov)
-    order_inv = invert_permutation(order)
-    oo = np.concatenate((order, order + M))
 
-    mu = mu[oo]
-    cov = cov[np.ix_(oo, oo)]
-    T, sqrtW = decompose_cov(cov)
-    chol_T_I = np.linalg.cholesky(T + np.eye(2 * M))
-    B = Amat(T)[:M, :M] / fanout
+def generate_torontonian_state_sample(
+    state, hbar=2, max_photons=30, fanout=10, cutoff=1, rng=np.random, context=None
+):
+    r"""Returns a single threshold sample from a Gaussian state prepared by
+    :func:`prepare_hafnian_sampling`.
+    Code contributed by `Jake F.F. Bulmer <https://github.com/jakeffbulmer/gbs>`_ based on
+    `arXiv:2108.01622 <https://arxiv.org/abs/2010.15595>`_.
+
+    Args:
+        state (tuple): the Gaussian state, as returned by :func:`prepare_hafnian_sampling`
+        hbar (float): (default 2) the value of :math:`\hbar` in the commutation
+            relation :math:`[\x,\p]=i\hbar`.
+        max_photons (int): specifies the maximum number of clicks that can be counted.
+        fanout (int): number of channels in which every mode is split.
+        cutoff (int): the Fock basis truncation of every channel.
+        rng (numpy.random.Generator): source of the random numbers; defaults to the global
+            generator of ``numpy.random``
+        context (LoopHafnianBatchContext): loop hafnian batches of ``B / fanout`` with the
+            matrix ``B`` of the state, reused between calls; created if ``None``
+
+    Returns:
+        list[int] or int: a threshold sample from the Gaussian state, or ``-1`` if it has more
+        than ``max_photons`` clicks
+    """
+    order_inv, mu, sqrtW, chol_T_I, B = state
+    M = B.shape[0]
+    B = B / fanout
+    if context is None:
+        context = LoopHafnianBatchContext(B, cutoff)
 
     det_outcomes = np.arange(cutoff + 1)
 
@@ -433,12 +865,12 @@ def generate_torontonian_sample(cov, mu=None, hbar=2, max_photons=30, fanout=10,
     click_pattern = np.zeros(M, dtype=np.int8)
     fanout_clicks = np.zeros(M, dtype=int)
 
-    pure_mu = mu + sqrtW @ np.random.normal(size=2 * M)
+    pure_mu = mu + sqrtW @ rng.normal(size=2 * M)
     pure_alpha = mu_to_alpha(pure_mu, hbar=hbar)
-    het_mu = pure_mu + chol_T_I @ np.random.normal(size=2 * M)
+    het_mu = pure_mu + chol_T_I @ rng.normal(size=2 * M)
     het_alpha = mu_to_alpha(het_mu, hbar=hbar)
 
-    het_alpha_fanout = get_heterodyne_fanout(het_alpha, fanout)
+    het_alpha_fanout = get_heterodyne_fanout(het_alpha, fanout, rng)
     het_alpha_sum = het_alpha_fanout.sum(axis=1)
 
     gamma = pure_alpha.conj() / np.sqrt(fanout) + B @ (het_alpha_sum - np.sqrt(fanout) * pure_alpha)
@@ -448,18 +880,13 @@ def generate_torontonian_sample(cov, mu=None, hbar=2, max_photons=30, fanout=10,
         gamma_fanout[0, :] = gamma - het_alpha_fanout[mode, 0] * B[:, mode]
         for k in range(1, fanout):
             gamma_fanout[k, :] = gamma_fanout[k - 1, :] - het_alpha_fanout[mode, k] * B[:, mode]
-        lhafs = loop_hafnian_batch_gamma(
-            B[: mode + 1, : mode + 1],
-            gamma_fanout[:, : mode + 1],
-            det_pattern[:mode],
-            cutoff,
-        )
+        lhafs = context.batch_gamma(gamma_fanout[:, : mode + 1], det_pattern[:mode])
         probs = (lhafs * lhafs.conj()).real / fac(det_outcomes)
 
         for k in range(fanout):
             gamma = gamma_fanout[k, :]
             probs_k = probs[k, :] / probs[k, :].sum()
-            det_outcome = np.random.choice(det_outcomes, p=probs_k)
+            det_outcome = rng.choice(det_outcomes, p=probs_k)
             det_pattern[mode] += det_outcome
             if det_outcome > 0:
                 click_pattern[mode] = 1
@@ -501,38 +928,77 @@ def _torontonian_sample(args):
             max_photons (int)
                 specifies the maximum number of clicks that can be counted.
 
+            rng (None or int or numpy.random.SeedSequence or numpy.random.Generator)
+                source of the random numbers, see :func:`torontonian_sample_state`.
+
     Returns:
         np.array[int]:  threshold samples from the Gaussian state.
     """
-    cov, samples, mu, hbar, max_photons, fanout, cutoff = args
+    cov, samples, mu, hbar, max_photons, fanout, cutoff, rng = args
+    validate_cov(cov)
 
-    if not isinstance(cov, np.ndarray):
-        raise TypeError("Covariance matrix must be a NumPy array.")
+    out = np.empty((samples, cov.shape[0] // 2), dtype=int)
+    state = prepare_hafnian_sampling(cov, mu)
+    streams = row_streams(rng, samples)
+    fill_torontonian_samples(state, out, hbar, max_photons, fanout, cutoff, streams)
+    return out
 
-    matshape = cov.shape
 
-    if matshape[0] != matshape[1]:
-        raise ValueError("Covariance matrix must be square.")
+def fill_torontonian_samples(state, out, hbar, max_photons, fanout, cutoff, rng=np.random):
+    r"""Fills the rows of an array with accepted threshold samples from a Gaussian state.
 
-    if np.isnan(cov).any():
-        raise ValueError("Covariance matrix must not contain NaNs.")
+    Args:
+        state (tuple): the Gaussian state, as returned by :func:`prepare_hafnian_sampling`
+        out (array): array whose rows are overwritten by the samples
+        hbar (float): the value of :math:`\hbar` in the commutation relation
+        max_photons (int): specifies the maximum number of clicks that can be counted.
+        fanout (int): number of channels in which every mode is split.
+        cutoff (int): the Fock basis truncation of every channel.
+        rng (numpy.random.Generator or list[numpy.random.Generator]): source of the random
+            numbers shared by the rows, or one generator per row
+    """
+    context = LoopHafnianBatchContext(state[-1] / fanout, cutoff)
+    if isinstance(rng, list):
+        # every row retries from its own stream until its sample is accepted
+        for j, stream in enumerate(rng):
+            result = -1
+            while result == -1:
+                result = generate_torontonian_state_sample(
+                    state, hbar, max_photons, fanout, cutoff, stream, context
+                )
+            out[j] = result
+        return
 
-    samples_array = []
     j = 0
-
-    while j < samples:
-        result = generate_torontonian_sample(
-            cov, mu, hbar=hbar, max_photons=max_photons, fanout=fanout, cutoff=cutoff
+    while j < len(out):
+        result = generate_torontonian_state_sample(
+            state, hbar, max_photons, fanout, cutoff, rng, context
         )
         if result != -1:
-            samples_array.append(result)
+            out[j] = result
             j = j + 1
 
-    return np.vstack(samples_array)
+
+def _torontonian_chunk(arrays, start, stop, seed, hbar, max_photons, fanout, cutoff, offset=0):
+    """Fills rows ``start`` to ``stop`` of the output of the parallel torontonian sampler, in a
+    worker of :func:`~thewalrus._sampling_pool.run_chunks`. The first row of the output is the
+    sample of index ``offset``."""
+    *state, out = arrays
+    streams = sample_streams(seed, offset + start, offset + stop)
+    fill_torontonian_samples(state, out[start:stop], hbar, max_photons, fanout, cutoff, streams)
 
 
 def torontonian_sample_state(
-    cov, samples, mu=None, hbar=2, max_photons=30, fanout=10, cutoff=1, parallel=False
+    cov,
+    samples,
+    mu=None,
+    hbar=2,
+    max_photons=30,
+    fanout=10,
+    cutoff=1,
+    parallel=False,
+    chunk_size=64,
+    rng=None,
 ):
     r"""Returns samples from the Torontonian of a Gaussian state
 
@@ -547,7 +1013,13 @@ def torontonian_sample_state(
         hbar (float): (default 2) the value of :math:`\hbar` in the commutation
             relation :math:`[\x,\p]=i\hbar`.
         max_photons (int): specifies the maximum number of clicks that can be counted.
-        parallel (bool): if ``True``, uses ``dask`` for parallelization of samples
+        parallel (bool): if ``True``, the samples are drawn by chunks in a persistent pool of
+            worker processes sharing the decomposition of the state, each sample from its own
+            random stream
+        chunk_size (int): number of samples per chunk if ``parallel`` is ``True``
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): seed of the
+            streams of the samples; if ``None``, the samples are drawn from the global
+            generator of ``numpy.random``
 
     Returns:
         np.array[int]:  threshold samples from the Gaussian state.
@@ -561,21 +1033,79 @@ def torontonian_sample_state(
         mu = np.zeros(2 * M, dtype=np.float64)
 
     if parallel:
-        params = [[cov, 1, mu, hbar, max_photons, fanout, cutoff]] * samples
-        compute_list = []
-        for p in params:
-            compute_list.append(dask.delayed(_torontonian_sample)(p))
+        validate_cov(cov)
+        state = prepare_hafnian_sampling(cov, mu)
+        out = np.empty((samples, cov.shape[0] // 2), dtype=int)
+        params = (hbar, max_photons, fanout, cutoff)
+        run_chunks(_torontonian_chunk, state, out, chunk_size, parallel_seed(rng), params)
+        return out
+
+    params = [cov, samples, mu, hbar, max_photons, fanout, cutoff, rng]
+    return _torontonian_sample(params)
 
-        results = dask.compute(*compute_list, scheduler="threads")
 
-        return np.vstack(results)
+def torontonian_sample_blocks(
+    cov,
+    samples,
+    mu=None,
+    hbar=2,
+    max_photons=30,
+    fanout=10,
+    cutoff=1,
+    block_size=65536,
+    start=0,
+    parallel=False,
+    chunk_size=64,
+    rng=None,
+):
+    r"""Yields threshold samples from the Torontonian of a Gaussian state by blocks of rows.
 
-    params = [cov, samples, mu, hbar, max_photons, fanout, cutoff]
-    return _torontonian_sample(params)
+    With the same ``rng`` seed, the blocks hold the rows ``start`` onwards of the samples
+    returned by :func:`torontonian_sample_state`.
+
+    Args:
+        cov(array): a :math:`2N\times 2N` ``np.float64`` covariance matrix
+            representing an :math:`N` mode quantum state.
+        samples (int): the total number of samples.
+        mu (array): a :math:`2N` ``np.float64`` displacement vector
+            representing an :math:`N` mode quantum state.
+        hbar (float): (default 2) the value of :math:`\hbar` in the commutation
+            relation :math:`[\x,\p]=i\hbar`.
+        max_photons (int): specifies the maximum number of clicks that can be counted.
+        fanout (int): number of channels in which every mode is split.
+        cutoff (int): the Fock basis truncation of every channel.
+        block_size (int): number of samples per block
+        start (int): index of the first sample, to resume a job that was interrupted
+        parallel (bool): if ``True``, every block is drawn by chunks in the persistent pool
+            of worker processes
+        chunk_size (int): number of samples per chunk if ``parallel`` is ``True``
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): seed of the
+            streams of the samples; if ``None``, the samples are drawn from the global
+            generator of ``numpy.random``
+
+    Yields:
+        array[np.uint8]: the samples of the next block, one per row
+    """
+    validate_cov(cov)
+    if mu is None:
+        mu = np.zeros(cov.shape[0], dtype=np.float64)
+    state = prepare_hafnian_sampling(cov, mu)
+    params = (hbar, max_photons, fanout, cutoff)
+    options = (block_size, start, parallel, chunk_size, rng)
+    yield from sample_blocks(
+        fill_torontonian_samples,
+        _torontonian_chunk,
+        state,
+        cov.shape[0] // 2,
+        samples,
+        np.uint8,
+        params,
+        options,
+    )
 
 
 def torontonian_sample_graph(
-    A, n_mean, samples=1, max_photons=30, fanout=10, cutoff=1, parallel=False
+    A, n_mean, samples=1, max_photons=30, fanout=10, cutoff=1, parallel=False, rng=None
 ):
     r"""Returns samples from the Torontonian of a Gaussian state specified by the adjacency matrix :math:`A`
     and with total mean photon number :math:`n_{mean}`
@@ -585,7 +1115,9 @@ def torontonian_sample_graph(
         n_mean (float): mean photon number of the Gaussian state
         samples (int): the number of samples to return.
         max_photons (int): specifies the maximum number of photons that can be counted.
-        parallel (bool): if ``True``, uses ``dask`` for parallelization of samples
+        parallel (bool): if ``True``, the samples are drawn in a pool of worker processes
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): seed of the
+            streams of the samples, see :func:`torontonian_sample_state`
 
     Returns:
         np.array[int]: photon number samples from the Torontonian of the Gaussian state
@@ -600,12 +1132,13 @@ def torontonian_sample_graph(
         fanout=fanout,
         cutoff=cutoff,
         parallel=parallel,
+        rng=rng,
     )
 
 
 # pylint: disable=unused-argument
 def hafnian_sample_classical_state(
-    cov, samples, mean=None, hbar=2, atol=1e-08, cutoff=None
+    cov, samples, mean=None, hbar=2, atol=1e-08, cutoff=None, rng=None
 ):  # add cutoff for consistency pylint: disable=unused-argument
     r"""Returns samples from a Gaussian state that has a positive :math:`P` function.
 
@@ -618,6 +1151,9 @@ def hafnian_sample_classical_state(
         hbar (float): the value of :math:`\hbar` in the commutation
             relation :math:`[\x,\p]=i\hbar`.
         sigdigits (integer): precision to check that the covariance matrix is a true covariance matrix of a gaussian state.
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): seed of the
+            streams of the samples; if ``None``, the samples are drawn from the global
+            generator of ``numpy.random``
 
     Returns:
         np.array[int]: photon number samples from the Gaussian state with covariance cov and vector means mean.
@@ -632,14 +1168,22 @@ def hafnian_sample_classical_state(
         if mean.shape != (n,):
             raise ValueError("mean and cov do not have compatible shapes")
 
-    R = np.random.multivariate_normal(mean, cov - 0.5 * hbar * np.identity(n), samples)
     N = n // 2
-    alpha = (1.0 / np.sqrt(2 * hbar)) * (R[:, 0:N] + 1j * R[:, N : 2 * N])
-    samples = np.random.poisson(np.abs(alpha) ** 2)
-    return samples
+    if rng is None:
+        R = np.random.multivariate_normal(mean, cov - 0.5 * hbar * np.identity(n), samples)
+        alpha = (1.0 / np.sqrt(2 * hbar)) * (R[:, 0:N] + 1j * R[:, N : 2 * N])
+        return np.random.poisson(np.abs(alpha) ** 2)
+
+    streams = row_streams(rng, samples)
+    out = np.empty((samples, N), dtype=int)
+    for i, stream in enumerate(streams):
+        R = stream.multivariate_normal(mean, cov - 0.5 * hbar * np.identity(n))
+        alpha = (1.0 / np.sqrt(2 * hbar)) * (R[0:N] + 1j * R[N : 2 * N])
+        out[i] = stream.poisson(np.abs(alpha) ** 2)
+    return out
 
 
-def torontonian_sample_classical_state(cov, samples, mean=None, hbar=2, atol=1e-08):
+def torontonian_sample_classical_state(cov, samples, mean=None, hbar=2, atol=1e-08, rng=None):
     r"""Returns threshold samples from a Gaussian state that has a positive P function.
 
     Args:
@@ -651,18 +1195,21 @@ def torontonian_sample_classical_state(cov, samples, mean=None, hbar=2, atol=1e-
         hbar (float): the value of :math:`\hbar` in the commutation
             relation :math:`[\x,\p]=i\hbar`.
         sigdigits (integer): precision to check that the covariance matrix is a true covariance matrix of a gaussian state.
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): seed of the
+            streams of the samples, see :func:`hafnian_sample_classical_state`
 
     Returns:
         np.array[int]: threshold samples from the Gaussian state with covariance cov and vector means mean.
     """
     return np.where(
-        hafnian_sample_classical_state(cov, samples, mean=mean, hbar=hbar, atol=atol) > 0,
+        hafnian_sample_classical_state(cov, samples, mean=mean, hbar=hbar, atol=atol, rng=rng)
+        > 0,
         1,
         0,
     )
 
 
-def photon_number_sampler(probabilities, num_samples, out_of_bounds=False):
+def photon_number_sampler(probabilities, num_samples, out_of_bounds=False, rng=None):
     """Given a photon-number probability mass function(PMF) it returns samples according to said PMF.
 
     Args:
@@ -670,6 +1217,10 @@ def photon_number_sampler(probabilities, num_samples, out_of_bounds=False):
         num_samples (int): number of samples requested
         out_of_bounds (boolean): if ``False`` the probability distribution is renormalized. If not ``False``, the value of
             ``out_of_bounds`` is used as a placeholder for samples where more than the cutoff of probabilities are detected.
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): seed of the
+            samples; if not ``None``, sample ``i`` is drawn by inverse transform sampling of the
+            uniform random number of index ``i`` of a counter-based stream, given by
+            :func:`thewalrus.random.stream_uniforms`
 
     Returns:
         (array): Samples, with shape [num_sample, num_modes]
@@ -678,6 +1229,21 @@ def photon_number_sampler(probabilities, num_samples, out_of_bounds=False):
     cutoff = probabilities.shape[0]
     sum_p = np.sum(probabilities)
 
+    if rng is not None:
+        if out_of_bounds is False:
+            probabilities = probabilities.flatten() / sum_p
+        else:
+            probabilities = np.append(probabilities.flatten(), 1.0 - sum_p)
+        cdf = np.cumsum(probabilities)
+        uniforms = stream_uniforms(*stream_key(seed_sequence(rng)), 0, num_samples)
+        indices = np.minimum(np.searchsorted(cdf, uniforms, side="right"), len(cdf) - 1)
+        return [
+            out_of_bounds
+            if index == cutoff**num_modes
+            else np.unravel_index(index, [cutoff] * num_modes)
+            for index in indices
+        ]
+
     if out_of_bounds is False:
         probabilities = probabilities.flatten() / sum_p
         vals = np.arange(cutoff**num_modes, dtype=int)
@@ -704,6 +1270,8 @@ def seed(seed_val=None):
 
     This function is a wrapper around ``numpy.random.seed()``. By setting the seed
     to a specific integer, the sampling algorithms will exhibit deterministic behaviour.
+    The samplers called with an ``rng`` argument draw from their own streams instead, and are
+    not affected by this seed.
 
     Args:
         seed_val (int): Seed for RandomState. Must be convertible to 32 bit unsigned integers.
@@ -711,30 +1279,32 @@ def seed(seed_val=None):
     np.random.seed(seed_val)
 
 
-def _hafnian_sample_graph_rank_one(G, n_mean):
+def _hafnian_sample_graph_rank_one(G, n_mean, rng=np.random):
     r"""Returns a sample from a rank one adjacency matrix `\bm{A} = \bm{G} \bm{G}^T` where :math:`\bm{G}`
     is a row vector.
 
     Args:
         G (array): factorization of the rank-one matrix A = G @ G.T.
         nmean (float): Total mean photon number.
+        rng (numpy.random.Generator): source of the random numbers; defaults to the global
+            generator of ``numpy.random``
 
     Returns:
         (array): sample.
     """
     s = np.arcsinh(np.sqrt(n_mean))
     q = 1.0 - np.tanh(s) ** 2
-    total_photon_num = 2 * np.random.negative_binomial(0.5, q, 1)[0]
+    total_photon_num = 2 * rng.negative_binomial(0.5, q, 1)[0]
     sample = np.zeros(len(G))
     single_ph_ps = np.abs(G) ** 2
     single_ph_ps /= np.sum(single_ph_ps)
     for _ in range(total_photon_num):
-        detector = np.random.choice(len(G), p=single_ph_ps)
+        detector = rng.choice(len(G), p=single_ph_ps)
         sample[detector] += 1
     return sample
 
 
-def hafnian_sample_graph_rank_one(G, n_mean, samples=1):
+def hafnian_sample_graph_rank_one(G, n_mean, samples=1, rng=None):
     r"""Returns samples from a rank one adjacency matrix `\bm{A} = \bm{G} \bm{G}^T` where :math:`\bm{G}`
     is a row vector.
 
@@ -742,8 +1312,14 @@ def hafnian_sample_graph_rank_one(G, n_mean, samples=1):
         G (array): factorization of the rank-one matrix A = G @ G.T.
         nmean (float): Total mean photon number.
         samples (int): the number of samples to return.
+        rng (None or int or numpy.random.SeedSequence or numpy.random.Generator): seed of the
+            streams of the samples; if ``None``, the samples are drawn from the global
+            generator of ``numpy.random``
 
     Returns
         (array): samples.
     """
-    return np.array([_hafnian_sample_graph_rank_one(G, n_mean) for _ in range(samples)])
+    if rng is None:
+        return np.array([_hafnian_sample_graph_rank_one(G, n_mean) for _ in range(samples)])
+    streams = row_streams(rng, samples)
+    return np.array([_hafnian_sample_graph_rank_one(G, n_mean, stream) for stream in streams])
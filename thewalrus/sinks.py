@@ -0,0 +1,208 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""
+Sample sinks
+============
+
+**Module name:** :mod:`thewalrus.sinks`
+
+.. currentmodule:: thewalrus.sinks
+
+This submodule writes the blocks of samples yielded by
+:func:`~thewalrus.samples.hafnian_sample_blocks` and
+:func:`~thewalrus.samples.torontonian_sample_blocks` to disk as they are drawn, so that the
+memory used by a sampling job depends on the size of a block and not on the number of samples.
+
+A sink stores the samples in a two-dimensional array of one row per sample, and records the
+number of rows written so far. A job that is interrupted is resumed by opening the sink again
+and drawing the samples from the row it stopped at, which the stream of every sample makes
+reproducible when the samplers are given an ``rng`` seed:
+
+.. code-block:: python
+
+    sink = NpySink("samples.npy", samples=10**7, modes=16)
+    blocks = hafnian_sample_blocks(cov, 10**7, start=sink.written, rng=2022)
+    write_samples(blocks, sink)
+
+:class:`NpySink` writes a memory-mapped ``.npy`` file with NumPy alone. :class:`HDF5Sink` and
+:class:`ZarrSink` write to a dataset of an HDF5 file or of a Zarr group, and require ``h5py`` or
+``zarr`` to be installed.
+
+Summary
+-------
+
+.. autosummary::
+    NpySink
+    HDF5Sink
+    ZarrSink
+    write_samples
+
+Code details
+------------
+"""
+import json
+import os
+
+import numpy as np
+
+
+class NpySink:
+    """Writes samples to a memory-mapped ``.npy`` file holding all of them, the number of rows
+    written being recorded in a ``.progress`` file next to it.
+
+    Args:
+        path (str): path of the ``.npy`` file; an existing file is resumed
+        samples (int): total number of samples
+        modes (int): number of modes of a sample
+        dtype (type): type of the photon counts
+
+    Raises:
+        ValueError: if an existing file has a different shape or type
+    """
+
+    def __init__(self, path, samples, modes, dtype=np.uint8):
+        self.path = path
+        self.progress = path + ".progress"
+        if os.path.exists(path):
+            self.array = np.lib.format.open_memmap(path, mode="r+")
+            if self.array.shape != (samples, modes) or self.array.dtype != np.dtype(dtype):
+                raise ValueError("The existing file holds samples of a different shape or type.")
+        else:
+            self.array = np.lib.format.open_memmap(
+                path, mode="w+", dtype=dtype, shape=(samples, modes)
+            )
+        self.written = 0
+        if os.path.exists(self.progress):
+            with open(self.progress, "r", encoding="utf-8") as file:
+                self.written = json.load(file)["written"]
+
+    def write(self, block):
+        """Writes a block of samples after the rows already written.
+
+        Args:
+            block (array): samples, one per row
+        """
+        self.array[self.written : self.written + len(block)] = block
+        self.array.flush()
+        self.written += len(block)
+        with open(self.progress + ".tmp", "w", encoding="utf-8") as file:
+            json.dump({"written": self.written}, file)
+        os.replace(self.progress + ".tmp", self.progress)
+
+    def close(self):
+        """Flushes the samples and releases the file."""
+        self.array.flush()
+        del self.array
+
+
+class HDF5Sink:
+    """Writes samples to a dataset of an HDF5 file, grown as the blocks are written, the number
+    of rows written being recorded in its ``written`` attribute.
+
+    Args:
+        path (str): path of the HDF5 file; an existing dataset is resumed
+        modes (int): number of modes of a sample
+        dtype (type): type of the photon counts
+        dataset (str): name of the dataset
+        chunk_rows (int): number of rows per HDF5 chunk
+    """
+
+    def __init__(self, path, modes, dtype=np.uint8, dataset="samples", chunk_rows=4096):
+        import h5py  # pylint: disable=import-outside-toplevel
+
+        self.file = h5py.File(path, "a")
+        if dataset not in self.file:
+            self.file.create_dataset(
+                dataset,
+                shape=(0, modes),
+                maxshape=(None, modes),
+                dtype=dtype,
+                chunks=(chunk_rows, modes),
+            )
+        self.dataset = self.file[dataset]
+        self.written = int(self.dataset.attrs.get("written", 0))
+
+    def write(self, block):
+        """Writes a block of samples after the rows already written.
+
+        Args:
+            block (array): samples, one per row
+        """
+        stop = self.written + len(block)
+        if self.dataset.shape[0] < stop:
+            self.dataset.resize(stop, axis=0)
+        self.dataset[self.written : stop] = block
+        self.dataset.attrs["written"] = stop
+        self.file.flush()
+        self.written = stop
+
+    def close(self):
+        """Flushes the samples and closes the file."""
+        self.file.close()
+
+
+class ZarrSink:
+    """Writes samples to an array of a Zarr group, grown as the blocks are written, the number
+    of rows written being recorded in its ``written`` attribute.
+
+    Args:
+        path (str): path of the Zarr group; an existing array is resumed
+        modes (int): number of modes of a sample
+        dtype (type): type of the photon counts
+        dataset (str): name of the array
+        chunk_rows (int): number of rows per Zarr chunk
+    """
+
+    def __init__(self, path, modes, dtype=np.uint8, dataset="samples", chunk_rows=4096):
+        import zarr  # pylint: disable=import-outside-toplevel
+
+        group = zarr.open_group(path, mode="a")
+        if dataset not in group:
+            group.zeros(dataset, shape=(0, modes), chunks=(chunk_rows, modes), dtype=dtype)
+        self.array = group[dataset]
+        self.written = int(self.array.attrs.get("written", 0))
+
+    def write(self, block):
+        """Writes a block of samples after the rows already written.
+
+        Args:
+            block (array): samples, one per row
+        """
+        stop = self.written + len(block)
+        if self.array.shape[0] < stop:
+            self.array.resize(stop, self.array.shape[1])
+        self.array[self.written : stop] = block
+        self.array.attrs["written"] = stop
+        self.written = stop
+
+    def close(self):
+        """Nothing to release, as every write is stored immediately."""
+
+
+def write_samples(blocks, sink):
+    """Writes blocks of samples to a sink as they are drawn, and closes the sink.
+
+    Args:
+        blocks (iterable[array]): blocks of samples, drawn from the row ``sink.written``
+        sink (NpySink or HDF5Sink or ZarrSink): the sink
+
+    Returns:
+        int: number of rows of the sink written, including those written before
+    """
+    try:
+        for block in blocks:
+            sink.write(block)
+    finally:
+        sink.close()
+    return sink.written
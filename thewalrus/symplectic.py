@@ -28,6 +28,7 @@ Auxiliary functions
     expand
     expand_vector
     expand_passive
+    expand_matmul
     reduced_state
     is_symplectic
     sympmat
@@ -49,6 +50,9 @@ Gates and operations
     squeezing
     interferometer
     loss
+    apply_symplectic
+    fuse_gates
+    apply_gates
     mean_photon_number
     beam_splitter
     rotation
@@ -159,6 +163,44 @@ def expand_passive(T, modes, N):
     return T_expand
 
 
+def _local_symplectic(S, modes):
+    r"""Returns the modes a symplectic matrix acts on and the matrix acting on all of them,
+    a single-mode symplectic given several modes acting on each of them as done by
+    :func:`expand`.
+
+    Args:
+        S (array): a :math:`2M\times 2M` Symplectic matrix
+        modes (int or Sequence[int]): the modes S acts on
+
+    Returns:
+        tuple[array, array]: the modes, and the symplectic matrix acting on them
+    """
+    w = np.array([modes]) if isinstance(modes, int) else np.array(modes)
+    if S.shape[0] == 2 and len(w) > 1:
+        S = expand(S, list(range(len(w))), len(w))
+    return w, S
+
+
+def expand_matmul(S, modes, A):
+    r"""Multiplies a matrix on the left by the expansion of a symplectic matrix, that is
+    returns ``expand(S, modes, N) @ A`` without building the :math:`2N\times 2N` expanded
+    matrix. Only the rows of ``A`` of the modes S acts on are computed, in
+    :math:`O(M^2)` operations per column instead of :math:`O(N^2)`.
+
+    Args:
+        S (array): a :math:`2M\times 2M` Symplectic matrix
+        modes (int or Sequence[int]): the modes S acts on
+        A (array): a matrix or a vector of :math:`2N` rows, updated in place
+
+    Returns:
+        array: the matrix ``A``
+    """
+    w, S = _local_symplectic(S, modes)
+    ind = np.concatenate([w, w + A.shape[0] // 2])
+    A[ind] = S @ A[ind]
+    return A
+
+
 def reduced_state(mu, cov, modes):
     r"""Returns the vector of means and the covariance matrix of the specified modes.
 
@@ -289,7 +331,7 @@ def interferometer(U):
     return S
 
 
-def passive_transformation(mu, cov, T, hbar=2):
+def passive_transformation(mu, cov, T, hbar=2, modes=None):
     r"""Perform a covariance matrix transformation for an arbitrary linear optical channel
     on an :math:`N` modes state mapping it to a to an :math:`M` modes state.
 
@@ -300,6 +342,9 @@ def passive_transformation(mu, cov, T, hbar=2):
 
     Keyword Args:
         hbar (float)=2: the value to use for hbar
+        modes (Sequence[int]): if given, the modes a square transformation ``T`` acts on, the
+            other modes being left unchanged; only the rows and columns of these modes are
+            updated
 
     Returns:
         array: :math:`2M`-length transformed means vector
@@ -309,6 +354,14 @@ def passive_transformation(mu, cov, T, hbar=2):
     P = interferometer(T)
     L = (hbar / 2) * (np.eye(P.shape[0]) - P @ P.T)
 
+    if modes is not None:
+        if T.shape[0] != T.shape[1] or len(modes) != T.shape[0]:
+            raise ValueError("A transformation of given modes must be square and act on them all.")
+        mu, cov = apply_symplectic(mu.copy(), cov.copy(), P, modes)
+        ind = np.concatenate([np.array(modes), np.array(modes) + len(mu) // 2])
+        cov[np.ix_(ind, ind)] += L
+        return mu, cov
+
     cov = P @ cov @ P.T + L
     mu = P @ mu
 
@@ -346,6 +399,87 @@ def loss(mu, cov, T, mode, nbar=0, hbar=2):
     return mu_res, cov_res
 
 
+def apply_symplectic(mu, cov, S, modes):
+    r"""Applies a symplectic transformation acting on a few modes to a Gaussian state, in place.
+
+    Only the rows and columns of the covariance matrix of these modes are updated, so that a
+    gate on :math:`M` of :math:`N` modes costs :math:`O(M^2 N)` operations instead of the
+    :math:`O(N^3)` of ``S2 @ cov @ S2.T`` with ``S2 = expand(S, modes, N)``.
+
+    Args:
+        mu (array): means vector, updated in place
+        cov (array): covariance matrix, updated in place
+        S (array): a :math:`2M\times 2M` Symplectic matrix
+        modes (int or Sequence[int]): the modes S acts on
+
+    Returns:
+        tuple[array]: the means vector and covariance matrix of the resulting state
+    """
+    w, S = _local_symplectic(S, modes)
+    ind = np.concatenate([w, w + len(mu) // 2])
+    mu[ind] = S @ mu[ind]
+    cov[ind, :] = S @ cov[ind, :]
+    cov[:, ind] = cov[:, ind] @ S.T
+    return mu, cov
+
+
+def fuse_gates(gates, max_modes=4):
+    r"""Fuses consecutive gates of a circuit into gates acting on up to ``max_modes`` modes.
+
+    Consecutive gates are multiplied together as long as the modes they act on add up to at
+    most ``max_modes``, so that a circuit of many gates on a few neighbouring modes is applied
+    to a state as a few larger gates, each touching the covariance matrix once. Fusing a gate
+    into a fused gate on :math:`M` modes costs :math:`O(M^3)` operations, and applying the
+    fused gate to a state of :math:`N` modes :math:`O(M^2 N)`.
+
+    Args:
+        gates (Iterable[tuple[array, Sequence[int]]]): the symplectic matrix and the modes of
+            each gate, in the order they are applied
+        max_modes (int): largest number of modes of a fused gate; a gate acting on more modes
+            is kept as it is
+
+    Returns:
+        list[tuple[array, list[int]]]: the fused gates, in the order they are applied
+    """
+    fused = []
+    current, current_modes = None, []
+    for S, modes in gates:
+        w, S = _local_symplectic(S, modes)
+        union = current_modes + [m for m in w.tolist() if m not in current_modes]
+        if current is not None and len(union) <= max_modes:
+            K = len(union)
+            positions = [union.index(m) for m in w.tolist()]
+            current = expand(S, positions, K) @ expand(current, list(range(len(current_modes))), K)
+            current_modes = union
+            continue
+        if current is not None:
+            fused.append((current, current_modes))
+        current, current_modes = S, w.tolist()
+    if current is not None:
+        fused.append((current, current_modes))
+    return fused
+
+
+def apply_gates(mu, cov, gates, max_modes=4):
+    r"""Applies a circuit of symplectic gates to a Gaussian state, in place, fusing
+    consecutive gates with :func:`fuse_gates` and applying each fused gate with
+    :func:`apply_symplectic`.
+
+    Args:
+        mu (array): means vector, updated in place
+        cov (array): covariance matrix, updated in place
+        gates (Iterable[tuple[array, Sequence[int]]]): the symplectic matrix and the modes of
+            each gate, in the order they are applied
+        max_modes (int): largest number of modes of a fused gate
+
+    Returns:
+        tuple[array]: the means vector and covariance matrix of the resulting state
+    """
+    for S, modes in fuse_gates(gates, max_modes=max_modes):
+        apply_symplectic(mu, cov, S, modes)
+    return mu, cov
+
+
 ### Comment: This function strongly overlaps with `quantum.photon_number_mean`
 ### Wonder if it is worth removing it.
 def mean_photon_number(mu, cov, hbar=2):
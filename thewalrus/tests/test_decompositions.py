@@ -19,7 +19,16 @@ from scipy.linalg import block_diag
 
 from thewalrus.random import random_interferometer as haar_measure
 from thewalrus.random import random_symplectic
-from thewalrus.decompositions import williamson, blochmessiah, takagi
+from thewalrus.decompositions import (
+    williamson,
+    blochmessiah,
+    takagi,
+    symplectic_eigenvals,
+    williamson_batch,
+    blochmessiah_batch,
+    takagi_batch,
+    symplectic_eigenvals_batch,
+)
 from thewalrus.symplectic import sympmat as omega
 from thewalrus.quantum.gaussian_checks import is_symplectic
 
@@ -434,3 +443,74 @@ def test_real_input_edge():
     # Now, reconstruct A, see
     Ar = u * l @ u.T
     assert np.allclose(A, Ar)
+
+
+@pytest.mark.parametrize("n", [1, 3, 5])
+def test_williamson_batch(n):
+    """Tests the batched Williamson decompositions of random covariance matrices reconstruct
+    them with symplectic matrices and ascending symplectic eigenvalues matching the unbatched
+    decompositions"""
+    batch = 6
+    V = []
+    for _ in range(batch):
+        S = random_symplectic(n)
+        V.append(S @ np.diag(np.tile(1 + np.random.rand(n), 2)) @ S.T)
+    V = np.array(V)
+    Db, S = williamson_batch(V)
+    for i in range(batch):
+        assert np.allclose(S[i] @ Db[i] @ S[i].T, V[i])
+        assert is_symplectic(S[i])
+        nus = np.diag(Db[i])[:n]
+        assert np.all(np.diff(nus) >= 0)
+        assert np.allclose(nus, np.sort(np.diag(williamson(V[i])[0])[:n]))
+    nus = symplectic_eigenvals_batch(V)
+    assert np.allclose(nus, np.diagonal(Db, axis1=1, axis2=2)[:, :n])
+    assert np.allclose(np.sort(symplectic_eigenvals(V[0])), nus[0])
+
+
+def test_williamson_batch_check():
+    """Tests the batched Williamson decomposition validates its inputs unless told not to"""
+    V = np.array([np.identity(4), -np.identity(4)])
+    with pytest.raises(ValueError, match="positive definite"):
+        williamson_batch(V)
+    with pytest.raises(ValueError, match="even number"):
+        williamson_batch(np.ones((1, 3, 3)))
+    Db, _ = williamson_batch(np.array([np.identity(4)]), check=False)
+    assert np.allclose(Db, np.identity(4))
+
+
+@pytest.mark.parametrize("n", [1, 4, 7])
+@pytest.mark.parametrize("svd_order", [True, False])
+@pytest.mark.parametrize("rank", ["full", "half"])
+def test_takagi_batch(n, svd_order, rank):
+    """Tests the batched Takagi decompositions of complex, real and rank deficient symmetric
+    matrices"""
+    batch = 5
+    A = []
+    for i in range(batch):
+        U = haar_measure(n) if i % 2 else haar_measure(n, real=True)
+        diags = np.random.rand(n)
+        if rank == "half":
+            diags[: n // 2] = 0
+        A.append(U @ np.diag(diags) @ U.T)
+    A = np.array(A)
+    r, U = takagi_batch(A, svd_order=svd_order)
+    for i in range(batch):
+        assert np.allclose(A[i], U[i] @ np.diag(r[i]) @ U[i].T)
+        assert np.allclose(U[i] @ U[i].T.conj(), np.eye(n))
+        assert np.allclose(r[i], takagi(A[i], svd_order=svd_order)[0])
+    assert np.all(r >= 0)
+
+
+def test_blochmessiah_batch():
+    """Tests the batched Bloch-Messiah decompositions of random symplectic matrices"""
+    n = 3
+    S = np.array([random_symplectic(n) for _ in range(4)])
+    uff, dff, vff = blochmessiah_batch(S)
+    for i in range(len(S)):
+        assert np.allclose(uff[i] @ dff[i] @ vff[i], S[i])
+        assert is_symplectic(uff[i]) and is_symplectic(vff[i])
+        assert np.allclose(uff[i] @ uff[i].T, np.identity(2 * n))
+        assert np.allclose(dff[i], np.diag(np.diag(dff[i])))
+    with pytest.raises(ValueError, match="not symplectic"):
+        blochmessiah_batch(2 * S)
@@ -35,3 +35,13 @@ def test_moments_of_distinguishable_distribution(M):
     expected_cov = number_cov(T, rs)
     assert np.allclose(expected_means, means, atol=4 / np.sqrt(num_samples))
     assert np.allclose(expected_cov, cov, atol=4 / np.sqrt(num_samples))
+
+
+def test_sample_rng():
+    """Test that the samples drawn from a seed only depend on the seed and on their index"""
+    M = 4
+    T = (unitary_group.rvs(M) * np.random.rand(M)) @ unitary_group.rvs(M)
+    rs = np.random.rand(M)
+    samples = sample(T, rs, n_samples=20, rng=3)
+    assert np.array_equal(samples, sample(T, rs, n_samples=20, rng=np.random.SeedSequence(3)))
+    assert np.array_equal(samples[:5], sample(T, rs, n_samples=5, rng=3))
@@ -0,0 +1,126 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Tests for the distributed evaluation of hafnians, torontonians and Bristolians"""
+# pylint: disable=no-self-use,redefined-outer-name
+import multiprocessing
+from concurrent.futures import ProcessPoolExecutor
+
+import pytest
+import numpy as np
+
+from thewalrus import hafnian, tor, ltor, brs
+from thewalrus.random import random_covariance
+from thewalrus.quantum import Qmat
+from thewalrus.distributed import (
+    step_ranges,
+    hafnian_steps,
+    distributed_sum,
+    distributed_hafnian,
+    distributed_tor,
+    distributed_ltor,
+    distributed_brs,
+)
+
+# ranges evaluated by ``counted_hafnian``, and range at which it fails if not ``None``
+calls = []
+failing_range = None
+
+
+def counted_hafnian(A, step_range):
+    """Partial hafnian recording the ranges it is called with"""
+    if step_range == failing_range:
+        raise RuntimeError("preempted")
+    calls.append(step_range)
+    return hafnian(A, step_range=step_range)
+
+
+def random_symmetric(n, dtype=np.complex128):
+    """Random symmetric matrix"""
+    A = np.random.rand(n, n) + (1j * np.random.rand(n, n) if dtype == np.complex128 else 0)
+    return A + A.T
+
+
+@pytest.mark.parametrize("n", [0, 1, 2, 7, 10])
+@pytest.mark.parametrize("loop", [True, False])
+@pytest.mark.parametrize("method", ["glynn", "inclexcl"])
+def test_hafnian_step_range(n, loop, method):
+    """Check the partial hafnians over disjoint ranges add up to the hafnian"""
+    A = random_symmetric(n)
+    steps = hafnian_steps(A, loop=loop, method=method)
+    partials = [hafnian(A, loop=loop, method=method, step_range=r) for r in step_ranges(steps, 3)]
+    assert np.allclose(sum(partials), hafnian(A, loop=loop, method=method))
+    assert np.allclose(hafnian(A, loop=loop, method=method, step_range=(steps, steps)), 0)
+
+
+def test_hafnian_step_range_valueerror():
+    """Check the unsupported or invalid step ranges raise errors"""
+    A = random_symmetric(6)
+    with pytest.raises(ValueError, match="only supported"):
+        hafnian(A, method="recursive", step_range=(0, 1))
+    with pytest.raises(ValueError, match="0 <= start <= stop"):
+        hafnian(A, step_range=(2, 1))
+
+
+@pytest.mark.parametrize("n_ranges", [1, 5, 64])
+def test_distributed_hafnian(n_ranges):
+    """Check the distributed hafnian matches the hafnian, with and without an executor"""
+    A = random_symmetric(12, dtype=np.float64)
+    expected = hafnian(A)
+    assert np.allclose(distributed_hafnian(A, n_ranges=n_ranges), expected)
+    with ProcessPoolExecutor(2, mp_context=multiprocessing.get_context("spawn")) as executor:
+        result = distributed_hafnian(A, n_ranges=n_ranges, executor=executor)
+    assert np.allclose(result, expected)
+    assert np.isrealobj(result)
+
+
+def test_distributed_tor_ltor():
+    """Check the distributed torontonians match the torontonians"""
+    cov = random_covariance(5)
+    O = np.eye(10) - np.linalg.inv(Qmat(cov))
+    gamma = np.random.rand(10) + 1j * np.random.rand(10)
+    assert np.allclose(tor(O, step_range=(0, 5)) + tor(O, step_range=(5, 32)), tor(O))
+    assert np.allclose(distributed_tor(O, n_ranges=7), tor(O))
+    assert np.allclose(distributed_ltor(O, gamma, n_ranges=7), ltor(O, gamma))
+
+
+def test_distributed_brs():
+    """Check the distributed Bristolian matches the Bristolian"""
+    A = np.random.rand(5, 3) + 1j * np.random.rand(5, 3)
+    E = np.random.rand(3, 3)
+    assert np.allclose(distributed_brs(A, E, n_ranges=6), brs(A, E))
+
+
+def test_checkpoint_resume(tmpdir):
+    """Check an interrupted sum resumes from its checkpoint without evaluating again the
+    ranges already done, and that a checkpoint cannot be resumed by a different sum"""
+    # pylint: disable=global-statement
+    global failing_range
+    A = random_symmetric(10)
+    checkpoint = str(tmpdir.join("haf.json"))
+    ranges = step_ranges(hafnian_steps(A), 4)
+
+    calls.clear()
+    failing_range = ranges[2]
+    with pytest.raises(RuntimeError, match="preempted"):
+        distributed_sum(counted_hafnian, (A,), hafnian_steps(A), 4, checkpoint=checkpoint)
+    assert calls == ranges[:2]
+
+    calls.clear()
+    failing_range = None
+    result = distributed_sum(counted_hafnian, (A,), hafnian_steps(A), 4, checkpoint=checkpoint)
+    assert calls == ranges[2:]
+    assert np.allclose(result, hafnian(A))
+
+    with pytest.raises(ValueError, match="different sum"):
+        distributed_sum(counted_hafnian, (2 * A,), hafnian_steps(A), 4, checkpoint=checkpoint)
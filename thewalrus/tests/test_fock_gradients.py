@@ -24,6 +24,16 @@ from thewalrus.fock_gradients import (
     grad_beamsplitter,
     mzgate,
     grad_mzgate,
+    displacement_batch,
+    grad_displacement_batch,
+    squeezing_batch,
+    grad_squeezing_batch,
+    two_mode_squeezing_batch,
+    grad_two_mode_squeezing_batch,
+    beamsplitter_batch,
+    grad_beamsplitter_batch,
+    mzgate_batch,
+    grad_mzgate_batch,
 )
 import numpy as np
 import pytest
@@ -336,3 +346,38 @@ def test_two_mode_squeezing_values(tol):
     T = two_mode_squeezing(r, theta, cutoff)
     expected = ((np.tanh(r) * np.exp(1j * theta)) ** np.arange(cutoff)) / np.cosh(r)
     assert np.allclose(np.diag(T[:, :, 0, 0]), expected, atol=tol, rtol=0)
+
+
+@pytest.mark.parametrize(
+    "gate, grad, batch, grad_batch, modes",
+    [
+        (displacement, grad_displacement, displacement_batch, grad_displacement_batch, 1),
+        (squeezing, grad_squeezing, squeezing_batch, grad_squeezing_batch, 1),
+        (
+            two_mode_squeezing,
+            grad_two_mode_squeezing,
+            two_mode_squeezing_batch,
+            grad_two_mode_squeezing_batch,
+            2,
+        ),
+        (beamsplitter, grad_beamsplitter, beamsplitter_batch, grad_beamsplitter_batch, 2),
+        (mzgate, grad_mzgate, mzgate_batch, grad_mzgate_batch, 2),
+    ],
+)
+def test_batched_gates(gate, grad, batch, grad_batch, modes):
+    """Tests the batched gates and gradients match the gates and gradients of each parameter
+    value, whatever was in the output arrays before"""
+    cutoff = 5
+    batch_size = 7
+    a = np.random.rand(batch_size)
+    b = 2 * np.pi * np.random.rand(batch_size)
+    shape = (batch_size,) + (cutoff,) * (2 * modes)
+    T = batch(a, b, np.full(shape, np.nan, dtype=np.complex128))
+    stale = np.ones(shape, dtype=np.complex128)
+    grad_a, grad_b = grad_batch(T, a, b, stale.copy(), stale.copy())
+    for i in range(batch_size):
+        expected = gate(a[i], b[i], cutoff)
+        assert np.allclose(T[i], expected)
+        expected_a, expected_b = grad(expected, a[i], b[i])
+        assert np.allclose(grad_a[i], expected_a)
+        assert np.allclose(grad_b[i], expected_b)
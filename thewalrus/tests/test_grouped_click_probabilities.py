@@ -2,11 +2,14 @@
 from itertools import product
 import numpy as np
 import pytest
-from thewalrus.random import random_interferometer
+from thewalrus.random import random_interferometer, philox_normals
 from thewalrus.symplectic import passive_transformation, squeezing
 from thewalrus.quantum import mean_clicks, variance_clicks
 from thewalrus._torontonian import threshold_detection_prob
-from thewalrus.grouped_click_probabilities import grouped_click_probabilities_squeezed
+from thewalrus.grouped_click_probabilities import (
+    grouped_click_probabilities,
+    grouped_click_probabilities_squeezed,
+)
 
 
 @pytest.mark.parametrize("num_modes", [4, 6, 8])
@@ -47,3 +50,29 @@ def test_probs(num_modes, eta, num_samples, num_groups):
     s_probs = grouped_click_probabilities_squeezed(sq_vec, tmat, num_samples, num_groups)[0]
     std_10 = 10 * (num_samples) ** (-0.5)
     assert np.allclose(t_probs, s_probs, rtol=std_10, atol=min(t_probs))
+
+
+@pytest.mark.parametrize("chunk_size", [1, 7, 256])
+def test_chunks_vs_transform(chunk_size):
+    """Tests the chunked probabilities match the transform of the characteristic function of
+    every sample, whatever the chunk size"""
+    num_modes, num_samples, num_groups, seed = 4, 300, 6, 2022
+    sq_vec = np.random.rand(num_modes)
+    tmat = 0.5 * random_interferometer(num_modes)
+    phn, chn = np.sinh(sq_vec) ** 2, 0.5 * np.sinh(2 * sq_vec)
+    drp, drm = np.sqrt(0.5 * (phn + chn) + 0j), np.sqrt(0.5 * (phn - chn) + 0j)
+    roots = np.exp(-2j * np.pi * np.arange(num_modes + 1) / (num_modes + 1))
+    dists = []
+    for j in range(num_samples):
+        wrp, wrm = np.array([philox_normals(seed, 0, j, i) for i in range(num_modes)]).T
+        alpha = tmat @ (drp * wrp + 1j * drm * wrm)
+        beta = tmat.conj() @ (drp * wrp - 1j * drm * wrm)
+        no_click = np.exp(-alpha * beta)
+        gth = np.prod(no_click + roots[:, None] * (1 - no_click), axis=1)
+        dists.append(np.fft.ifft(gth).real)
+    means = np.mean(np.reshape(dists, (num_groups, -1, num_modes + 1)), axis=1)
+    probs, errors = grouped_click_probabilities(
+        phn, chn, tmat, num_samples, num_groups, seed, chunk_size
+    )
+    assert np.allclose(probs, means.mean(axis=0))
+    assert np.allclose(errors, means.std(axis=0))
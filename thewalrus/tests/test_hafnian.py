@@ -25,6 +25,9 @@ from thewalrus._hafnian import _haf as jhaf
 from thewalrus._hafnian import loop_hafnian
 from thewalrus._hafnian import bandwidth
 from thewalrus._hafnian import recursive_hafnian
+from thewalrus._hafnian import gray_code_start, gray_code_next, find_kept_edges
+from thewalrus._hafnian import f, f_into, f_loop, f_loop_into, make_workspace
+from thewalrus._hafnian import sparse_hafnian, elimination_order, frontier_sizes
 
 # the first 11 telephone numbers
 T = [1, 1, 2, 4, 10, 26, 76, 232, 764, 2620, 9496]
@@ -314,6 +317,12 @@ class TestLoopHafnian:
         assert np.allclose(hafnian(A, loop=True), hafnian_sparse(A, loop=True))
         assert np.allclose(hafnian(A, loop=False), hafnian_sparse(A, loop=False))
 
+    @pytest.mark.parametrize("loop", [True, False])
+    def test_empty_submatrix(self, random_matrix, loop):
+        """Tests that the sparse hafnian of the empty submatrix is one"""
+        A = random_matrix(4, fill_factor=0.5)
+        assert hafnian_sparse(A, D=set(), loop=loop) == 1
+
 
 @pytest.mark.parametrize("n", [7, 8, 9, 10, 11, 12])
 @pytest.mark.parametrize("w", [1, 2, 3, 4, 5, 6])
@@ -347,6 +356,44 @@ def test_bandwidth_zero(N):
     assert np.allclose(result, expected)
 
 
+@pytest.mark.parametrize("n", [7, 8])
+@pytest.mark.parametrize("loop", [True, False])
+def test_real_kernels(n, loop):
+    """Check real matrices are handled in real arithmetic and agree with the complex kernels"""
+    A = np.random.rand(n, n)
+    A += A.T
+    haf = hafnian(A, loop=loop)
+    assert np.isrealobj(haf)
+    assert np.allclose(haf, hafnian(A.astype(np.complex128), loop=loop))
+
+
+@pytest.mark.parametrize("n", [7, 12])
+@pytest.mark.parametrize("loop", [True, False])
+def test_sparse_hafnian_orders(n, loop):
+    """Check the sparse hafnian does not depend on the elimination ordering"""
+    A = random_banded(n, 2)
+    perm = np.random.permutation(n)
+    A = A[np.ix_(perm, perm)]
+    expected = hafnian(A, loop=loop)
+    assert np.allclose(sparse_hafnian(A, loop=loop), expected)
+    assert np.allclose(sparse_hafnian(A, loop=loop, order=np.arange(n)), expected)
+    assert np.allclose(sparse_hafnian(A, loop=loop, order=np.random.permutation(n)), expected)
+
+
+@pytest.mark.parametrize("n", [10, 20])
+@pytest.mark.parametrize("w", [1, 3])
+def test_elimination_order_banded(n, w):
+    """Check the frontiers of a banded matrix in the natural order are bounded by the
+    bandwidth, and that the chosen elimination ordering is no more expensive"""
+    A = random_banded(n, w)
+    adjacency = A != 0
+    np.fill_diagonal(adjacency, False)
+    natural = frontier_sizes(adjacency, np.arange(n))
+    assert max(natural) == w
+    chosen = frontier_sizes(adjacency, elimination_order(A))
+    assert np.sum(2.0**chosen) <= np.sum(2.0**natural)
+
+
 def test_haf_edge_cases():
     """Tests hafnian and loop hafnian with no repetitions"""
     A = np.ones([2, 2])
@@ -368,3 +415,63 @@ def test_empty_matched_reps():
     assert x.shape == (0,)
     assert y.shape == (0,)
     assert z is None
+
+
+@pytest.mark.parametrize("bases", [[2, 2, 2], [3, 1, 4], [1, 2, 5, 3]])
+def test_gray_code_sequence(bases):
+    """Tests that the mixed-radix Gray code visits every kept-edge configuration exactly
+    once and that neighbouring configurations differ by one in a single digit"""
+    bases = np.array(bases, dtype=np.int64)
+    steps = np.prod(bases)
+    digits, gray, direction = gray_code_start(0, bases)
+    seen = {tuple(gray)}
+    for j in range(1, steps):
+        previous = gray.copy()
+        i = gray_code_next(digits, gray, direction, bases)
+        assert np.allclose(digits, find_kept_edges(j, bases - 1))
+        assert np.sum(np.abs(gray - previous)) == 1
+        assert abs(gray[i] - previous[i]) == 1
+        seen.add(tuple(gray))
+    assert len(seen) == steps
+
+
+@pytest.mark.parametrize("start", [0, 5, 11, 23])
+def test_gray_code_start(start):
+    """Tests that the Gray code state computed directly at an index matches the state
+    reached by stepping from the beginning of the sequence"""
+    bases = np.array([3, 2, 4], dtype=np.int64)
+    digits, gray, direction = gray_code_start(0, bases)
+    for _ in range(start):
+        gray_code_next(digits, gray, direction, bases)
+    expected_digits, expected_gray, expected_direction = gray_code_start(start, bases)
+    assert np.allclose(digits, expected_digits)
+    assert np.allclose(gray, expected_gray)
+    assert np.allclose(direction, expected_direction)
+
+
+@pytest.mark.parametrize("glynn", [True, False])
+def test_repeated_hafnian_gray_code(glynn):
+    """Tests the hafnian with high repetitions, where some kept-edge weights vanish,
+    against the hafnian of the explicitly repeated matrix"""
+    A = np.random.rand(3, 3)
+    A += A.T
+    reps = [4, 2, 2]
+    expected = hafnian(reduction(A, reps))
+    assert np.allclose(jhaf(A, reps=reps, glynn=glynn), expected)
+    expected_loop = hafnian(reduction(A, reps), loop=True)
+    assert np.allclose(loop_hafnian(A, D=np.diag(A), reps=reps, glynn=glynn), expected_loop)
+
+
+@pytest.mark.parametrize("n", [4, 10, 16])
+def test_f_into_workspace(n):
+    """Tests that the workspace variants of the eigenvalue-trace polynomials agree with the
+    allocating ones, including when one workspace is reused across calls"""
+    m = 4
+    AX = np.random.rand(m, m) + 1j * np.random.rand(m, m)
+    XD = np.random.rand(m) + 1j * np.random.rand(m)
+    D = np.random.rand(m) + 1j * np.random.rand(m)
+    comb, powtrace, mats, vecs, loop_vecs = make_workspace(AX, n)
+    for _ in range(2):
+        assert np.allclose(f_into(AX, n, comb, powtrace, mats, vecs), f(AX.copy(), n))
+        result = f_loop_into(AX, AX, XD, D, n, comb, powtrace, mats, vecs, loop_vecs)
+        assert np.allclose(result, f_loop(AX.copy(), AX, XD, D, n))
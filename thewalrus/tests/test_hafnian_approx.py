@@ -19,6 +19,7 @@ import numpy as np
 from scipy.special import factorial2, factorial as fac
 
 from thewalrus import hafnian
+from thewalrus._hafnian import hafnian_approx
 
 
 @pytest.mark.flaky()
@@ -55,3 +56,19 @@ def test_ones_approx(n):
     haf = hafnian(A, approx=True, num_samples=10000)
     expected = fac(2 * n) / (fac(n) * (2**n))
     assert np.abs(haf - expected) / expected < 0.2
+
+
+def test_approx_tolerance():
+    """Check the estimation stops once the standard error is below the tolerance, and that the
+    estimate only depends on the seed and not on the batches"""
+    A = np.float64(np.ones([12, 12]))
+    expected = fac(12) / (fac(6) * (2**6))
+    haf, error, count = hafnian_approx(A, num_samples=10**6, tol=0.05, rng=7, return_error=True)
+    assert count < 10**6
+    assert error <= 0.05 * abs(haf)
+    assert np.abs(haf - expected) / expected < 0.3
+
+    full = hafnian_approx(A, num_samples=1000, rng=7, batch_size=1000)
+    assert np.allclose(hafnian_approx(A, num_samples=1000, rng=7, batch_size=33), full)
+    haf = hafnian(A, approx=True, num_samples=10**6, approx_tol=0.05)
+    assert np.abs(haf - expected) / expected < 0.3
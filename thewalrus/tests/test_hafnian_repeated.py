@@ -18,8 +18,15 @@ from math import factorial as fac
 import pytest
 
 import numpy as np
-from thewalrus import hafnian_repeated
-from thewalrus._hafnian import _haf as jhaf
+from thewalrus import hafnian_repeated, hafnian, reduction
+from thewalrus._hafnian import (
+    _haf as jhaf,
+    set_dispatch_hook,
+    repeated_hafnian_costs,
+    collision_free_hafnian,
+    matching_count,
+    matching_hafnian,
+)
 
 
 # the first 11 telephone numbers
@@ -236,3 +243,65 @@ class TestHafnianRepeated:
         haf = hafnian_repeated(A, rpt)
         expected = np.prod(x) * fac(2 * n) / (fac(n) * (2**n))
         assert np.allclose(haf, expected)
+
+
+@pytest.mark.parametrize(
+    "rpt, loop",
+    [
+        ([1, 1, 0, 1, 1, 0], False),
+        ([2, 1, 0, 1, 3, 1], False),
+        ([1, 1, 0, 1, 1, 0], True),
+        ([2, 1, 0, 1, 3, 1], True),
+        ([1, 0, 1, 1, 0, 0], True),
+    ],
+)
+def test_collision_free_hafnian(rpt, loop):
+    """Check the collision-free strategy agrees with the hafnian of the expanded matrix"""
+    A = np.random.random([6, 6]) + 1j * np.random.random([6, 6])
+    A += A.T
+    mu = A.diagonal().copy()
+    haf = collision_free_hafnian(A, mu, np.array(rpt), loop=loop)
+    expected = hafnian(reduction(A, rpt), loop=loop)
+    assert np.allclose(haf, expected)
+
+
+@pytest.mark.parametrize("n", [1, 4, 5, 8])
+@pytest.mark.parametrize("loop", [False, True])
+def test_matching_hafnian(n, loop):
+    """Check the enumeration of the matchings agrees with the hafnian and keeps real
+    matrices real"""
+    A = np.random.random([n, n])
+    A += A.T
+    haf = matching_hafnian(A, loop=loop)
+    assert np.isrealobj(haf)
+    assert np.allclose(haf, hafnian(A, loop=loop))
+
+
+@pytest.mark.parametrize("n", range(11))
+def test_matching_count(n):
+    """Check the number of (loop) perfect matchings"""
+    assert matching_count(n, loop=True) == T[n]
+    expected = 0 if n % 2 else fac(n) // (fac(n // 2) * 2 ** (n // 2))
+    assert matching_count(n) == expected
+
+
+@pytest.mark.parametrize("loop", [False, True])
+def test_dispatch_hook(loop):
+    """Check the strategy picked from the estimated costs is reported to the debug hook"""
+    calls = []
+    previous = set_dispatch_hook(lambda *args: calls.append(args))
+    try:
+        A = np.random.random([4, 4])
+        A += A.T
+        haf = hafnian_repeated(A, [1, 1, 1, 1], loop=loop)
+        assert np.allclose(haf, hafnian(A, loop=loop))
+        hafnian_repeated(A, [4, 4, 2, 0], loop=loop)
+    finally:
+        set_dispatch_hook(previous)
+
+    assert [call[0] for call in calls] == ["hafnian_repeated"] * 2
+    assert calls[0][1] == "collision_free"
+    assert calls[0][2]["collision_free"] < calls[0][2]["repeated"]
+    assert calls[1][1] == "repeated"
+    assert calls[1][2] == repeated_hafnian_costs(np.array([4, 4, 2, 0]), loop=loop)
+    assert calls[1][2]["repeated"] < calls[1][2]["collision_free"]
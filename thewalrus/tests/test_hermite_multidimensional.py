@@ -18,7 +18,7 @@ import pytest
 
 import numpy as np
 
-from scipy.special import eval_hermitenorm, eval_hermite
+from scipy.special import eval_hermitenorm, eval_hermite, factorial
 
 from thewalrus import (
     hermite_multidimensional,
@@ -26,6 +26,9 @@ from thewalrus import (
     hafnian_batched,
     hafnian_repeated,
     grad_hermite_multidimensional,
+    hermite_multidimensional_total,
+    grad_hermite_multidimensional_total,
+    TotalCutoffTensor,
 )
 from thewalrus.random import random_interferometer
 
@@ -239,3 +242,64 @@ def test_interferometer_vs_hermite_multidimensional(renorm, cutoff):
     hermite_renorm = hermite_multidimensional(R, cutoff, y=None, renorm=renorm)
     interf_renorm = interferometer(R, cutoff, renorm=renorm)
     assert np.allclose(hermite_renorm, interf_renorm)
+
+
+def test_hermite_layers_beyond_one_tile():
+    """Test the layer-parallel recursion on photon number layers spanning several tiles, with
+    uneven cutoffs, against hafnian_repeated and the normalized polynomials"""
+    n_modes = 5
+    cutoffs = (7, 6, 7, 5, 6)
+    A = np.random.rand(n_modes, n_modes) + 1j * np.random.rand(n_modes, n_modes)
+    A += A.T
+    A /= 4
+    mu = np.random.rand(n_modes) + 1j * np.random.rand(n_modes)
+    values = hafnian_batched(A, cutoffs, mu=mu)
+    renorm = hafnian_batched(A, cutoffs, mu=mu, renorm=True)
+    assert values.shape == cutoffs
+    for _ in range(10):
+        k = tuple(np.random.randint(c) for c in cutoffs)
+        expected = hafnian_repeated(A, k, mu=mu, loop=True)
+        assert np.allclose(values[k], expected)
+        norm = np.sqrt(np.prod(factorial(k)))
+        assert np.allclose(renorm[k], expected / norm)
+
+
+def test_total_cutoff_layout():
+    """Test every multi-index of total at most the cutoff is stored once, at its rank, sorted by
+    total photon number"""
+    n_modes, max_photons = 4, 5
+    tensor = TotalCutoffTensor(
+        np.arange(TotalCutoffTensor.size(n_modes, max_photons)), n_modes, max_photons
+    )
+    indices = tensor.multi_indices()
+    expected = [k for k in product(range(max_photons + 1), repeat=n_modes) if sum(k) <= max_photons]
+    assert len(indices) == len(expected) == 126
+    assert {tuple(k) for k in indices} == set(expected)
+    assert np.all(np.diff(indices.sum(axis=1)) >= 0)
+    for f, k in enumerate(indices):
+        assert tensor.index(k) == f
+        assert tensor[k] == f
+    with pytest.raises(IndexError, match="not stored"):
+        tensor.index((3, 3, 0, 0))
+
+
+@pytest.mark.parametrize("renorm", [True, False])
+def test_hermite_multidimensional_total_vs_dense(renorm):
+    """Test the packed polynomials and their gradients match the dense ones below the total
+    photon number cutoff"""
+    n_modes, max_photons = 4, 6
+    R = np.random.rand(n_modes, n_modes) + 1j * np.random.rand(n_modes, n_modes)
+    R = (R + R.T) / 4
+    y = np.random.rand(n_modes) + 1j * np.random.rand(n_modes)
+    dense = hermite_multidimensional(R, max_photons + 1, y=y, renorm=renorm, modified=True)
+    packed = hermite_multidimensional_total(R, max_photons, y=y, renorm=renorm, modified=True)
+    indices = packed.multi_indices()
+    assert np.allclose(packed.values, dense[tuple(indices.T)])
+    kept = np.sum(np.indices(dense.shape), axis=0) <= max_photons
+    assert np.allclose(packed.to_dense(), np.where(kept, dense, 0))
+    assert np.allclose(TotalCutoffTensor.from_dense(dense, max_photons).values, packed.values)
+
+    dG_dC, dG_dR, dG_dy = grad_hermite_multidimensional(dense, R, y, renorm=renorm)
+    grads = grad_hermite_multidimensional_total(packed, R, y, renorm=renorm)
+    for dense_grad, packed_grad in zip((dG_dC, dG_dR, dG_dy), grads):
+        assert np.allclose(packed_grad.values, dense_grad[tuple(indices.T)])
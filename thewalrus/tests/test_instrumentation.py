@@ -0,0 +1,92 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Tests for the instrumentation of the kernels and their compilation ahead of use"""
+# pylint: disable=no-self-use,redefined-outer-name
+import numba
+import numpy as np
+import pytest
+
+from thewalrus import hafnian, perm, tor, precompile
+from thewalrus.distributed import hafnian_steps
+from thewalrus.instrumentation import enabled, instrument, instrumented, reset, stats
+
+
+@pytest.fixture(autouse=True)
+def clean_stats():
+    """Removes the statistics recorded by each test"""
+    reset()
+    yield
+    reset()
+
+
+def test_disabled():
+    """Check nothing is recorded unless the instrumentation is enabled"""
+    hafnian(np.ones((6, 6)))
+    assert not enabled()
+    assert stats() == {}
+
+
+def test_calls_and_steps():
+    """Check the calls and steps of the instrumented kernels are recorded and sent to the sink"""
+    events = []
+    A = np.random.rand(8, 8)
+    A = A + A.T
+    with instrument(sink=events.append):
+        assert enabled()
+        hafnian(A)
+        hafnian(A)
+        hafnian(A, loop=True)
+        perm(A, method="ryser")
+        tor(0.02 * A)
+    assert not enabled()
+
+    record = stats()
+    assert record["_haf"]["calls"] == 2
+    assert record["_haf"]["steps"] == 2 * hafnian_steps(A)
+    assert record["loop_hafnian"]["steps"] == hafnian_steps(A, loop=True)
+    assert record["perm"]["steps"] == 2**8
+    assert record["tor"]["steps"] == 2**4
+    assert all(record[kernel]["wall_time"] > 0 for kernel in ["_haf", "perm", "tor"])
+    calls = [event for event in events if event["kind"] == "call"]
+    assert [event["kernel"] for event in calls] == ["_haf", "_haf", "loop_hafnian", "perm", "tor"]
+
+
+def test_compile_time():
+    """Check the compilations happening during an instrumented call are recorded"""
+
+    @numba.jit(nopython=True)
+    def double(x):
+        return 2 * x
+
+    traced = instrumented("double", steps=lambda x: 1)(double)
+    with instrument():
+        assert traced(3) == 6
+        assert traced(4) == 8
+    record = stats()
+    name = f"{double.py_func.__module__}.{double.py_func.__qualname__}"
+    assert record[name]["compilations"] == 1
+    assert record["double"]["calls"] == 2
+    assert record["double"]["steps"] == 2
+    assert 0 < record["double"]["compile_time"] == record[name]["compile_time"]
+
+
+def test_precompile():
+    """Check the kernels are compiled ahead of use, and that unknown kernels raise an error"""
+    times = precompile(
+        kernels=["permanent"],
+        signatures={"thewalrus._permanent.perm_ryser": ["(float64[:, :],)"]},
+    )
+    assert set(times) == {"permanent", "thewalrus._permanent.perm_ryser"}
+    with pytest.raises(ValueError, match="Unknown kernels"):
+        precompile(kernels=["pfaffian"])
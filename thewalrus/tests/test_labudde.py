@@ -72,3 +72,42 @@ def test_powtrace_4by4(n):
         assert np.allclose(pow_trace_lab[-1], 301.18)
     if n == 4:
         assert np.allclose(pow_trace_lab[-1], 81466.1)
+
+
+@pytest.mark.parametrize("n", [2, 3, 4, 7])
+@pytest.mark.parametrize("real", [True, False])
+def test_powertrace_into(n, real):
+    """Test that powertrace_into reproduces powertrace, reusing one workspace and leaving
+    its input untouched"""
+    mat = np.random.rand(4, 4) + (0 if real else 1j * np.random.rand(4, 4))
+    mat_copy = mat.copy()
+    mats, vecs = thewalrus.charpoly.powertrace_workspace(mat)
+    pow_traces = np.zeros(max(n, 2), dtype=mat.dtype)
+    for _ in range(2):
+        thewalrus.charpoly.powertrace_into(mat, n, pow_traces, mats, vecs)
+        assert np.allclose(mat, mat_copy)
+    expected = [np.trace(np.linalg.matrix_power(mat, k)) for k in range(max(n, 2))]
+    assert np.allclose(pow_traces, expected)
+
+
+def test_matmul_split_into():
+    """Test the product of complex matrices stored as real and imaginary planes"""
+    X = np.random.rand(5, 5) + 1j * np.random.rand(5, 5)
+    Y = np.random.rand(5, 5) + 1j * np.random.rand(5, 5)
+    out_r, out_i = np.ones((5, 5)), np.ones((5, 5))
+    thewalrus.charpoly.matmul_split_into(X.real, X.imag, Y.real, Y.imag, out_r, out_i)
+    assert np.allclose(out_r + 1j * out_i, X @ Y)
+
+
+def test_powertrace_and_hafnian_real():
+    """Test the power traces and the hafnian of a real float64 matrix, for which only the
+    real kernel is compiled"""
+    mat = np.random.rand(6, 6)
+    mat = mat + mat.T
+    pow_traces = thewalrus.charpoly.powertrace(mat, 8)
+    assert pow_traces.dtype == np.float64
+    expected = [np.trace(np.linalg.matrix_power(mat, k)) for k in range(8)]
+    assert np.allclose(pow_traces, expected)
+    haf = thewalrus.hafnian(mat)
+    assert np.isrealobj(haf)
+    assert np.allclose(haf, thewalrus.reference.hafnian(mat))
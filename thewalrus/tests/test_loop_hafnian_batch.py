@@ -0,0 +1,43 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Tests for the batched loop hafnians of the chain-rule samplers"""
+import pytest
+import numpy as np
+
+from thewalrus.loop_hafnian_batch import loop_hafnian_batch
+from thewalrus.loop_hafnian_batch_gamma import loop_hafnian_batch_gamma, LoopHafnianBatchContext
+
+
+@pytest.mark.parametrize(
+    "pattern", [[], [0], [1], [0, 0, 0], [2, 0, 1], [1, 1, 0, 3], [0, 2, 0, 2, 1]]
+)
+@pytest.mark.parametrize("cutoff", [3, 4])
+def test_context_matches_loop_hafnian_batch(pattern, cutoff):
+    """Check the batches of a context match those evaluated from scratch, including when a
+    prepared pattern is reused"""
+    n = 6
+    A = np.random.rand(n, n) + 1j * np.random.rand(n, n)
+    A += A.T
+    gamma = np.random.rand(3, n) + 1j * np.random.rand(3, n)
+    m = len(pattern) + 1
+    context = LoopHafnianBatchContext(A, cutoff, max_patterns=2)
+
+    expected = loop_hafnian_batch(A[:m, :m], gamma[0, :m], pattern, cutoff)
+    expected_gamma = loop_hafnian_batch_gamma(A[:m, :m], gamma[:, :m], pattern, cutoff)
+    for _ in range(2):
+        assert np.allclose(context.batch(gamma[0, :m], pattern), expected)
+        assert np.allclose(context.batch_gamma(gamma[:, :m], pattern), expected_gamma)
+    context.prepare([0] * 5)
+    context.prepare([1] * 5)
+    assert len(context._prepared) == 2  # pylint: disable=protected-access
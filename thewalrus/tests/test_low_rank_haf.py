@@ -55,3 +55,14 @@ def test_rank_r(r, n):
     haf = low_rank_hafnian(G)
     expected = hafnian(A)
     assert np.allclose(haf, expected)
+
+
+@pytest.mark.parametrize("n", [0, 2, 8, 12])
+@pytest.mark.parametrize("r", [4, 6])
+@pytest.mark.parametrize("dtype", [np.float64, np.complex128])
+def test_higher_rank(r, n, dtype):
+    """Test the compiled expansion for higher ranks and real factorizations"""
+    G = np.random.rand(n, r) + (1j * np.random.rand(n, r) if dtype == np.complex128 else 0)
+    haf = low_rank_hafnian(G)
+    expected = hafnian(G @ G.T)
+    assert np.allclose(haf, expected)
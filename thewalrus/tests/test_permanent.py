@@ -24,8 +24,17 @@ from scipy.special import factorial as fac
 from scipy.linalg import sqrtm
 from scipy.stats import unitary_group
 
-from thewalrus import perm, permanent_repeated, brs, ubrs
-from thewalrus._permanent import fock_prob, fock_threshold_prob
+from thewalrus import perm, permanent_repeated, brs, ubrs, hafnian_repeated
+from thewalrus._hafnian import set_dispatch_hook
+from thewalrus._permanent import (
+    fock_prob,
+    fock_prob_batch,
+    fock_threshold_prob,
+    perm_ryser,
+    perm_bbfg,
+    perm_ryser_gray,
+    perm_bbfg_gray,
+)
 
 perm_real = perm
 perm_complex = perm
@@ -151,6 +160,27 @@ class TestPermanentWrapper:
         expected = perm_BBFG_real(A.real)
         assert np.allclose(p, expected)
 
+    @pytest.mark.parametrize("dtype", [np.float64, np.complex128])
+    @pytest.mark.parametrize("n", [1, 4, 7])
+    @pytest.mark.parametrize("n_chunks", [1, 5, 512])
+    @pytest.mark.parametrize("extended", [False, True])
+    def test_gray_kernels(self, random_matrix, n, n_chunks, extended):
+        """Check the parallel Gray code kernels agree with the serial ones"""
+        A = random_matrix(n)
+        expected = perm_ryser(A)
+        assert np.allclose(perm_ryser_gray(A, n_chunks, extended), expected)
+        assert np.allclose(perm_bbfg_gray(A, n_chunks, extended), expected)
+        assert np.allclose(perm_bbfg(A), expected)
+
+    @pytest.mark.parametrize("method", ["ryser", "bbfg"])
+    def test_integer_matrix(self, method):
+        """Check the permanent of an integer matrix"""
+        A = np.ones((5, 5), dtype=int)
+        assert np.isclose(perm(A, method=method), fac(5))
+        assert perm(A, method=method) == 120
+        assert isinstance(perm(A, method=method), np.integer)
+        assert np.isclose(perm(A, method=method, extended=True), fac(5))
+
 
 class TestPermanentRepeated:
     """Tests for the repeated permanent"""
@@ -190,6 +220,53 @@ class TestPermanentRepeated:
         assert np.allclose(p, fac(n))
 
 
+@pytest.mark.parametrize("rpt", [[2, 0, 1, 3], [0, 5, 0, 0]])
+def test_permanent_repeated_strategies(rpt):
+    """Check the direct Glynn strategy of permanent_repeated agrees with the hafnian strategy
+    and is reported to the debug hook"""
+    calls = []
+    previous = set_dispatch_hook(lambda *args: calls.append(args))
+    try:
+        A = np.random.random([4, 4]) + 1j * np.random.random([4, 4])
+        p = permanent_repeated(A, rpt)
+    finally:
+        set_dispatch_hook(previous)
+
+    B = np.block([[np.zeros((4, 4)), A], [A.T, np.zeros((4, 4))]])
+    assert np.allclose(p, hafnian_repeated(B, rpt * 2))
+    assert calls[0][0] == "permanent_repeated"
+    assert calls[0][1] == "glynn"
+    assert calls[0][2]["glynn"] < calls[0][2]["hafnian"]
+
+
+def test_permanent_repeated_real():
+    """Check the direct Glynn strategy of permanent_repeated keeps real matrices real"""
+    A = np.random.random([4, 4])
+    rpt = [2, 0, 1, 3]
+    p = permanent_repeated(A, rpt)
+    B = np.block([[np.zeros((4, 4)), A], [A.T, np.zeros((4, 4))]])
+    assert np.isrealobj(p)
+    assert np.allclose(p, hafnian_repeated(B, rpt * 2))
+
+
+@pytest.mark.parametrize("rpt", [[1, 1, 1, 1], [1, 0, 1, 1], [0, 0, 1, 0]])
+def test_permanent_repeated_no_repetitions(rpt):
+    """Check permanent_repeated computes the permanent of the selected submatrix directly when
+    no row is repeated"""
+    calls = []
+    previous = set_dispatch_hook(lambda *args: calls.append(args))
+    try:
+        A = np.random.random([4, 4]) + 1j * np.random.random([4, 4])
+        p = permanent_repeated(A, rpt)
+    finally:
+        set_dispatch_hook(previous)
+
+    kept = np.nonzero(rpt)[0]
+    assert np.allclose(p, perm(A[np.ix_(kept, kept)]))
+    assert len(calls) == 1
+    assert calls[0][:2] == ("permanent_repeated", "permanent")
+
+
 def test_brs_HOM():
     """HOM test"""
 
@@ -298,6 +375,20 @@ def test_brs_ubrs(d):
     assert np.allclose(b1, b2)
 
 
+def test_brs_ubrs_real():
+    """test that brs and ubrs of real matrices are real and agree with the complex kernels"""
+    A = np.random.random([3, 4])
+    E = np.random.random([4, 4])
+
+    b = brs(A, E)
+    assert np.isrealobj(b)
+    assert np.allclose(b, brs(A.astype(np.complex128), E))
+
+    b = ubrs(A)
+    assert np.isrealobj(b)
+    assert np.allclose(b, ubrs(A.astype(np.complex128)))
+
+
 @pytest.mark.parametrize("M", range(2, 7))
 def test_brs_random(M):
     """test that brs and per agree for random matices"""
@@ -370,3 +461,29 @@ def test_fock_prob_valueerror():
         U = np.eye((4))
 
         fock_prob(n, m, U)
+
+
+@pytest.mark.parametrize("n", [[1, 1, 1, 0, 0], [3, 0, 1, 0, 0], [0, 0, 0, 0, 0]])
+def test_fock_prob_batch(n):
+    """test that the batched probabilities agree with fock_prob, including output patterns
+    with repeated modes"""
+    M = len(n)
+    U = unitary_group.rvs(M)
+    patterns = np.array([m for m in product(range(sum(n) + 1), repeat=M) if sum(m) == sum(n)])
+    probs = fock_prob_batch(n, patterns, U)
+    expected = np.array([fock_prob(n, m, U) for m in patterns])
+    assert np.allclose(probs, expected)
+    assert np.isclose(probs.sum(), 1)
+
+
+def test_fock_prob_batch_valueerror():
+    """test that input checks are raised"""
+    U = np.eye(3)
+    with pytest.raises(ValueError):
+        fock_prob_batch([1, 1, 0], [[1, 0, 0]], U)
+
+    with pytest.raises(ValueError):
+        fock_prob_batch([1, 1, 0], [1, 1, 0], U)
+
+    with pytest.raises(ValueError):
+        fock_prob_batch([1, 1], [[1, 1]], U)
@@ -77,6 +77,8 @@ from thewalrus.quantum import (
     n_body_marginals,
     click_cumulant,
     is_symplectic,
+    photon_number_covar,
+    photon_number_cumulant,
 )
 
 
@@ -752,6 +754,39 @@ def test_state_vector_coherent():
     assert np.allclose(exact, num)
 
 
+def test_state_vector_max_photons():
+    """Tests the packed state vector of a total photon number cutoff matches the dense one"""
+    max_photons = 4
+    S = random_symplectic(3)
+    cov = S @ S.T
+    mu = np.array([0.2, -0.1, 0.3, 0.1, 0.0, -0.2])
+    dense = state_vector(mu, cov, cutoff=max_photons + 1)
+    packed = state_vector(mu, cov, max_photons=max_photons)
+    kept = np.sum(np.indices(dense.shape), axis=0) <= max_photons
+    assert np.allclose(packed.to_dense(), np.where(kept, dense, 0))
+    normalized = state_vector(mu, cov, max_photons=max_photons, normalize=True)
+    assert np.allclose(np.linalg.norm(normalized.values), 1)
+    with pytest.raises(ValueError, match="not supported with post-selection"):
+        state_vector(mu, cov, post_select={0: 1}, max_photons=max_photons)
+
+
+def test_post_selected_vs_elements():
+    """Tests the post-selected state vector and density matrix of a random state match the
+    amplitudes and elements evaluated one at a time"""
+    cutoff = 3
+    post_select = {1: 2}
+    S = random_symplectic(3)
+    mu = 0.3 * (np.random.rand(6) - 0.5)
+    psi = state_vector(mu, S @ S.T, post_select=post_select, cutoff=cutoff)
+    cov = random_covariance(3, pure=False)
+    rho = density_matrix(mu, cov, post_select=post_select, cutoff=cutoff)
+    for i, j, k, l in product(range(cutoff), repeat=4):
+        amplitude = pure_state_amplitude(mu, S @ S.T, [i, 2, j])
+        assert np.allclose(psi[i, j], amplitude)
+        element = density_matrix_element(mu, cov, [j, 2, l], [i, 2, k])
+        assert np.allclose(rho[i, j, k, l], element)
+
+
 def test_state_vector_two_mode_squeezed_post_normalize():
     """Tests state_vector for a two mode squeezed vacuum state"""
     nbar = 1.0
@@ -1133,6 +1168,19 @@ def test_pnd_squeeze_displace(tol, r, phi, alpha, hbar):
     assert np.isclose(photon_number_mean(mu, cov, 0, hbar=hbar), mean_analytic, atol=tol, rtol=0)
 
 
+@pytest.mark.parametrize("hbar", [1, 2])
+def test_probabilities_mixed_vs_density_matrix_element(hbar):
+    """Tests the probabilities of a random mixed state, read from the diagonal of its density
+    matrix, match the density matrix elements evaluated one at a time"""
+    cutoff = 4
+    cov = random_covariance(3, hbar=hbar, pure=False)
+    mu = 0.3 * (np.random.rand(6) - 0.5)
+    probs = probabilities(mu, cov, cutoff, hbar=hbar)
+    for i in product(range(cutoff), repeat=3):
+        expected = np.real_if_close(density_matrix_element(mu, cov, i, i, hbar=hbar))
+        assert np.allclose(probs[i], expected)
+
+
 @pytest.mark.parametrize("hbar", [0.1, 1, 2])
 def test_photon_number_covmat_random_state(hbar):
     """Tests the photon number covariances of 2-mode random state"""
@@ -1842,6 +1890,34 @@ def test_click_cumulants(disp_scale, hbar):
     assert np.allclose(expected, obtained)
 
 
+@pytest.mark.parametrize("hbar", [0.5, 2.0])
+def test_photon_number_covmat_vs_covar(hbar):
+    """Tests the vectorised photon number covariance matrix matches the covariances of each
+    pair of modes"""
+    M = 4
+    cov = random_covariance(M, hbar=hbar)
+    mu = np.random.rand(2 * M) - 0.5
+    covmat = photon_number_covmat(mu, cov, hbar=hbar)
+    for j, k in product(range(M), repeat=2):
+        assert np.allclose(covmat[j, k], photon_number_covar(mu, cov, j, k, hbar=hbar))
+
+
+def test_cumulant_cache():
+    """Tests the cumulants sharing a cache of moments match the cumulants computed alone, and
+    that the cache holds one entry per multiset of modes"""
+    M = 3
+    cov = random_covariance(M)
+    mu = 0.5 * (np.random.rand(2 * M) - 0.5)
+    photon_cache, click_cache = {}, {}
+    for modes in [[0, 1, 2], [0, 0, 1], [2, 1, 0]]:
+        expected = photon_number_cumulant(mu, cov, modes)
+        assert np.allclose(photon_number_cumulant(mu, cov, modes, cache=photon_cache), expected)
+        expected = click_cumulant(mu, cov, modes)
+        assert np.allclose(click_cumulant(mu, cov, modes, cache=click_cache), expected)
+    assert set(click_cache) == {(0,), (1,), (2,), (0, 1), (0, 2), (1, 2), (0, 1, 2)}
+    assert (0, 0) in photon_cache and (0, 0, 1) in photon_cache
+
+
 @pytest.mark.parametrize("hbar", [0.5, 1.0, 2.0, 1.7])
 def test_single_mode_first_and_second_cumulant(hbar):
     """Tests the first and second order cumulants of a single mode are the mean and variance"""
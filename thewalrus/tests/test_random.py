@@ -15,7 +15,14 @@
 import pytest
 
 import numpy as np
-from thewalrus.random import random_block_interferometer, random_banded_interferometer
+from thewalrus.random import (
+    random_block_interferometer,
+    random_banded_interferometer,
+    philox4x32,
+    philox_uniforms,
+    sample_streams,
+    seed_sequence,
+)
 
 
 def bandwidth(A):
@@ -66,3 +73,39 @@ def test_wrong_bandwidth():
         ValueError, match="The bandwidth can be at most one minus the size of the matrix."
     ):
         random_banded_interferometer(n, w)
+
+
+@pytest.mark.parametrize(
+    "counter, key, expected",
+    [
+        ([0, 0, 0, 0], [0, 0], [0x6627E8D5, 0xE169C58D, 0xBC57AC4C, 0x9B00DBD8]),
+        ([0xFFFFFFFF] * 4, [0xFFFFFFFF] * 2, [0x408F276D, 0x41C83B0E, 0xA20BC7C6, 0x6D5451FD]),
+        (
+            [0x243F6A88, 0x85A308D3, 0x13198A2E, 0x03707344],
+            [0xA4093822, 0x299F31D0],
+            [0xD16CFE09, 0x94FDCCEB, 0x5001E420, 0x24126EA1],
+        ),
+    ],
+)
+def test_philox4x32(counter, key, expected):
+    """Tests the Philox4x32-10 block function against the known answers of Random123"""
+    assert [int(word) for word in philox4x32(*counter, *key)] == expected
+
+
+def test_philox_uniforms():
+    """Tests the uniform random numbers of the compiled streams are in [0, 1) and differ
+    between samples and draws"""
+    values = np.array([philox_uniforms(1, 2, i, d) for i in range(50) for d in range(4)])
+    assert np.all((values >= 0) & (values < 1))
+    assert len(np.unique(values)) == values.size
+
+
+def test_sample_streams():
+    """Tests the stream of a sample only depends on the seed and on its index"""
+    seed = seed_sequence(42)
+    first = [g.random() for g in sample_streams(seed, 0, 6)]
+    last = [g.random() for g in sample_streams(seed, 3, 6)]
+    assert first[3:] == last
+    assert len(set(first)) == 6
+    generator = np.random.default_rng(7)
+    assert seed_sequence(generator).entropy != seed_sequence(generator).entropy
@@ -13,12 +13,14 @@
 # limitations under the License.
 """Tests for the Python reference hafnian functions"""
 # pylint: disable=no-self-use,redefined-outer-name
+from concurrent.futures import ThreadPoolExecutor
+
 import pytest
 
 import numpy as np
 from scipy.special import factorial2
 
-from thewalrus.reference import T, spm, pmp, hafnian
+from thewalrus.reference import T, spm, pmp, hafnian, memoized, partitions
 
 
 class TestReferenceHafnian:
@@ -56,3 +58,31 @@ class TestReferenceHafnian:
         r"""Checks that the loop hafnian of the all ones matrix of size n is T(n)"""
         M = np.ones([n, n])
         assert np.allclose(T(n), hafnian(M, loop=True))
+
+
+class TestMemoized:
+    """Tests for the memoization of the reference functions"""
+
+    def test_size_limit(self):
+        r"""Checks the cache keeps at most maxsize results, discarding the least recently used"""
+        calls = []
+
+        def double(n):
+            calls.append(n)
+            return 2 * n
+
+        cached = memoized(double, maxsize=2)
+        assert [cached(n) for n in [1, 2, 1, 3, 1, 2]] == [2, 4, 2, 6, 2, 4]
+        assert calls == [1, 2, 3, 2]
+        assert cached.cache_info() == (2, 4, 2, 2)
+        cached.cache_clear()
+        assert cached.cache_info() == (0, 0, 2, 0)
+
+    def test_generator_threads(self):
+        r"""Checks a memoized generator gives all its values to every call, from several threads"""
+        s = tuple(range(8))
+        expected = sorted(partitions(s))
+        with ThreadPoolExecutor(4) as executor:
+            results = list(executor.map(lambda _: sorted(partitions(s)), range(8)))
+        assert all(result == expected for result in results)
+        assert partitions.cache_info().hits > 0
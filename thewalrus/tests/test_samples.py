@@ -28,10 +28,14 @@ from thewalrus.samples import (
     seed,
     photon_number_sampler,
     generate_hafnian_sample,
+    generate_hafnian_samples,
+    hafnian_rejection_rate,
+    prepare_hafnian_sampling,
     generate_torontonian_sample,
     hafnian_sample_graph_rank_one,
 )
 from thewalrus.quantum import gen_Qmat_from_graph, density_matrix_element, probabilities
+from thewalrus.random import sample_streams
 from thewalrus.symplectic import two_mode_squeezing
 
 seed(137)
@@ -117,7 +121,8 @@ class TestHafnianSampling:
             rel_freq, x2, atol=rel_tol / np.sqrt(n_samples), rtol=rel_tol / np.sqrt(n_samples)
         )
 
-    def test_two_mode_squeezed_state_hafnian(self):
+    @pytest.mark.parametrize("batch", [1, 64])
+    def test_two_mode_squeezed_state_hafnian(self, batch):
         """Test the sampling routines by comparing the photon number frequencies and the exact
         probability distribution of a two mode squeezed vacuum state
         """
@@ -129,7 +134,8 @@ class TestHafnianSampling:
         s = np.sinh(2 * r)
         sigma = np.array([[c, s, 0, 0], [s, c, 0, 0], [0, 0, c, -s], [0, 0, -s, c]])
 
-        samples = hafnian_sample_state(sigma, samples=n_samples, cutoff=n_cut)
+        samples = hafnian_sample_state(sigma, samples=n_samples, cutoff=n_cut, batch=batch)
+        assert samples.shape == (n_samples, 2)
         assert np.all(samples[:, 0] == samples[:, 1])
 
         samples1d = samples[:, 0]
@@ -494,6 +500,95 @@ def test_seed():
     assert np.array_equal(second_sample, second_sample_p)
 
 
+@pytest.mark.parametrize("sampler", [hafnian_sample_state, torontonian_sample_state])
+def test_parallel_seed(sampler):
+    """Tests that the parallel samplers are reproducible by seed, whatever the chunk scheduling"""
+    V = TMS_cov(np.arcsinh(0.6), 0.3)
+    seed(11)
+    first_sample = sampler(V, 20, parallel=True, chunk_size=3)
+    seed(11)
+    second_sample = sampler(V, 20, parallel=True, chunk_size=3)
+    assert first_sample.shape == (20, 2)
+    assert np.array_equal(first_sample, second_sample)
+    assert np.all(first_sample[:, 0] == first_sample[:, 1])
+
+
+@pytest.mark.parametrize("sampler", [hafnian_sample_state, torontonian_sample_state])
+def test_rng_streams(sampler):
+    """Tests that a sample drawn with an ``rng`` only depends on the seed and on its index,
+    whether the samples are drawn serially, in batches, in parallel or on their own"""
+    V = TMS_cov(np.arcsinh(0.6), 0.3)
+    samples = sampler(V, 10, rng=2022)
+    assert np.array_equal(samples, sampler(V, 10, rng=np.random.SeedSequence(2022)))
+    assert np.array_equal(samples, sampler(V, 10, rng=2022, parallel=True, chunk_size=3))
+    assert np.array_equal(samples[:4], sampler(V, 4, rng=2022))
+    if sampler is hafnian_sample_state:
+        assert np.array_equal(samples, sampler(V, 10, rng=2022, batch=4))
+        generate = lambda rng: generate_hafnian_sample(V, cutoff=5, max_photons=30, rng=rng)
+    else:
+        generate = lambda rng: generate_torontonian_sample(V, rng=rng)
+
+    stream = sample_streams(np.random.SeedSequence(2022), 7, 8)[0]
+    sample = -1
+    while sample == -1:
+        sample = generate(stream)
+    assert list(samples[7]) == list(sample)
+
+
+def test_photon_number_sampler_rng():
+    """Tests that photon_number_sampler draws reproducible samples from a seed"""
+    probs = probabilities(TMS_cov(np.arcsinh(0.5), 0.0), cutoff=4)
+    samples = photon_number_sampler(probs, 20, rng=5)
+    assert samples == photon_number_sampler(probs, 20, rng=5)
+    assert samples[:8] == photon_number_sampler(probs, 8, rng=5)
+    assert all(i == j for i, j in samples)
+
+
+def test_generate_hafnian_samples_batch():
+    """Tests that a batch of chains drawn together matches chains drawn one at a time when
+    the random numbers are drawn in the same order"""
+    V = TMS_cov(np.arcsinh(0.8), 0.1)
+    cutoff, max_photons = 6, 8
+    state = prepare_hafnian_sampling(V)
+    seed(42)
+    batch_samples, accepted = generate_hafnian_samples(
+        state, 1, cutoff=cutoff, max_photons=max_photons
+    )
+    seed(42)
+    sample = generate_hafnian_sample(V, cutoff=cutoff, max_photons=max_photons)
+    if accepted[0]:
+        assert list(batch_samples[0]) == sample
+    else:
+        assert sample == -1
+
+    batch_samples, accepted = generate_hafnian_samples(
+        state, 200, cutoff=cutoff, max_photons=max_photons
+    )
+    assert batch_samples.shape == (200, 2)
+    assert np.all(batch_samples[:, 0] == batch_samples[:, 1])
+    in_bounds = (batch_samples.sum(axis=1) <= max_photons) & (batch_samples[:, -1] != cutoff)
+    assert np.array_equal(accepted, in_bounds)
+
+
+def test_hafnian_rejection_rate():
+    """Tests the estimated rejection rate matches the fraction of chains rejected by the
+    sampler, the rejected chains being dropped without exceeding the budget by more than the
+    cutoff"""
+    V = TMS_cov(np.arcsinh(1.5), 0.0)
+    cutoff, max_photons = 8, 4
+    rate, error = hafnian_rejection_rate(
+        V, cutoff=cutoff, max_photons=max_photons, trials=2000, rng=1
+    )
+    assert 0 < rate < 1
+    samples, accepted = generate_hafnian_samples(
+        prepare_hafnian_sampling(V), 2000, cutoff=cutoff, max_photons=max_photons
+    )
+    assert np.isclose(rate, 1 - accepted.mean(), atol=5 * error + 0.05)
+    assert np.all(samples[accepted].sum(axis=1) <= max_photons)
+    assert np.all(samples[accepted, 0] == samples[accepted, 1])
+    assert np.all(samples.sum(axis=1) <= max_photons + 2 * cutoff)
+
+
 def test_out_of_bounds_generate_hafnian_sample():
     """Check that when the sampled goes beyond max_photons a -1 is returned."""
     n_samples = 100
@@ -0,0 +1,91 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Tests for the block samplers and the sample sinks"""
+# pylint: disable=no-self-use,redefined-outer-name
+import itertools
+
+import pytest
+import numpy as np
+
+from thewalrus.samples import (
+    hafnian_sample_state,
+    hafnian_sample_blocks,
+    torontonian_sample_state,
+    torontonian_sample_blocks,
+)
+from thewalrus.sinks import NpySink, HDF5Sink, ZarrSink, write_samples
+from thewalrus.symplectic import two_mode_squeezing
+
+
+@pytest.fixture
+def cov():
+    """Covariance matrix of a lossless two-mode squeezed vacuum"""
+    return two_mode_squeezing(np.arcsinh(0.7), 0) @ two_mode_squeezing(np.arcsinh(0.7), 0).T
+
+
+@pytest.mark.parametrize("parallel", [False, True])
+def test_hafnian_sample_blocks(cov, parallel):
+    """Check the blocks hold the samples of hafnian_sample_state, from any start"""
+    expected = hafnian_sample_state(cov, 23, rng=7)
+    blocks = list(hafnian_sample_blocks(cov, 23, block_size=5, parallel=parallel, rng=7))
+    assert [len(block) for block in blocks] == [5, 5, 5, 5, 3]
+    assert all(block.dtype == np.uint8 for block in blocks)
+    assert np.array_equal(np.concatenate(blocks), expected)
+    resumed = np.concatenate(list(hafnian_sample_blocks(cov, 23, block_size=5, start=12, rng=7)))
+    assert np.array_equal(resumed, expected[12:])
+
+
+def test_torontonian_sample_blocks(cov):
+    """Check the blocks hold the samples of torontonian_sample_state"""
+    expected = torontonian_sample_state(cov, 11, rng=3)
+    blocks = np.concatenate(list(torontonian_sample_blocks(cov, 11, block_size=4, rng=3)))
+    assert np.array_equal(blocks, expected)
+
+
+def test_npy_sink_resume(cov, tmpdir):
+    """Check an interrupted job written to a .npy file resumes from the rows written"""
+    path = str(tmpdir.join("samples.npy"))
+    expected = hafnian_sample_state(cov, 20, rng=11)
+
+    sink = NpySink(path, 20, 2)
+    blocks = hafnian_sample_blocks(cov, 20, block_size=6, rng=11)
+    assert write_samples(itertools.islice(blocks, 2), sink) == 12
+
+    sink = NpySink(path, 20, 2)
+    assert sink.written == 12
+    blocks = hafnian_sample_blocks(cov, 20, block_size=6, start=sink.written, rng=11)
+    assert write_samples(blocks, sink) == 20
+    assert np.array_equal(np.load(path), expected)
+
+    with pytest.raises(ValueError, match="different shape"):
+        NpySink(path, 30, 2)
+
+
+@pytest.mark.parametrize("sink_class, module", [(HDF5Sink, "h5py"), (ZarrSink, "zarr")])
+def test_growing_sinks(cov, tmpdir, sink_class, module):
+    """Check the HDF5 and Zarr sinks grow as blocks are written and resume"""
+    pytest.importorskip(module)
+    path = str(tmpdir.join("samples"))
+    expected = hafnian_sample_state(cov, 15, rng=5)
+
+    blocks = hafnian_sample_blocks(cov, 15, block_size=4, rng=5)
+    assert write_samples(itertools.islice(blocks, 1), sink_class(path, 2)) == 4
+    sink = sink_class(path, 2)
+    blocks = hafnian_sample_blocks(cov, 15, block_size=4, start=sink.written, rng=5)
+    assert write_samples(blocks, sink) == 15
+
+    sink = sink_class(path, 2)
+    stored = np.array(sink.dataset if sink_class is HDF5Sink else sink.array)
+    sink.close()
+    assert np.array_equal(stored, expected)
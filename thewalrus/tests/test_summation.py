@@ -0,0 +1,87 @@
+# Copyright 2022 Xanadu Quantum Technologies Inc.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Tests for the deterministic parallel summation tools"""
+# pylint: disable=no-self-use,redefined-outer-name
+from fractions import Fraction
+
+import pytest
+import numba
+import numpy as np
+
+from thewalrus import hafnian, numba_ltor, brs
+from thewalrus._summation import num_chunks, chunk_range, two_sum, compensated_add, tree_sum
+
+
+@pytest.mark.parametrize("steps, n_chunks", [(10, 3), (7, 7), (100, 16)])
+def test_chunk_range(steps, n_chunks):
+    """Tests that the chunks tile the range of steps without gaps or overlaps"""
+    bounds = [chunk_range(c, n_chunks, steps) for c in range(n_chunks)]
+    assert bounds[0][0] == 0
+    assert bounds[-1][1] == steps
+    for (_, stop), (start, _) in zip(bounds[:-1], bounds[1:]):
+        assert stop == start
+    sizes = [stop - start for start, stop in bounds]
+    assert max(sizes) - min(sizes) <= 1
+
+
+def test_num_chunks():
+    """Tests that there are never more chunks than terms, nor fewer than one"""
+    assert num_chunks(0, 8) == 1
+    assert num_chunks(5, 8) == 5
+    assert num_chunks(100, 8) == 8
+
+
+@pytest.mark.parametrize("a, b", [(1.0, 1e-17), (1e16, 1.0), (-3.5, 1e-300), (0.1, 0.2)])
+def test_two_sum_exact(a, b):
+    """Tests that the rounding error returned by two_sum is exact"""
+    s, err = two_sum(a, b)
+    assert Fraction(s) + Fraction(err) == Fraction(a) + Fraction(b)
+
+
+def test_compensated_add_cancellation():
+    """Tests that compensated summation recovers small terms that plain summation loses
+    when they are added to, and cancelled by, much larger terms"""
+    terms = [1e16, 1.0, -1e16, 1.0] * 1000 + [1j, 1e16j, -1e16j]
+    total, comp = 0j, 0j
+    for x in terms:
+        total, comp = compensated_add(total, comp, complex(x))
+    assert total + comp == 2000 + 1j
+    assert sum(terms) != 2000 + 1j
+
+
+@pytest.mark.parametrize("n", [1, 2, 7, 16, 33])
+def test_tree_sum(n):
+    """Tests the pairwise sum against a plain sum"""
+    values = np.random.rand(n) + 1j * np.random.rand(n)
+    values_copy = values.copy()
+    assert np.allclose(tree_sum(values), values.sum())
+    assert np.all(values == values_copy)
+
+
+def test_thread_count_independence():
+    """Tests that the parallel kernels give bitwise identical results for any number of threads"""
+    A = np.random.rand(12, 12) + 1j * np.random.rand(12, 12)
+    A += A.T
+    gamma = np.random.rand(12) + 1j * np.random.rand(12)
+    O = 0.1 * A
+    E = np.random.rand(4, 4)
+    B = np.random.rand(6, 4)
+
+    max_threads = numba.config.NUMBA_NUM_THREADS
+    results = []
+    for threads in sorted({1, max_threads}):
+        numba.set_num_threads(threads)
+        results.append((hafnian(A), hafnian(A, loop=True), numba_ltor(O, gamma), brs(B, E)))
+    numba.set_num_threads(max_threads)
+    assert results[0] == results[-1]
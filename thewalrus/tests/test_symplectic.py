@@ -898,3 +898,69 @@ class TestPhaseSpaceFunctions:
         v = np.random.rand(dim)
         assert np.all(v == symplectic.xxpp_to_xpxp(symplectic.xpxp_to_xxpp(v)))
         assert np.all(v == symplectic.xpxp_to_xxpp(symplectic.xxpp_to_xpxp(v)))
+
+
+class TestLocalGates:
+    """Tests for the application of gates acting on a few modes"""
+
+    @pytest.mark.parametrize("modes", [[3], [4, 1], [0, 5, 2], 2])
+    def test_apply_symplectic_vs_expand(self, modes):
+        """Test the in-place application of a local gate matches the expanded gate"""
+        N = 6
+        M = 1 if isinstance(modes, int) else len(modes)
+        S = random_symplectic(M)
+        mu = np.random.rand(2 * N)
+        cov = random_symplectic(N)
+        cov = cov @ cov.T
+        S2 = symplectic.expand(S, modes, N)
+        expected_mu, expected_cov = S2 @ mu, S2 @ cov @ S2.T
+        assert np.allclose(symplectic.expand_matmul(S, modes, cov.copy()), S2 @ cov)
+        res_mu, res_cov = symplectic.apply_symplectic(mu, cov, S, modes)
+        assert np.allclose(res_mu, expected_mu)
+        assert np.allclose(res_cov, expected_cov)
+        assert res_cov is cov
+
+    def test_apply_single_mode_gate_to_several_modes(self):
+        """Test a single-mode gate given several modes acts on each of them"""
+        N = 4
+        S = symplectic.squeezing(0.3, 0.2)
+        mu, cov = symplectic.vacuum_state(N)
+        S2 = symplectic.expand(S, [0, 2], N)
+        _, res_cov = symplectic.apply_symplectic(mu, cov, S, [0, 2])
+        assert np.allclose(res_cov, S2 @ S2.T)
+
+    @pytest.mark.parametrize("max_modes", [1, 2, 3, 5])
+    def test_fuse_gates(self, max_modes):
+        """Test a circuit of fused gates acts as its gates applied one after the other, with no
+        fused gate larger than requested unless one of the gates is"""
+        N = 5
+        gates = [(random_symplectic(2), [m, (m + 1) % N]) for m in range(N)]
+        gates += [(random_symplectic(1), [m]) for m in range(0, N, 2)]
+        mu = np.random.rand(2 * N)
+        cov = np.identity(2 * N)
+        expected_mu, expected_cov = mu.copy(), cov.copy()
+        for S, modes in gates:
+            S2 = symplectic.expand(S, modes, N)
+            expected_mu, expected_cov = S2 @ expected_mu, S2 @ expected_cov @ S2.T
+        fused = symplectic.fuse_gates(gates, max_modes=max_modes)
+        assert all(len(modes) <= max(max_modes, 2) for _, modes in fused)
+        res_mu, res_cov = symplectic.apply_gates(mu, cov, gates, max_modes=max_modes)
+        assert np.allclose(res_mu, expected_mu)
+        assert np.allclose(res_cov, expected_cov)
+
+    def test_passive_transformation_modes(self):
+        """Test a lossy transformation of some modes matches the expanded transformation"""
+        N = 4
+        modes = [2, 0]
+        T = 0.8 * np.linalg.qr(np.random.rand(2, 2) + 1j * np.random.rand(2, 2))[0]
+        mu = np.random.rand(2 * N)
+        cov = random_symplectic(N)
+        cov = cov @ cov.T
+        expected = symplectic.passive_transformation(
+            mu, cov, symplectic.expand_passive(T, modes, N)
+        )
+        res = symplectic.passive_transformation(mu, cov, T, modes=modes)
+        assert np.allclose(res[0], expected[0])
+        assert np.allclose(res[1], expected[1])
+        with pytest.raises(ValueError, match="must be square"):
+            symplectic.passive_transformation(mu, cov, T, modes=[0])
@@ -271,3 +271,17 @@ def test_numba_ltor(N):
     t3 = rec_ltorontonian(O, mu)
     assert np.isclose(t1, t2)
     assert np.isclose(t1, t3)
+
+
+@pytest.mark.parametrize("N", [1, 3, 6])
+@pytest.mark.parametrize("depth", [0, 1, 2, 10])
+def test_rec_torontonians_split_depth(N, depth):
+    """Tests that the splitting of the recursive torontonians into parallel tasks does not
+    change their value"""
+    alpha = np.random.random(N) + np.random.random(N) * 1j
+    alpha = np.concatenate((alpha, alpha.conj()))
+    cov = random_covariance(N)
+    O = Xmat(N) @ Amat(cov)
+    mu = O @ alpha
+    assert np.isclose(rec_torontonian(O, depth), numba_tor(O))
+    assert np.isclose(rec_ltorontonian(O, mu, depth), numba_ltor(O, mu))